@@ -0,0 +1,104 @@
+#include <config.h>
+
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <dune/common/fvector.hh>
+#include <dune/common/parallel/mpihelper.hh>
+
+#include <dune/polygongrid/dgfreader.hh>
+#include <dune/polygongrid/meshio.hh>
+#include <dune/polygongrid/multivector.hh>
+#include <dune/polygongrid/parallel.hh>
+
+typedef Dune::FieldVector< double, 2 > GlobalCoordinate;
+
+
+// writeStructuredDGF
+// ------------------
+
+void writeStructuredDGF ( const std::string &filename, std::size_t n )
+{
+  std::ofstream output( filename );
+  output << "DGF" << std::endl << "Vertex" << std::endl;
+  for( std::size_t j = 0u; j <= n; ++j )
+    for( std::size_t i = 0u; i <= n; ++i )
+      output << double( i ) / double( n ) << " " << double( j ) / double( n ) << "\n";
+  output << "#" << std::endl << "Polygon" << std::endl;
+  for( std::size_t j = 0u; j < n; ++j )
+    for( std::size_t i = 0u; i < n; ++i )
+      output << (j*(n+1)+i) << " " << (j*(n+1)+i+1) << " " << ((j+1)*(n+1)+i+1) << " " << ((j+1)*(n+1)+i) << "\n";
+  output << "#" << std::endl;
+}
+
+
+// measure
+// -------
+
+template< class F >
+void measure ( const std::string &name, std::size_t numPolygons, F &&f )
+{
+  const auto start = std::chrono::steady_clock::now();
+  const std::size_t size = f();
+  const double seconds = std::chrono::duration< double >( std::chrono::steady_clock::now() - start ).count();
+  std::cout << name << ": " << seconds << " s (" << double( numPolygons ) / seconds * 1e-6 << " M polygons / s)" << std::endl;
+  if( size != numPolygons )
+  {
+    std::cerr << "Error: " << name << " read " << size << " polygons (expected " << numPolygons << ")." << std::endl;
+    std::abort();
+  }
+}
+
+
+// main
+// ----
+
+int main ( int argc, char **argv )
+try
+{
+  Dune::MPIHelper::instance( argc, argv );
+
+  // default: 3163^2 (about 10M) quadrilaterals
+  const std::size_t n = (argc > 1 ? std::strtoul( argv[ 1 ], nullptr, 10 ) : 3163u);
+  const std::size_t numPolygons = n*n;
+  const std::string dgfName = "benchmark-ingest.dgf", binaryName = "benchmark-ingest.bin";
+
+  std::cout << "Writing " << numPolygons << " polygons..." << std::endl;
+  writeStructuredDGF( dgfName, n );
+
+  measure( "sequential DGF", numPolygons, [ &dgfName ] () {
+      std::ifstream input( dgfName );
+      Dune::__PolygonGrid::DGFReader< double > reader;
+      reader.read( input );
+      return reader.polygons().size();
+    } );
+
+  std::vector< GlobalCoordinate > vertices;
+  Dune::__PolygonGrid::MultiVector< std::size_t > polygons;
+  measure( "parallel DGF (" + std::to_string( Dune::__PolygonGrid::numThreads() ) + " threads)", numPolygons, [ &dgfName, &vertices, &polygons ] () {
+      Dune::__PolygonGrid::readDGFParallel( dgfName, vertices, polygons );
+      return polygons.size();
+    } );
+
+  Dune::__PolygonGrid::writeBinaryMesh( binaryName, vertices, polygons );
+  measure( "parallel binary", numPolygons, [ &binaryName, &vertices, &polygons ] () {
+      Dune::__PolygonGrid::readBinaryMesh( binaryName, vertices, polygons );
+      return polygons.size();
+    } );
+
+  std::remove( dgfName.c_str() );
+  std::remove( binaryName.c_str() );
+  return 0;
+}
+catch( const Dune::Exception &e )
+{
+  std::cerr << e << std::endl;
+  return 1;
+}
@@ -0,0 +1,171 @@
+#ifndef DUNE_POLYGONGRID_BENCHMARK_MESHES_HH
+#define DUNE_POLYGONGRID_BENCHMARK_MESHES_HH
+
+#include <cstddef>
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <dune/common/fvector.hh>
+
+#include <dune/polygongrid/mesh.hh>
+#include <dune/polygongrid/multivector.hh>
+
+namespace Benchmark
+{
+
+  typedef Dune::FieldVector< double, 2 > GlobalCoordinate;
+
+
+
+  // MeshData
+  // --------
+
+  struct MeshData
+  {
+    std::string name;
+    std::size_t size = 0u;
+    std::vector< GlobalCoordinate > vertices;
+    Dune::__PolygonGrid::MultiVector< std::size_t > polygons;
+  };
+
+
+
+  // structuredMesh
+  // --------------
+
+  /** \brief n x n quadrilaterals on the unit square */
+  inline MeshData structuredMesh ( std::size_t n )
+  {
+    MeshData mesh;
+    mesh.name = "structured";
+    mesh.size = n;
+    for( std::size_t j = 0u; j <= n; ++j )
+      for( std::size_t i = 0u; i <= n; ++i )
+        mesh.vertices.push_back( GlobalCoordinate{ double( i ) / double( n ), double( j ) / double( n ) } );
+
+    std::vector< std::size_t > offsets( 1u, 0u ), values;
+    for( std::size_t j = 0u; j < n; ++j )
+      for( std::size_t i = 0u; i < n; ++i )
+      {
+        const std::size_t k = j*(n+1) + i;
+        values.insert( values.end(), { k, k+1, k+n+2, k+n+1 } );
+        offsets.push_back( values.size() );
+      }
+    mesh.polygons = Dune::__PolygonGrid::MultiVector< std::size_t >( std::move( offsets ), std::move( values ) );
+    return mesh;
+  }
+
+
+
+  // blossomMesh
+  // -----------
+
+  /** \brief n x n blossom patterns (hexagons around a quadrilateral) on the unit square, see python/dune/polygongrid/blossoms.py */
+  inline MeshData blossomMesh ( std::size_t n )
+  {
+    MeshData mesh;
+    mesh.name = "blossom";
+    mesh.size = n;
+    const std::size_t N = 3*n + 1;
+    for( std::size_t j = 0u; j < N; ++j )
+      for( std::size_t i = 0u; i < N; ++i )
+        mesh.vertices.push_back( GlobalCoordinate{ double( i ) / double( N-1 ), double( j ) / double( N-1 ) } );
+
+    std::vector< std::size_t > offsets( 1u, 0u ), values;
+    auto polygon = [ &offsets, &values ] ( std::initializer_list< std::size_t > corners ) {
+        values.insert( values.end(), corners );
+        offsets.push_back( values.size() );
+      };
+    for( std::size_t j = 0u; j < 3*N*n; j += 3*N )
+      for( std::size_t k = j; k < j + 3*n; k += 3 )
+      {
+        polygon( { k, k+1, k+2, k+N+2, k+N+1, k+N } );
+        polygon( { k+2, k+3, k+N+3, k+2*N+3, k+2*N+2, k+N+2 } );
+        polygon( { k+N, k+N+1, k+2*N+1, k+3*N+1, k+3*N, k+2*N } );
+        polygon( { k+N+1, k+N+2, k+2*N+2, k+2*N+1 } );
+        polygon( { k+2*N+1, k+2*N+2, k+2*N+3, k+3*N+3, k+3*N+2, k+3*N+1 } );
+      }
+    mesh.polygons = Dune::__PolygonGrid::MultiVector< std::size_t >( std::move( offsets ), std::move( values ) );
+    return mesh;
+  }
+
+
+
+  // voronoiMesh
+  // -----------
+
+  /**
+   * \brief Voronoi-like mesh with about n x n cells on the unit square
+   *
+   * The cells are the dual cells of a randomly perturbed triangulation, so
+   * they have varying numbers of corners like a Voronoi diagram. This
+   * avoids depending on a computational geometry library (the Python
+   * bindings use scipy, see python/dune/polygongrid/voronoi.py).
+   */
+  inline MeshData voronoiMesh ( std::size_t n, unsigned int seed = 1234u )
+  {
+    std::mt19937 random( seed );
+    std::uniform_real_distribution< double > jitter( -0.3 / double( n ), 0.3 / double( n ) );
+
+    std::vector< GlobalCoordinate > vertices;
+    for( std::size_t j = 0u; j <= n; ++j )
+      for( std::size_t i = 0u; i <= n; ++i )
+      {
+        GlobalCoordinate x{ double( i ) / double( n ), double( j ) / double( n ) };
+        if( (i > 0u) && (i < n) )
+          x[ 0 ] += jitter( random );
+        if( (j > 0u) && (j < n) )
+          x[ 1 ] += jitter( random );
+        vertices.push_back( x );
+      }
+
+    std::vector< std::size_t > offsets( 1u, 0u ), values;
+    for( std::size_t j = 0u; j < n; ++j )
+      for( std::size_t i = 0u; i < n; ++i )
+      {
+        const std::size_t k = j*(n+1) + i;
+        const bool flip = (random() % 2u == 0u);
+        values.insert( values.end(), { k, k+1, (flip ? k+n+1 : k+n+2) } );
+        offsets.push_back( values.size() );
+        values.insert( values.end(), { (flip ? k+1 : k), k+n+2, k+n+1 } );
+        offsets.push_back( values.size() );
+      }
+    const Dune::__PolygonGrid::Mesh< double > triangulation( vertices, Dune::__PolygonGrid::MultiVector< std::size_t >( std::move( offsets ), std::move( values ) ) );
+
+    // the dual cells of the regular primal vertices make up the mesh
+    using Dune::__PolygonGrid::Dual;
+    using Dune::__PolygonGrid::Primal;
+    MeshData mesh;
+    mesh.name = "voronoi";
+    mesh.size = n;
+    for( std::size_t i = 0u; i < triangulation.numVertices( Dual ); ++i )
+      mesh.vertices.push_back( triangulation.position( Dune::__PolygonGrid::NodeIndex( i, Dual ) ) );
+
+    const auto &cells = triangulation.nodes( Primal );
+    offsets.assign( 1u, 0u );
+    values.clear();
+    for( std::size_t i = 0u; i < triangulation.numCells( Dual ); ++i )
+    {
+      const std::size_t begin = values.size();
+      double area = 0.0;
+      for( std::size_t k = cells.begin_of( i ); k < cells.end_of( i ); ++k )
+      {
+        const GlobalCoordinate &x = mesh.vertices[ cells.values()[ k ].first ];
+        const GlobalCoordinate &y = mesh.vertices[ cells.values()[ k+1u < cells.end_of( i ) ? k+1u : cells.begin_of( i ) ].first ];
+        area += x[ 0 ]*y[ 1 ] - x[ 1 ]*y[ 0 ];
+        values.push_back( cells.values()[ k ].first );
+      }
+      if( area < 0.0 )
+        std::reverse( values.begin() + begin, values.end() );
+      offsets.push_back( values.size() );
+    }
+    mesh.polygons = Dune::__PolygonGrid::MultiVector< std::size_t >( std::move( offsets ), std::move( values ) );
+    return mesh;
+  }
+
+} // namespace Benchmark
+
+#endif // #ifndef DUNE_POLYGONGRID_BENCHMARK_MESHES_HH
@@ -0,0 +1,275 @@
+#include <config.h>
+
+#include <cstddef>
+#include <cstdlib>
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <dune/common/fvector.hh>
+#include <dune/common/parallel/mpihelper.hh>
+
+#include <dune/geometry/type.hh>
+
+#include <dune/polygongrid/entityvector.hh>
+#include <dune/polygongrid/grid.hh>
+#include <dune/polygongrid/gridfactory.hh>
+#include <dune/polygongrid/parallel.hh>
+#include <dune/polygongrid/positionlayout.hh>
+#include <dune/polygongrid/refinement.hh>
+
+#include "meshes.hh"
+
+typedef Dune::PolygonGrid< double > Grid;
+typedef Benchmark::GlobalCoordinate GlobalCoordinate;
+
+
+// Result
+// ------
+
+struct Result
+{
+  std::string benchmark, mesh;
+  std::size_t size, cells, repetitions;
+  double seconds, checksum;
+};
+
+
+
+// measure
+// -------
+
+/**
+ * \brief time f, repeating it until at least minSeconds have passed
+ *
+ * f returns a checksum, which is reported to keep the compiler from
+ * optimizing the kernel away.
+ */
+template< class F >
+Result measure ( const std::string &benchmark, const Benchmark::MeshData &mesh, std::size_t cells, F &&f, double minSeconds = 0.5 )
+{
+  Result result{ benchmark, mesh.name, mesh.size, cells, 0u, 0.0, 0.0 };
+  const auto start = std::chrono::steady_clock::now();
+  do
+  {
+    result.checksum += f();
+    ++result.repetitions;
+    result.seconds = std::chrono::duration< double >( std::chrono::steady_clock::now() - start ).count();
+  }
+  while( result.seconds < minSeconds );
+  result.seconds /= double( result.repetitions );
+  std::cerr << benchmark << " (" << mesh.name << ", " << cells << " cells): " << result.seconds << " s" << std::endl;
+  return result;
+}
+
+
+
+// createGrid
+// ----------
+
+std::unique_ptr< Grid > createGrid ( const Benchmark::MeshData &mesh, bool lazyDual = false )
+{
+  Dune::GridFactory< Grid > factory;
+  factory.setLazyDual( lazyDual );
+  for( const GlobalCoordinate &vertex : mesh.vertices )
+    factory.insertVertex( vertex );
+  std::vector< unsigned int > polygon;
+  for( std::size_t i = 0u; i < mesh.polygons.size(); ++i )
+  {
+    polygon.assign( mesh.polygons[ i ].begin(), mesh.polygons[ i ].end() );
+    factory.insertElement( Dune::GeometryTypes::none( 2 ), polygon );
+  }
+  return factory.createGrid();
+}
+
+
+
+// upwindStep
+// ----------
+
+/** \brief one explicit upwind finite volume step for the transport with constant velocity */
+template< class GridView, class Vector >
+double upwindStep ( const GridView &gridView, const GlobalCoordinate &velocity, double dt, const Vector &u, Vector &update )
+{
+  update.fill( 0.0 );
+  for( const auto &element : elements( gridView ) )
+  {
+    const double uIn = u[ element ];
+    double flux = 0.0;
+    for( const auto &intersection : intersections( gridView, element ) )
+    {
+      const double vn = (velocity * intersection.centerUnitOuterNormal()) * intersection.geometry().volume();
+      if( vn > 0.0 )
+        flux += vn * uIn;
+      else if( intersection.neighbor() )
+        flux += vn * u[ intersection.outside() ];
+    }
+    update[ element ] = uIn - dt * flux / element.geometry().volume();
+  }
+  return update[ 0 ];
+}
+
+
+
+// benchmark
+// ---------
+
+void benchmark ( const Benchmark::MeshData &mesh, std::vector< Result > &results )
+{
+  std::unique_ptr< Grid > gridPtr;
+  results.push_back( measure( "construction", mesh, mesh.polygons.size(), [ &mesh, &gridPtr ] () {
+      gridPtr = createGrid( mesh );
+      return double( gridPtr->size( 0 ) );
+    } ) );
+
+  // primal-only construction defers the dual data to the first call of dualGrid()
+  results.push_back( measure( "construction-lazy-dual", mesh, mesh.polygons.size(), [ &mesh ] () {
+      return double( createGrid( mesh, true )->size( 0 ) );
+    } ) );
+
+  const Grid &grid = *gridPtr;
+  const auto gridView = grid.leafGridView();
+  const auto &indexSet = gridView.indexSet();
+  const std::size_t cells = gridView.size( 0 );
+
+  results.push_back( measure( "cell-iteration", mesh, cells, [ &gridView, &indexSet ] () {
+      double sum = 0.0;
+      for( const auto &element : elements( gridView ) )
+        sum += indexSet.index( element );
+      return sum;
+    } ) );
+
+  results.push_back( measure( "edge-iteration", mesh, cells, [ &gridView, &indexSet ] () {
+      double sum = 0.0;
+      for( const auto &edge : edges( gridView ) )
+        sum += indexSet.index( edge );
+      return sum;
+    } ) );
+
+  results.push_back( measure( "intersections", mesh, cells, [ &gridView ] () {
+      GlobalCoordinate sum( 0.0 );
+      for( const auto &element : elements( gridView ) )
+        for( const auto &intersection : intersections( gridView, element ) )
+          sum.axpy( intersection.geometry().volume(), intersection.centerUnitOuterNormal() );
+      return sum.two_norm();
+    } ) );
+
+  results.push_back( measure( "geometry", mesh, cells, [ &gridView ] () {
+      double sum = 0.0;
+      for( const auto &element : elements( gridView ) )
+      {
+        const auto geometry = element.geometry();
+        sum += geometry.volume() * geometry.center()[ 0 ];
+      }
+      return sum;
+    } ) );
+
+  // cell volumes for the interleaved mesh positions, separate x/y arrays and gathered cell corners
+  const auto &polygonMesh = grid.mesh();
+  std::vector< double > volumes( cells );
+  results.push_back( measure( "volumes-aos", mesh, cells, [ &polygonMesh, &volumes ] () {
+      Dune::__PolygonGrid::parallelFor( 0u, volumes.size(), [ &polygonMesh, &volumes ] ( std::size_t i ) {
+          volumes[ i ] = Dune::__PolygonGrid::cellVolume( polygonMesh, Dune::__PolygonGrid::NodeIndex( i, Dune::__PolygonGrid::Dual ) );
+        } );
+      return volumes[ 0 ];
+    } ) );
+
+  const Dune::__PolygonGrid::SoAPositions< double > soaPositions( grid.mesh(), Dune::__PolygonGrid::Primal );
+  results.push_back( measure( "volumes-soa", mesh, cells, [ &soaPositions, &volumes ] () {
+      Dune::__PolygonGrid::parallelFor( 0u, volumes.size(), [ &soaPositions, &volumes ] ( std::size_t i ) { volumes[ i ] = soaPositions.volume( i ); } );
+      return volumes[ 0 ];
+    } ) );
+
+  const Dune::__PolygonGrid::CellCorners< double > cellCorners( grid.mesh(), Dune::__PolygonGrid::Primal );
+  results.push_back( measure( "volumes-gathered", mesh, cells, [ &cellCorners, &volumes ] () {
+      cellCorners.volumes( volumes );
+      return volumes[ 0 ];
+    } ) );
+
+  const Grid dualGrid = grid.dualGrid();
+  const auto dualGridView = dualGrid.leafGridView();
+  results.push_back( measure( "dual-iteration", mesh, cells, [ &dualGridView ] () {
+      double sum = 0.0;
+      for( const auto &element : elements( dualGridView ) )
+        sum += element.geometry().volume();
+      for( const auto &vertex : vertices( dualGridView ) )
+        sum += vertex.geometry().center()[ 1 ];
+      return sum;
+    } ) );
+
+  Dune::__PolygonGrid::CellVector< double > u( gridView ), update( gridView );
+  for( const auto &element : elements( gridView ) )
+    u[ element ] = (element.geometry().center().two_norm() < 0.5 ? 1.0 : 0.0);
+  const GlobalCoordinate velocity{ 1.0, 0.5 };
+  const double dt = 0.1 / double( mesh.size );
+  results.push_back( measure( "upwind-fv-step", mesh, cells, [ &gridView, &velocity, dt, &u, &update ] () {
+      const double value = upwindStep( gridView, velocity, dt, u, update );
+      std::swap( u, update );
+      return value;
+    } ) );
+}
+
+
+
+// writeJSON
+// ---------
+
+void writeJSON ( std::ostream &out, const std::vector< Result > &results )
+{
+  out.precision( 10 );
+  out << "{" << std::endl;
+  out << "  \"threads\": " << Dune::__PolygonGrid::numThreads() << "," << std::endl;
+  out << "  \"results\": [" << std::endl;
+  for( std::size_t i = 0u; i < results.size(); ++i )
+  {
+    const Result &r = results[ i ];
+    out << "    { \"benchmark\": \"" << r.benchmark << "\", \"mesh\": \"" << r.mesh << "\", \"size\": " << r.size
+        << ", \"cells\": " << r.cells << ", \"repetitions\": " << r.repetitions << ", \"seconds\": " << r.seconds
+        << ", \"cellsPerSecond\": " << double( r.cells ) / r.seconds << ", \"checksum\": " << r.checksum << " }"
+        << (i+1u < results.size() ? "," : "") << std::endl;
+  }
+  out << "  ]" << std::endl;
+  out << "}" << std::endl;
+}
+
+
+
+// main
+// ----
+
+int main ( int argc, char **argv )
+try
+{
+  Dune::MPIHelper::instance( argc, argv );
+
+  // usage: benchmark-polygongrid [output.json] [max. cells per direction]
+  const std::string filename = (argc > 1 ? argv[ 1 ] : "");
+  const std::size_t maxSize = (argc > 2 ? std::strtoul( argv[ 2 ], nullptr, 10 ) : 1024u);
+
+  std::vector< Result > results;
+  for( std::size_t n = 64u; n <= maxSize; n *= 4u )
+  {
+    // n/2 x n/2 blossom patterns yield 5/4 n^2 cells
+    benchmark( Benchmark::structuredMesh( n ), results );
+    benchmark( Benchmark::blossomMesh( n / 2u ), results );
+    benchmark( Benchmark::voronoiMesh( n ), results );
+  }
+
+  if( filename.empty() )
+    writeJSON( std::cout, results );
+  else
+  {
+    std::ofstream output( filename );
+    writeJSON( output, results );
+  }
+  return 0;
+}
+catch( const Dune::Exception &e )
+{
+  std::cerr << e << std::endl;
+  return 1;
+}
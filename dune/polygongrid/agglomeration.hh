@@ -0,0 +1,426 @@
+#ifndef DUNE_POLYGONGRID_AGGLOMERATION_HH
+#define DUNE_POLYGONGRID_AGGLOMERATION_HH
+
+#include <cassert>
+#include <cstddef>
+
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <memory>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <dune/polygongrid/mesh.hh>
+#include <dune/polygongrid/multivector.hh>
+#include <dune/polygongrid/parallel.hh>
+
+namespace Dune
+{
+
+  namespace __PolygonGrid
+  {
+
+    namespace __Agglomeration
+    {
+
+      // nextHalfEdge
+      // ------------
+
+      template< class ct >
+      inline HalfEdgeIndex nextHalfEdge ( const Mesh< ct > &mesh, NodeIndex cell, HalfEdgeIndex halfEdge ) noexcept
+      {
+        ++halfEdge;
+        return (halfEdge != mesh.end( cell ) ? halfEdge : mesh.begin( cell ));
+      }
+
+
+
+      // neighbor
+      // --------
+
+      template< class ct >
+      inline NodeIndex neighbor ( const Mesh< ct > &mesh, HalfEdgeIndex halfEdge ) noexcept
+      {
+        return mesh.target( mesh.dual( halfEdge ) );
+      }
+
+
+
+      // boundarySize
+      // ------------
+
+      /** \brief number of half edges of a cell not shared with other members of its aggregate */
+      template< class ct, class Member >
+      inline std::size_t boundarySize ( const Mesh< ct > &mesh, NodeIndex cell, Member member ) noexcept
+      {
+        std::size_t size = 0u;
+        for( HalfEdgeIndex h = mesh.begin( cell ); h != mesh.end( cell ); ++h )
+          size += (member( neighbor( mesh, h ) ) ? 0u : 1u);
+        return size;
+      }
+
+
+
+      // boundaryLoop
+      // ------------
+
+      /**
+       * \brief walk the boundary of an aggregate of primal cells
+       *
+       * Starting from a boundary half edge of the given cell, the boundary of
+       * the aggregate containing this cell is traversed counter-clockwise and
+       * the targets of the boundary half edges are written to out.
+       * At most maxSize vertices are written.
+       *
+       * \returns the number of boundary half edges visited
+       */
+      template< class ct, class Member, class OutputIterator >
+      inline std::size_t boundaryLoop ( const Mesh< ct > &mesh, NodeIndex cell, Member member, std::size_t maxSize, OutputIterator out )
+      {
+        HalfEdgeIndex start = mesh.begin( cell );
+        for( ; (start != mesh.end( cell )) && member( neighbor( mesh, start ) ); ++start )
+          continue;
+        if( start == mesh.end( cell ) )
+          return 0u;
+
+        std::size_t size = 0u;
+        HalfEdgeIndex halfEdge = start;
+        do
+        {
+          if( size++ == maxSize )
+            break;
+          *out++ = static_cast< std::size_t >( mesh.target( halfEdge ) );
+
+          // find next boundary half edge by rotating around the target
+          halfEdge = nextHalfEdge( mesh, cell, halfEdge );
+          for( NodeIndex nb = neighbor( mesh, halfEdge ); member( nb ); nb = neighbor( mesh, halfEdge ) )
+          {
+            cell = nb;
+            halfEdge = nextHalfEdge( mesh, cell, mesh.flip( halfEdge ) );
+          }
+        }
+        while( halfEdge != start );
+        return size;
+      }
+
+
+
+      // pairPriority
+      // ------------
+
+      /** \brief symmetric pseudo-random priority of a pair of cells used to break ties */
+      inline std::size_t pairPriority ( std::size_t a, std::size_t b ) noexcept
+      {
+        std::size_t h = std::min( a, b ) * 0x9e3779b97f4a7c15ull ^ std::max( a, b );
+        h ^= h >> 31;
+        h *= 0xbf58476d1ce4e5b9ull;
+        return h ^ (h >> 29);
+      }
+
+
+
+      // canMerge
+      // --------
+
+      /**
+       * \brief check whether the union of two neighboring cells is a simple polygon
+       *
+       * The union is rejected if it encloses a hole or touches itself in a
+       * vertex, as the mesh structure cannot represent either.
+       */
+      template< class ct >
+      inline bool canMerge ( const Mesh< ct > &mesh, NodeIndex a, NodeIndex b, std::vector< std::size_t > &buffer )
+      {
+        auto member = [ &a, &b ] ( NodeIndex n ) { return (n == a) || (n == b); };
+        const std::size_t size = boundarySize( mesh, a, member ) + boundarySize( mesh, b, member );
+
+        buffer.clear();
+        if( boundaryLoop( mesh, a, member, size+1u, std::back_inserter( buffer ) ) != size )
+          return false;
+
+        std::sort( buffer.begin(), buffer.end() );
+        return (std::adjacent_find( buffer.begin(), buffer.end() ) == buffer.end());
+      }
+
+    } // namespace __Agglomeration
+
+
+
+    // matchCells
+    // ----------
+
+    /**
+     * \brief pair neighboring primal cells by a greedy matching on the dual graph
+     *
+     * Each unmatched cell proposes to the unmatched neighbor sharing the
+     * longest boundary with it (ties are broken by a symmetric priority of the
+     * pair); mutual proposals are accepted. The rounds are repeated until no
+     * further pairs are found. Each round is linear in the
+     * size of the mesh and processes all cells concurrently.
+     *
+     * \param[in]   mesh           mesh to coarsen
+     * \param[out]  numAggregates  number of aggregates (pairs and remaining single cells)
+     *
+     * \returns aggregate index for each primal cell
+     */
+    template< class ct >
+    inline std::vector< std::size_t > matchCells ( const Mesh< ct > &mesh, std::size_t &numAggregates, int maxRounds = 16 )
+    {
+      const std::size_t numCells = mesh.numCells( Primal );
+      const std::size_t none = std::numeric_limits< std::size_t >::max();
+
+      std::vector< std::size_t > partner( numCells, none ), proposal( numCells, none );
+      for( int round = 0; round < maxRounds; ++round )
+      {
+        parallelFor( 0u, numCells, [ &mesh, &partner, &proposal, none ] ( std::size_t i ) {
+            proposal[ i ] = none;
+            if( partner[ i ] != none )
+              return;
+
+            // accumulate length of the boundary shared with each unmatched neighbor
+            const NodeIndex cell( i, Dual );
+            std::vector< std::tuple< double, std::size_t, std::size_t > > candidates;
+            for( HalfEdgeIndex h = mesh.begin( cell ); h != mesh.end( cell ); ++h )
+            {
+              const NodeIndex nb = __Agglomeration::neighbor( mesh, h );
+              if( !mesh.regular( nb ) || (partner[ nb ] != none) )
+                continue;
+              const double length = (mesh.position( mesh.target( h ) ) - mesh.position( mesh.target( mesh.flip( h ) ) )).two_norm();
+              auto pos = std::find_if( candidates.begin(), candidates.end(), [ &nb ] ( const std::tuple< double, std::size_t, std::size_t > &c ) { return (std::get< 2 >( c ) == nb); } );
+              if( pos != candidates.end() )
+                std::get< 0 >( *pos ) -= length;
+              else
+                candidates.emplace_back( -length, __Agglomeration::pairPriority( i, nb ), nb );
+            }
+            std::sort( candidates.begin(), candidates.end() );
+
+            std::vector< std::size_t > buffer;
+            for( const auto &candidate : candidates )
+            {
+              if( __Agglomeration::canMerge( mesh, cell, NodeIndex( std::get< 2 >( candidate ), Dual ), buffer ) )
+              {
+                proposal[ i ] = std::get< 2 >( candidate );
+                break;
+              }
+            }
+          } );
+
+        std::size_t matched = 0u;
+        for( std::size_t i = 0u; i < numCells; ++i )
+        {
+          if( (proposal[ i ] != none) && (proposal[ proposal[ i ] ] == i) )
+          {
+            partner[ i ] = proposal[ i ];
+            ++matched;
+          }
+        }
+        if( matched == 0u )
+          break;
+      }
+
+      std::vector< std::size_t > aggregates( numCells, none );
+      numAggregates = 0u;
+      for( std::size_t i = 0u; i < numCells; ++i )
+      {
+        if( aggregates[ i ] != none )
+          continue;
+        aggregates[ i ] = numAggregates;
+        if( partner[ i ] != none )
+          aggregates[ partner[ i ] ] = numAggregates;
+        ++numAggregates;
+      }
+      return aggregates;
+    }
+
+
+
+    // agglomerate
+    // -----------
+
+    /**
+     * \brief merge the primal cells of each aggregate into a single polygon
+     *
+     * The aggregates must be simply connected and must not touch themselves
+     * in a vertex. Vertices no longer used by any polygon are removed.
+     * Boundary ids and segments are inherited from the fine mesh, as are the
+     * persistent ids of all entities not merged (see Mesh::inheritIds).
+     * Unless the dual data of the fine mesh has been built, the coarse mesh
+     * defers its dual data, too (see Mesh::buildDual).
+     *
+     * \param[in]  mesh           fine mesh
+     * \param[in]  aggregates     aggregate index for each primal cell
+     * \param[in]  numAggregates  number of aggregates
+     *
+     * \returns coarse mesh (not attached to the fine one)
+     */
+    template< class ct >
+    inline std::shared_ptr< Mesh< ct > > agglomerate ( const Mesh< ct > &mesh, const std::vector< std::size_t > &aggregates, std::size_t numAggregates )
+    {
+      const std::size_t numCells = mesh.numCells( Primal );
+      const std::size_t numVertices = mesh.numVertices( Primal );
+      const std::size_t none = std::numeric_limits< std::size_t >::max();
+      assert( !mesh.periodic() );
+
+      // representative cell and number of boundary half edges per aggregate
+      std::vector< std::size_t > representative( numAggregates, none ), count( numAggregates, 0u );
+      for( std::size_t i = numCells; i-- > 0u; )
+        representative[ aggregates[ i ] ] = i;
+      for( std::size_t i = 0u; i < numCells; ++i )
+      {
+        const std::size_t a = aggregates[ i ];
+        count[ a ] += __Agglomeration::boundarySize( mesh, NodeIndex( i, Dual ), [ &mesh, &aggregates, a ] ( NodeIndex n ) { return mesh.regular( n ) && (aggregates[ n ] == a); } );
+      }
+
+      MultiVector< std::size_t > polygons( count );
+      parallelFor( 0u, numAggregates, [ &mesh, &aggregates, &representative, &polygons ] ( std::size_t a ) {
+          auto member = [ &mesh, &aggregates, a ] ( NodeIndex n ) { return mesh.regular( n ) && (aggregates[ n ] == a); };
+          auto polygon = polygons[ a ];
+          const std::size_t size = __Agglomeration::boundaryLoop( mesh, NodeIndex( representative[ a ], Dual ), member, polygon.size(), polygon.begin() );
+          assert( size == polygon.size() );
+        } );
+
+      // remove unused vertices
+      std::vector< std::size_t > vertexMap( numVertices, none );
+      for( std::size_t v : polygons.values() )
+        vertexMap[ v ] = 0u;
+      std::vector< typename Mesh< ct >::GlobalCoordinate > vertices;
+      std::vector< std::size_t > fineVertices;
+      for( std::size_t v = 0u; v < numVertices; ++v )
+      {
+        if( vertexMap[ v ] == none )
+          continue;
+        vertexMap[ v ] = vertices.size();
+        vertices.push_back( mesh.position( NodeIndex( v, Primal ) ) );
+        fineVertices.push_back( v );
+      }
+      for( std::size_t &v : polygons.values() )
+        v = vertexMap[ v ];
+
+      std::shared_ptr< Mesh< ct > > coarse = std::make_shared< Mesh< ct > >( vertices, polygons, !mesh.dualBuilt() );
+
+      // the remaining vertices, the cells not merged and all coarse edges (which are fine edges) keep their ids
+      std::array< std::vector< std::size_t >, 2 > nodeOrigins{{ std::vector< std::size_t >( coarse->numNodes( Primal ), none ), std::vector< std::size_t >( coarse->numNodes( Dual ), none ) }};
+      std::vector< std::size_t > halfEdgeOrigins( coarse->nodes( Dual ).values().size(), none );
+      std::copy( fineVertices.begin(), fineVertices.end(), nodeOrigins[ Primal ].begin() );
+      std::vector< std::size_t > members( numAggregates, 0u );
+      for( std::size_t a : aggregates )
+        ++members[ a ];
+      for( std::size_t a = 0u; a < numAggregates; ++a )
+        nodeOrigins[ Dual ][ a ] = (members[ a ] == 1u ? representative[ a ] : none);
+      parallelFor( 0u, numAggregates, [ &mesh, &coarse, &fineVertices, &halfEdgeOrigins, numCells ] ( std::size_t a ) {
+          const auto polygon = coarse->nodes( Dual )[ a ];
+          const std::size_t n = polygon.size();
+          for( std::size_t k = 0u; k < n; ++k )
+          {
+            // search the fine half edge from source to target among the half edges around the target
+            const std::size_t source = fineVertices[ polygon[ (k+n-1) % n ].first ], target = fineVertices[ polygon[ k ].first ];
+            for( const IndexPair &p : mesh.nodes( Primal )[ target ] )
+            {
+              if( p.first >= numCells )
+                continue;
+              const std::size_t m = mesh.size( NodeIndex( p.first, Dual ) );
+              if( mesh.nodes( Dual )[ p.first ][ (p.second + m - 2u) % m ].first == source )
+                halfEdgeOrigins[ coarse->nodes( Dual ).position_of( a, k ) ] = mesh.nodes( Dual ).position_of( p.first, (p.second + m - 1u) % m );
+            }
+          }
+        } );
+
+      // boundary edges are not merged, so the boundary nodes keep their ids, too
+      auto inherit = [ &mesh, &coarse, &nodeOrigins, &halfEdgeOrigins ] ( std::size_t c, std::size_t f ) {
+          nodeOrigins[ Dual ][ c ] = f;
+          for( std::size_t k = 0u; k < coarse->nodes( Dual ).size( c ); ++k )
+            halfEdgeOrigins[ coarse->nodes( Dual ).position_of( c, k ) ] = mesh.nodes( Dual ).position_of( f, k );
+        };
+      const std::size_t numBoundaries = mesh.numBoundaries( Primal );
+      assert( coarse->numBoundaries( Primal ) == numBoundaries );
+      for( std::size_t j = 0u; j < numBoundaries; ++j )
+      {
+        const std::size_t b0 = fineVertices[ coarse->nodes( Dual )[ numAggregates + j ][ 0 ].first ];
+        const std::size_t i = mesh.nodes( Primal )[ b0 ][ 0 ].first - numCells;
+        inherit( numAggregates + j, numCells + i );
+        inherit( numAggregates + numBoundaries + j, numCells + numBoundaries + i );
+        for( std::size_t k = 0u; k < 2u; ++k )
+          nodeOrigins[ Primal ][ vertices.size() + 2*j+k ] = numVertices + 2*i+k;
+      }
+      coarse->inheritIds( mesh, nodeOrigins, halfEdgeOrigins );
+
+      // boundary edges are not merged, so each coarse boundary edge inherits the data of the fine one
+      if( !mesh.boundaryIds().empty() || !mesh.boundarySegments().empty() )
+      {
+        std::map< std::pair< std::size_t, std::size_t >, std::size_t > fineBoundaries;
+        for( std::size_t i = 0u; i < mesh.numBoundaries( Primal ); ++i )
+        {
+          const HalfEdgeIndex h = ++mesh.begin( NodeIndex( numCells + i, Dual ) );
+          fineBoundaries.emplace( std::minmax( vertexMap[ mesh.target( mesh.flip( h ) ) ], vertexMap[ mesh.target( h ) ] ), i );
+        }
+
+        const std::vector< std::pair< std::size_t, std::size_t > > coarseBoundaries = boundaryVertices( *coarse, polygons );
+        std::vector< std::size_t > origin( coarseBoundaries.size() );
+        for( std::size_t i = 0u; i < coarseBoundaries.size(); ++i )
+        {
+          assert( fineBoundaries.find( coarseBoundaries[ i ] ) != fineBoundaries.end() );
+          origin[ i ] = fineBoundaries[ coarseBoundaries[ i ] ];
+        }
+        coarse->copyBoundaryData( mesh, origin );
+      }
+
+      return coarse;
+    }
+
+
+
+    // coarsen
+    // -------
+
+    /**
+     * \brief create a coarser mesh by agglomeration of neighboring cells
+     *
+     * In contrast to the overload below, the coarse mesh is not attached to
+     * the fine one, i.e., the fine mesh is not modified.
+     *
+     * \param[in]   mesh     mesh to coarsen
+     * \param[out]  fathers  index of the coarse cell for each primal cell of mesh
+     *
+     * \returns the coarse mesh or a null pointer, if no cells could be merged
+     */
+    template< class ct >
+    inline std::shared_ptr< Mesh< ct > > coarsen ( const Mesh< ct > &mesh, std::vector< std::size_t > &fathers )
+    {
+      std::size_t numAggregates = 0u;
+      fathers = matchCells( mesh, numAggregates );
+      if( numAggregates == mesh.numCells( Primal ) )
+        return nullptr;
+      return agglomerate( mesh, fathers, numAggregates );
+    }
+
+    /**
+     * \brief create a coarser mesh by agglomeration of neighboring cells
+     *
+     * The coarse mesh is attached to the fine one as its father, i.e., the
+     * parent / child maps are available from the meshes afterwards.
+     *
+     * \returns the coarse mesh or a null pointer, if no cells could be merged
+     *
+     * \note The coarse mesh obtains level 0 and the fine mesh level 1; the
+     *       levels of meshes already derived from the fine one are not
+     *       updated (see Mesh::setFather and PolygonGrid::coarsen).
+     */
+    template< class ct >
+    inline std::shared_ptr< Mesh< ct > > coarsen ( const std::shared_ptr< Mesh< ct > > &mesh )
+    {
+      std::vector< std::size_t > fathers;
+      std::shared_ptr< Mesh< ct > > coarse = coarsen( *mesh, fathers );
+      if( coarse )
+        mesh->setFather( coarse, std::move( fathers ) );
+      return coarse;
+    }
+
+  } // namespace __PolygonGrid
+
+} // namespace Dune
+
+#endif // #ifndef DUNE_POLYGONGRID_AGGLOMERATION_HH
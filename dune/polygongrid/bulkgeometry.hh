@@ -0,0 +1,205 @@
+#ifndef DUNE_POLYGONGRID_BULKGEOMETRY_HH
+#define DUNE_POLYGONGRID_BULKGEOMETRY_HH
+
+#include <cstddef>
+
+#include <limits>
+#include <vector>
+
+#include <dune/polygongrid/fixedvalence.hh>
+#include <dune/polygongrid/mesh.hh>
+#include <dune/polygongrid/meshobjects.hh>
+#include <dune/polygongrid/multivector.hh>
+#include <dune/polygongrid/parallel.hh>
+#include <dune/polygongrid/polygonmoments.hh>
+
+namespace Dune
+{
+
+  namespace __PolygonGrid
+  {
+
+    // Bulk geometry queries
+    // ---------------------
+    //
+    // The following functions evaluate geometric quantities for all cells
+    // or edges of the grid of given type in one parallel loop. The results
+    // are written into flat, random access containers (e.g., std::vector or
+    // a raw pointer into a NumPy array), indexed like the grid entities.
+    // Vector-valued results are stored interleaved, i.e., component d of
+    // entity i is stored at position 2*i + d.
+
+    namespace __BulkGeometry
+    {
+
+      /**
+       * \brief call f( i, moments ) for each cell i of the grid of given type
+       *
+       * The primal cells are evaluated by the FixedValenceMesh matching the
+       * polygon size of the mesh; the dual cells vary in size.
+       */
+      template< class ct, class F >
+      inline void forEachCellMoments ( const Mesh< ct > &mesh, MeshType type, F &&f )
+      {
+        if( type == Primal )
+        {
+          dispatchValence( mesh, [ &f ] ( const auto &cells ) {
+              parallelFor( 0u, cells.numCells(), [ &cells, &f ] ( std::size_t i ) { f( i, cells.moments( i ) ); } );
+            } );
+        }
+        else
+          parallelFor( 0u, mesh.numCells( type ), [ &mesh, &f ] ( std::size_t i ) { f( i, cellMoments( mesh, NodeIndex( i, Primal ) ) ); } );
+      }
+
+      /** \brief call f( e, h ) for each edge e of the grid of given type with one of its half edges h */
+      template< class ct, class F >
+      inline void forEachEdge ( const Mesh< ct > &mesh, MeshType type, F &&f )
+      {
+        const std::size_t numEdges = mesh.numEdges( type );
+        parallelFor( 0u, mesh.nodes( dual( type ) ).values().size(), [ &mesh, &f, type, numEdges ] ( std::size_t k ) {
+            // each edge is represented by its half edge of smaller index
+            const HalfEdgeIndex h( k, type );
+            const std::size_t e = mesh.edgeIndex( h );
+            if( (static_cast< std::size_t >( h ) < static_cast< std::size_t >( mesh.flip( h ) )) && (e < numEdges) )
+              f( e, h );
+          } );
+      }
+
+    } // namespace __BulkGeometry
+
+
+
+    // cellVolumes
+    // -----------
+
+    /** \brief volumes of all cells of the grid of given type (volumes[ i ]) */
+    template< class ct, class Values >
+    inline void cellVolumes ( const Mesh< ct > &mesh, MeshType type, Values &&volumes )
+    {
+      __BulkGeometry::forEachCellMoments( mesh, type, [ &volumes ] ( std::size_t i, const PolygonMoments< ct > &moments ) { volumes[ i ] = moments.volume(); } );
+    }
+
+
+
+    // cellCentroids
+    // -------------
+
+    /** \brief centroids of all cells of the grid of given type (centroids[ 2*i+d ]) */
+    template< class ct, class Values >
+    inline void cellCentroids ( const Mesh< ct > &mesh, MeshType type, Values &&centroids )
+    {
+      __BulkGeometry::forEachCellMoments( mesh, type, [ &centroids ] ( std::size_t i, const PolygonMoments< ct > &moments ) {
+          const FieldVector< ct, 2 > center = moments.center();
+          centroids[ 2*i ] = center[ 0 ];
+          centroids[ 2*i+1 ] = center[ 1 ];
+        } );
+    }
+
+
+
+    // edgeLengths
+    // -----------
+
+    /** \brief lengths of all edges of the grid of given type (lengths[ e ]) */
+    template< class ct, class Values >
+    inline void edgeLengths ( const Mesh< ct > &mesh, MeshType type, Values &&lengths )
+    {
+      __BulkGeometry::forEachEdge( mesh, type, [ &mesh, &lengths ] ( std::size_t e, HalfEdgeIndex h ) {
+          const HalfEdge< ct > halfEdge( &mesh, h );
+          lengths[ e ] = (halfEdge.targetPosition() - halfEdge.sourcePosition()).two_norm();
+        } );
+    }
+
+
+
+    // edgeNormals
+    // -----------
+
+    /**
+     * \brief unit normals of all edges of the grid of given type (normals[ 2*e+d ])
+     *
+     * The normal points out of the first cell of the edge, see edgeCells.
+     */
+    template< class ct, class Values >
+    inline void edgeNormals ( const Mesh< ct > &mesh, MeshType type, Values &&normals )
+    {
+      __BulkGeometry::forEachEdge( mesh, type, [ &mesh, &normals ] ( std::size_t e, HalfEdgeIndex h ) {
+          const HalfEdge< ct > halfEdge( &mesh, h );
+          const FieldVector< ct, 2 > tangent = halfEdge.targetPosition() - halfEdge.sourcePosition();
+          const ct length = tangent.two_norm();
+          normals[ 2*e ] = tangent[ 1 ] / length;
+          normals[ 2*e+1 ] = -tangent[ 0 ] / length;
+        } );
+    }
+
+
+
+    // edgeCells
+    // ---------
+
+    /**
+     * \brief cells adjacent to all edges of the grid of given type (cells[ 2*e+j ])
+     *
+     * For boundary edges, the second cell is std::numeric_limits< std::size_t >::max().
+     */
+    template< class ct, class Values >
+    inline void edgeCells ( const Mesh< ct > &mesh, MeshType type, Values &&cells )
+    {
+      __BulkGeometry::forEachEdge( mesh, type, [ &mesh, &cells ] ( std::size_t e, HalfEdgeIndex h ) {
+          const HalfEdge< ct > halfEdge( &mesh, h );
+          cells[ 2*e ] = static_cast< std::size_t >( halfEdge.cell().index() );
+          cells[ 2*e+1 ] = (halfEdge.neighbor().regular() ? static_cast< std::size_t >( halfEdge.neighbor().index() ) : std::numeric_limits< std::size_t >::max());
+        } );
+    }
+
+
+
+    // cellVertices
+    // ------------
+
+    /**
+     * \brief vertices of all cells of the grid of given type in compressed row storage
+     *
+     * The vertices of each cell are given counter-clockwise, in the order of
+     * its half edges.
+     */
+    template< class ct >
+    inline MultiVector< std::size_t > cellVertices ( const Mesh< ct > &mesh, MeshType type )
+    {
+      const std::vector< std::size_t > &offsets = mesh.nodes( dual( type ) ).offsets();
+      const std::size_t numCells = mesh.numCells( type );
+      std::vector< std::size_t > vertices( offsets[ numCells ] );
+      parallelFor( 0u, vertices.size(), [ &mesh, &vertices, type ] ( std::size_t k ) { vertices[ k ] = mesh.target( HalfEdgeIndex( k, type ) ); } );
+      return MultiVector< std::size_t >( std::vector< std::size_t >( offsets.begin(), offsets.begin() + numCells + 1u ), std::move( vertices ) );
+    }
+
+
+
+    // cellNeighbors
+    // -------------
+
+    /**
+     * \brief neighbors of all cells of the grid of given type in compressed row storage
+     *
+     * Neighbor j of a cell lies across its half edge j, i.e., the rows match
+     * cellVertices. Across boundary edges, the neighbor is
+     * std::numeric_limits< std::size_t >::max().
+     */
+    template< class ct >
+    inline MultiVector< std::size_t > cellNeighbors ( const Mesh< ct > &mesh, MeshType type )
+    {
+      const std::vector< std::size_t > &offsets = mesh.nodes( dual( type ) ).offsets();
+      const std::size_t numCells = mesh.numCells( type );
+      std::vector< std::size_t > neighbors( offsets[ numCells ] );
+      parallelFor( 0u, neighbors.size(), [ &mesh, &neighbors, type ] ( std::size_t k ) {
+          const HalfEdge< ct > halfEdge( &mesh, HalfEdgeIndex( k, type ) );
+          neighbors[ k ] = (halfEdge.neighbor().regular() ? static_cast< std::size_t >( halfEdge.neighbor().index() ) : std::numeric_limits< std::size_t >::max());
+        } );
+      return MultiVector< std::size_t >( std::vector< std::size_t >( offsets.begin(), offsets.begin() + numCells + 1u ), std::move( neighbors ) );
+    }
+
+  } // namespace __PolygonGrid
+
+} // namespace Dune
+
+#endif // #ifndef DUNE_POLYGONGRID_BULKGEOMETRY_HH
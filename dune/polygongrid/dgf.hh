@@ -6,9 +6,11 @@
 #include <algorithm>
 #include <fstream>
 #include <iosfwd>
+#include <map>
 #include <memory>
 #include <sstream>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <dune/common/exceptions.hh>
@@ -19,8 +21,10 @@
 #include <dune/grid/io/file/dgfparser/dgfparser.hh>
 #include <dune/grid/io/file/dgfparser/dgfgridfactory.hh>
 
+#include <dune/polygongrid/dgfreader.hh>
 #include <dune/polygongrid/grid.hh>
 #include <dune/polygongrid/gridfactory.hh>
+#include <dune/polygongrid/orientation.hh>
 
 namespace Dune
 {
@@ -49,6 +53,17 @@ namespace Dune
   // DGFGridFactory
   // --------------
 
+  /**
+   * \brief DGF grid factory for PolygonGrid
+   *
+   * Polygonal DGF files are read by the streaming __PolygonGrid::DGFReader.
+   * Only if the file contains blocks the reader does not understand (e.g.,
+   * Interval), the generic DuneGridFormatParser is used; the streaming
+   * reader then only counts the simplices and polygons to tell the cubes
+   * apart. Streams that cannot be rewound are buffered first. In both
+   * cases, only the boundary segments and the parameters are kept after
+   * the grid has been created.
+   */
   template< class ct >
   struct DGFGridFactory< PolygonGrid< ct > >
   {
@@ -61,13 +76,11 @@ namespace Dune
     typedef Dune::Intersection< const Grid, __PolygonGrid::Intersection< const Grid > > Intersection;
 
     explicit DGFGridFactory ( std::istream &input, const MPICommunicator comm = MPIHelper::getCommunicator() )
-      : parser_( 0, 1 )
     {
       generate( input );
     }
 
     explicit DGFGridFactory ( const std::string &filename, MPICommunicator comm = MPIHelper::getCommunicator() )
-      : parser_( 0, 1 )
     {
       std::ifstream input( filename );
       generate( input );
@@ -75,23 +88,19 @@ namespace Dune
 
     Grid *grid () { return grid_.release(); }
 
-    bool wasInserted ( const Intersection &intersection ) const { return (findFace( intersection ) != parser_.facemap.end()); }
+    bool wasInserted ( const Intersection &intersection ) const { return (findFace( intersection ) != boundarySegments_.end()); }
 
     int boundaryId ( const Intersection &intersection ) const
     {
-      const auto pos = findFace( intersection );
-      if( pos != parser_.facemap.end() )
-        return pos->second.first;
-      else
-        return (intersection.boundary() ? 1 : 0);
+      return (intersection.boundary() ? intersection.impl().boundaryId() : 0);
     }
 
-    bool haveBoundaryParameters () const { return parser_.haveBndParameters; }
+    bool haveBoundaryParameters () const { return haveBoundaryParameters_; }
 
     const DGFBoundaryParameter::type &boundaryParameter ( const Intersection &intersection ) const
     {
       const auto pos = findFace( intersection );
-      if( pos != parser_.facemap.end() )
+      if( pos != boundarySegments_.end() )
         return pos->second.second;
       else
         return DGFBoundaryParameter::defaultValue();
@@ -100,36 +109,43 @@ namespace Dune
     template< int codim >
     int numParameters () const
     {
-      return (codim == 0 ? parser_.nofelparams : (codim == dimension ? parser_.nofvtxparams : 0));
+      return (codim == 0 ? numElementParameters_ : (codim == dimension ? numVertexParameters_ : 0));
     }
 
     std::vector< double > &parameter ( const typename Grid::template Codim< 0 >::Entity &element )
     {
       if( numParameters< 0 >() <= 0 )
         DUNE_THROW( InvalidStateException, "Calling DGFGridFactory::parameter is only allowed if there are parameters." );
-      return parser_.elParams[ element.impl().index() ];
+      return elementParameters_[ element.impl().index() ];
     }
 
     std::vector< double > &parameter ( const typename Grid::template Codim< dimension >::Entity &vertex )
     {
       if( numParameters< dimension >() <= 0 )
         DUNE_THROW( InvalidStateException, "Calling DGFGridFactory::parameter is only allowed if there are parameters." );
-      return parser_.vtxParams[ vertex.impl().index() ];
+      return vertexParameters_[ vertex.impl().index() ];
     }
 
   private:
+    typedef __PolygonGrid::DGFReader< ct > Reader;
+    typedef std::map< typename Reader::Key, typename Reader::BoundaryData > BoundarySegments;
+
     void generate ( std::istream &input );
 
-    DuneGridFormatParser::facemap_t::const_iterator findFace ( const Intersection &intersection ) const
+    static void readGeneric ( std::istream &input, Reader &reader, __PolygonGrid::MultiVector< std::size_t > &polygons, bool &haveBoundaryParameters );
+
+    typename BoundarySegments::const_iterator findFace ( const Intersection &intersection ) const
     {
-      const unsigned int p0 = intersection.impl().item().target().uniqueIndex();
-      const unsigned int p1 = intersection.impl().item().flip().target().uniqueIndex();
-      DuneGridFormatParser::facemap_t::key_type key( { p0, p1 }, false );
-      return parser_.facemap.find( key );
+      const std::size_t p0 = intersection.impl().item().target().uniqueIndex();
+      const std::size_t p1 = intersection.impl().item().flip().target().uniqueIndex();
+      return boundarySegments_.find( std::minmax( p0, p1 ) );
     }
 
     std::unique_ptr< Grid > grid_;
-    DuneGridFormatParser parser_;
+    BoundarySegments boundarySegments_;
+    bool haveBoundaryParameters_ = false;
+    int numVertexParameters_ = 0, numElementParameters_ = 0;
+    std::vector< std::vector< double > > vertexParameters_, elementParameters_;
   };
 
 
@@ -140,34 +156,113 @@ namespace Dune
   template< class ct >
   inline void DGFGridFactory< PolygonGrid< ct > >::generate ( std::istream &input )
   {
-    parser_.element = DuneGridFormatParser::General;
+    const std::istream::pos_type start = input.tellg();
+    if( start == std::istream::pos_type( -1 ) )
+    {
+      // both the counting pass and the generic parser need to rewind the stream
+      std::stringstream buffer;
+      buffer << input.rdbuf();
+      generate( buffer );
+      return;
+    }
 
-    if( !parser_.readDuneGrid( input, dimension, GlobalCoordinate::dimension ) )
-      DUNE_THROW( DGFException, "Unable to read DGF stream." );
+    Reader reader;
+    __PolygonGrid::MultiVector< std::size_t > polygons;
+    if( reader.read( input ) )
+    {
+      polygons = reader.polygons();
+      haveBoundaryParameters_ = std::any_of( reader.boundarySegments().begin(), reader.boundarySegments().end(), [] ( const auto &segment ) { return !segment.second.second.empty(); } );
+    }
+    else
+    {
+      input.clear();
+      input.seekg( start );
+      readGeneric( input, reader, polygons, haveBoundaryParameters_ );
+    }
 
-    std::vector< GlobalCoordinate > vertices( parser_.nofvtx );
-    for( int i = 0; i < parser_.nofvtx; ++i )
-      std::copy( parser_.vtx[ i ].begin(), parser_.vtx[ i ].end(), vertices[ i ].begin() );
+    // insert polygons oriented counter-clockwise
+    std::vector< GlobalCoordinate > &vertices = reader.vertices();
+    __PolygonGrid::orientPolygons( vertices, polygons );
 
-    std::vector< std::size_t > counts( parser_.nofelements );
-    for( int i = 0; i < parser_.nofelements; ++i )
-      counts[ i ] = parser_.elements[ i ].size();
+    std::shared_ptr< typename Grid::Mesh > mesh = std::make_shared< typename Grid::Mesh >( vertices, polygons );
 
-    __PolygonGrid::MultiVector< std::size_t > polygons( counts );
-    for( int i = 0; i < parser_.nofelements; ++i )
+    // store boundary ids with the mesh
+    boundarySegments_ = std::move( reader.boundarySegments() );
+    if( !boundarySegments_.empty() )
     {
-      std::copy( parser_.elements[ i ].begin(), parser_.elements[ i ].end(), polygons[ i ].begin() );
-      if( counts[ i ] == 4u )
+      const std::vector< std::pair< std::size_t, std::size_t > > boundaries = __PolygonGrid::boundaryVertices( *mesh, polygons );
+      std::vector< int > ids( boundaries.size(), 1 );
+      for( std::size_t i = 0u; i < boundaries.size(); ++i )
+      {
+        const auto pos = boundarySegments_.find( boundaries[ i ] );
+        if( pos != boundarySegments_.end() )
+          ids[ i ] = pos->second.first;
+      }
+      mesh->setBoundaryIds( std::move( ids ) );
+    }
+
+    numVertexParameters_ = reader.numVertexParameters();
+    numElementParameters_ = reader.numElementParameters();
+    vertexParameters_ = std::move( reader.vertexParameters() );
+    elementParameters_ = std::move( reader.elementParameters() );
+
+    grid_.reset( new Grid( std::move( mesh ), __PolygonGrid::Primal ) );
+  }
+
+
+
+  // DGFGridFactory::readGeneric
+  // ---------------------------
+
+  template< class ct >
+  inline void DGFGridFactory< PolygonGrid< ct > >
+    ::readGeneric ( std::istream &input, Reader &reader, __PolygonGrid::MultiVector< std::size_t > &polygons, bool &haveBoundaryParameters )
+  {
+    const std::istream::pos_type start = input.tellg();
+
+    DuneGridFormatParser parser( 0, 1 );
+    parser.element = DuneGridFormatParser::General;
+    if( !parser.readDuneGrid( input, dimension, GlobalCoordinate::dimension ) )
+      DUNE_THROW( DGFException, "Unable to read DGF stream." );
+
+    // the parser yields all cubes (from Interval and Cube blocks) in reference numbering, followed by the simplices and the (cyclic) polygons
+    input.clear();
+    input.seekg( start );
+    const std::size_t numElements = parser.nofelements;
+    const std::size_t numTrailing = reader.countElements( input, { __PolygonGrid::__DGFReader::Simplex, __PolygonGrid::__DGFReader::Polygon } );
+    if( numTrailing > numElements )
+      DUNE_THROW( DGFException, "Generic DGF parser yields fewer elements than the Simplex and Polygon blocks contain." );
+    const std::size_t numCubes = numElements - numTrailing;
+
+    reader.clear();
+    std::vector< GlobalCoordinate > &vertices = reader.vertices();
+    vertices.resize( parser.nofvtx );
+    for( int i = 0; i < parser.nofvtx; ++i )
+      std::copy( parser.vtx[ i ].begin(), parser.vtx[ i ].end(), vertices[ i ].begin() );
+
+    std::vector< std::size_t > counts( numElements );
+    for( std::size_t i = 0u; i < numElements; ++i )
+      counts[ i ] = parser.elements[ i ].size();
+
+    polygons.resize( counts );
+    for( std::size_t i = 0u; i < numElements; ++i )
+    {
+      std::copy( parser.elements[ i ].begin(), parser.elements[ i ].end(), polygons[ i ].begin() );
+      if( (i < numCubes) && (counts[ i ] == 4u) )
         std::swap( polygons[ i ][ 2u ], polygons[ i ][ 3u ] );
+    }
 
-      // insert polygon oriented counter-clockwise
-      const GlobalCoordinate a = vertices[ polygons[ i ][ 1u ] ] - vertices[ polygons[ i ][ 0u ] ];
-      const GlobalCoordinate b = vertices[ polygons[ i ][ 2u ] ] - vertices[ polygons[ i ][ 0u ] ];
-      if( a[ 0 ]*b[ 1 ] < a[ 1 ]*b[ 0 ] )
-        std::reverse( polygons[ i ].begin(), polygons[ i ].end() );
+    for( const auto &face : parser.facemap )
+    {
+      const std::size_t v0 = face.first[ 0 ], v1 = face.first[ 1 ];
+      reader.boundarySegments()[ std::minmax( v0, v1 ) ] = face.second;
     }
+    haveBoundaryParameters = parser.haveBndParameters;
 
-    grid_.reset( new Grid( std::make_shared< typename Grid::Mesh >( vertices, polygons ), __PolygonGrid::Primal ) );
+    // parameters are swapped out of the parser, which is destroyed afterwards
+    reader.vertexParameters().swap( parser.vtxParams );
+    reader.elementParameters().swap( parser.elParams );
+    reader.setNumParameters( parser.nofvtxparams, parser.nofelparams );
   }
 
 } // namespace Dune
@@ -0,0 +1,498 @@
+#ifndef DUNE_POLYGONGRID_DGFREADER_HH
+#define DUNE_POLYGONGRID_DGFREADER_HH
+
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+#include <algorithm>
+#include <initializer_list>
+#include <istream>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <dune/common/fvector.hh>
+
+#include <dune/grid/io/file/dgfparser/dgfexception.hh>
+
+#include <dune/polygongrid/multivector.hh>
+
+namespace Dune
+{
+
+  namespace __PolygonGrid
+  {
+
+    namespace __DGFReader
+    {
+
+      // Number Parsing
+      // --------------
+
+      inline bool isSpace ( char c ) noexcept { return (c == ' ') || (c == '\t') || (c == '\r') || (c == '\n') || (c == '\v') || (c == '\f'); }
+
+      inline bool isDigit ( char c ) noexcept { return (c >= '0') && (c <= '9'); }
+
+      inline const char *skipSpace ( const char *p, const char *end ) noexcept
+      {
+        while( (p != end) && isSpace( *p ) )
+          ++p;
+        return p;
+      }
+
+      /** \brief parse a non-negative integer, skipping leading white space */
+      template< class T >
+      inline const char *parseInteger ( const char *p, const char *end, T &value )
+      {
+        p = skipSpace( p, end );
+        if( (p == end) || !isDigit( *p ) )
+          DUNE_THROW( DGFException, "Integer expected." );
+        value = 0;
+        for( ; (p != end) && isDigit( *p ); ++p )
+          value = 10*value + static_cast< T >( *p - '0' );
+        return p;
+      }
+
+      /**
+       * \brief parse a real number, skipping leading white space
+       *
+       * Numbers with at most 19 significant digits and small exponents are
+       * converted exactly using a single floating point operation; all other
+       * numbers are passed on to std::strtod.
+       */
+      inline const char *parseReal ( const char *p, const char *end, double &value )
+      {
+        static const double powers[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                         1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+        p = skipSpace( p, end );
+        const char *const begin = p;
+
+        const bool negative = ((p != end) && (*p == '-'));
+        if( (p != end) && ((*p == '-') || (*p == '+')) )
+          ++p;
+
+        std::uint64_t mantissa = 0u;
+        int digits = 0, exponent = 0;
+        bool valid = false;
+        for( ; (p != end) && isDigit( *p ); ++p, valid = true )
+        {
+          if( (mantissa != 0u) || (*p != '0') )
+            ++digits;
+          mantissa = 10u*mantissa + static_cast< std::uint64_t >( *p - '0' );
+        }
+        if( (p != end) && (*p == '.') )
+        {
+          for( ++p; (p != end) && isDigit( *p ); ++p, valid = true )
+          {
+            if( (mantissa != 0u) || (*p != '0') )
+              ++digits;
+            mantissa = 10u*mantissa + static_cast< std::uint64_t >( *p - '0' );
+            --exponent;
+          }
+        }
+        if( !valid )
+          DUNE_THROW( DGFException, "Real number expected." );
+
+        if( (p != end) && ((*p == 'e') || (*p == 'E')) )
+        {
+          const char *q = p+1;
+          const bool negativeExponent = ((q != end) && (*q == '-'));
+          if( (q != end) && ((*q == '-') || (*q == '+')) )
+            ++q;
+          if( (q != end) && isDigit( *q ) )
+          {
+            int e = 0;
+            for( ; (q != end) && isDigit( *q ); ++q )
+              e = std::min( 10*e + (*q - '0'), 100000 );
+            exponent += (negativeExponent ? -e : e);
+            p = q;
+          }
+        }
+
+        if( (digits <= 19) && (mantissa < (std::uint64_t( 1 ) << 53)) && (exponent >= -22) && (exponent <= 22) )
+        {
+          value = static_cast< double >( mantissa );
+          value = (exponent < 0 ? value / powers[ -exponent ] : value * powers[ exponent ]);
+          value = (negative ? -value : value);
+          return p;
+        }
+
+        // slow path (the number is followed by a character that is not part of it)
+        const std::string number( begin, p );
+        value = std::strtod( number.c_str(), nullptr );
+        return p;
+      }
+
+
+
+      // Line
+      // ----
+
+      /** \brief a line of a DGF file with comments removed */
+      struct Line
+      {
+        Line ( const char *begin, const char *end )
+          : begin( begin ), end( std::find( begin, end, '%' ) )
+        {}
+
+        explicit Line ( const std::string &line ) : Line( line.data(), line.data() + line.size() ) {}
+
+        bool empty () const noexcept { return (skipSpace( begin, end ) == end); }
+
+        /** \brief first token in upper case */
+        std::string keyword () const
+        {
+          const char *p = skipSpace( begin, end ), *q = p;
+          while( (q != end) && !isSpace( *q ) )
+            ++q;
+          std::string keyword( p, q );
+          for( char &c : keyword )
+            c = static_cast< char >( std::toupper( static_cast< unsigned char >( c ) ) );
+          return keyword;
+        }
+
+        /** \brief return true, if the line starts with a letter (i.e., a keyword) */
+        bool isKeyword () const noexcept
+        {
+          const char *p = skipSpace( begin, end );
+          return (p != end) && std::isalpha( static_cast< unsigned char >( *p ) );
+        }
+
+        /** \brief return true, if the line terminates a block */
+        bool isTerminator () const noexcept
+        {
+          const char *p = skipSpace( begin, end );
+          return (p != end) && (*p == '#');
+        }
+
+        /** \brief parse integer value following a keyword */
+        template< class T >
+        T value () const
+        {
+          const char *p = skipSpace( begin, end );
+          while( (p != end) && !isSpace( *p ) )
+            ++p;
+          T value;
+          parseInteger( p, end, value );
+          return value;
+        }
+
+        /** \brief number of white space separated tokens */
+        std::size_t numTokens () const noexcept
+        {
+          std::size_t count = 0u;
+          for( const char *p = skipSpace( begin, end ); p != end; p = skipSpace( p, end ), ++count )
+            while( (p != end) && !isSpace( *p ) )
+              ++p;
+          return count;
+        }
+
+        const char *begin, *end;
+      };
+
+
+
+      // Block Types
+      // -----------
+
+      enum BlockType { None, Vertex, Cube, Simplex, Polygon, BoundarySegments, Ignored };
+
+      /** \brief classify a keyword line starting a block (Ignored for blocks that do not describe the mesh) */
+      inline BlockType blockType ( const std::string &keyword, bool &supported )
+      {
+        static const std::vector< std::string > unsupported
+          = { "INTERVAL", "SIMPLEXGENERATOR", "BOUNDARYDOMAIN", "PROJECTION", "PERIODICFACETRANSFORMATION", "GLOBALVERTEXINDEX", "POLYHEDRON" };
+
+        supported = (std::find( unsupported.begin(), unsupported.end(), keyword ) == unsupported.end());
+        if( keyword == "VERTEX" )
+          return Vertex;
+        else if( keyword == "CUBE" )
+          return Cube;
+        else if( keyword == "SIMPLEX" )
+          return Simplex;
+        else if( keyword == "POLYGON" )
+          return Polygon;
+        else if( keyword == "BOUNDARYSEGMENTS" )
+          return BoundarySegments;
+        else
+          return (keyword == "GRIDPARAMETER" ? Ignored : None);
+      }
+
+    } // namespace __DGFReader
+
+
+
+    // DGFReader
+    // ---------
+
+    /**
+     * \brief streaming reader for polygonal DGF files
+     *
+     * The reader understands the DGF blocks Vertex, Cube, Simplex, Polygon
+     * and BoundarySegments, including vertex and element parameters. The
+     * input is processed line by line and stored directly into the flat
+     * arrays consumed by Mesh, so no intermediate representation of the
+     * whole file is kept. If the stream is seekable, it is scanned twice:
+     * the first pass only counts vertices and polygon corners, so the arrays
+     * can be allocated with their final size.
+     *
+     * Cube vertices are stored in cyclic order; the orientation of the
+     * polygons is not changed.
+     */
+    template< class ct >
+    class DGFReader
+    {
+      typedef DGFReader< ct > This;
+
+    public:
+      typedef FieldVector< ct, 2 > GlobalCoordinate;
+
+      typedef std::pair< std::size_t, std::size_t > Key;
+      typedef std::pair< int, std::string > BoundaryData;
+
+      /**
+       * \brief read a DGF stream
+       *
+       * \returns false, if the stream contains blocks that require the
+       *          generic DGF parser (e.g., Interval or BoundaryDomain); the
+       *          stream is left in an unspecified state in this case.
+       */
+      bool read ( std::istream &input )
+      {
+        clear();
+
+        const std::istream::pos_type start = input.tellg();
+        if( start != std::istream::pos_type( -1 ) )
+        {
+          // count entities to allocate the arrays with their final size
+          std::size_t numVertices = 0u, numPolygons = 0u, numCorners = 0u;
+          const bool supported = scan( input, [ &numVertices ] ( const __DGFReader::Line & ) { ++numVertices; },
+                                       [ &numPolygons, &numCorners ] ( __DGFReader::BlockType, const __DGFReader::Line &line, int numParameters ) {
+                                         ++numPolygons;
+                                         numCorners += line.numTokens() - static_cast< std::size_t >( numParameters );
+                                       },
+                                       [] ( const __DGFReader::Line & ) {} );
+          if( !supported )
+            return false;
+
+          vertices_.reserve( numVertices );
+          offsets_.reserve( numPolygons+1 );
+          corners_.reserve( numCorners );
+
+          input.clear();
+          input.seekg( start );
+        }
+
+        offsets_.push_back( 0u );
+        const bool supported = scan( input, [ this ] ( const __DGFReader::Line &line ) { readVertex( line ); },
+                                     [ this ] ( __DGFReader::BlockType type, const __DGFReader::Line &line, int ) { readElement( type, line ); },
+                                     [ this ] ( const __DGFReader::Line &line ) { readBoundarySegment( line ); } );
+        if( !supported )
+          return false;
+
+        for( std::size_t &v : corners_ )
+        {
+          v -= vertexOffset_;
+          if( v >= vertices_.size() )
+            DUNE_THROW( DGFException, "No such vertex: " << v + vertexOffset_ << "." );
+        }
+        return true;
+      }
+
+      /**
+       * \brief count the elements in blocks of the given types
+       *
+       * Blocks requiring the generic DGF parser are skipped, so that the
+       * elements it reads from the supported blocks can be told apart.
+       */
+      std::size_t countElements ( std::istream &input, std::initializer_list< __DGFReader::BlockType > types )
+      {
+        std::size_t count = 0u;
+        scan( input, [] ( const __DGFReader::Line & ) {},
+              [ &count, types ] ( __DGFReader::BlockType type, const __DGFReader::Line &, int ) {
+                if( std::find( types.begin(), types.end(), type ) != types.end() )
+                  ++count;
+              },
+              [] ( const __DGFReader::Line & ) {}, true );
+        return count;
+      }
+
+      void clear ()
+      {
+        vertices_.clear();
+        offsets_.clear();
+        corners_.clear();
+        vertexParameters_.clear();
+        elementParameters_.clear();
+        boundarySegments_.clear();
+        numVertexParameters_ = numElementParameters_ = 0;
+        vertexOffset_ = 0u;
+      }
+
+      std::vector< GlobalCoordinate > &vertices () noexcept { return vertices_; }
+
+      /** \brief move the polygons out of the reader */
+      MultiVector< std::size_t > polygons () { return MultiVector< std::size_t >( std::move( offsets_ ), std::move( corners_ ) ); }
+
+      int numVertexParameters () const noexcept { return numVertexParameters_; }
+      int numElementParameters () const noexcept { return numElementParameters_; }
+
+      void setNumParameters ( int numVertexParameters, int numElementParameters ) noexcept
+      {
+        numVertexParameters_ = numVertexParameters;
+        numElementParameters_ = numElementParameters;
+      }
+
+      std::vector< std::vector< double > > &vertexParameters () noexcept { return vertexParameters_; }
+      std::vector< std::vector< double > > &elementParameters () noexcept { return elementParameters_; }
+
+      /** \brief boundary id and parameter for each boundary segment (key is the sorted pair of vertices) */
+      std::map< Key, BoundaryData > &boundarySegments () noexcept { return boundarySegments_; }
+
+    private:
+      /**
+       * \brief walk through the blocks of a DGF stream
+       *
+       * The callbacks are invoked for each data line of the vertex, element
+       * and boundary segment blocks, respectively. Parameter and index offset
+       * lines are evaluated during the scan. Unless skipUnsupported is set,
+       * the scan stops at the first block requiring the generic DGF parser.
+       */
+      template< class VertexCallback, class ElementCallback, class BoundaryCallback >
+      bool scan ( std::istream &input, VertexCallback vertex, ElementCallback element, BoundaryCallback boundary, bool skipUnsupported = false )
+      {
+        using namespace __DGFReader;
+
+        std::string buffer;
+        while( std::getline( input, buffer ) )
+        {
+          const Line header( buffer );
+          if( header.empty() || !header.isKeyword() )
+            continue;
+
+          bool supported = true;
+          const BlockType type = blockType( header.keyword(), supported );
+          if( !supported && !skipUnsupported )
+            return false;
+          if( (type == None) || !supported )
+            continue;
+
+          int numParameters = 0;
+          while( std::getline( input, buffer ) )
+          {
+            const Line line( buffer );
+            if( line.empty() )
+              continue;
+            if( line.isTerminator() )
+              break;
+            if( type == Ignored )
+              continue;
+
+            if( line.isKeyword() )
+            {
+              const std::string keyword = line.keyword();
+              if( keyword == "PARAMETERS" )
+                numParameters = parameters( type, line.value< int >() );
+              else if( (keyword == "FIRSTINDEX") && (type == Vertex) )
+                vertexOffset_ = line.value< std::size_t >();
+              else
+                DUNE_THROW( DGFException, "Unknown keyword in DGF block " << header.keyword() << ": " << keyword << "." );
+            }
+            else if( type == Vertex )
+              vertex( line );
+            else if( type == BoundarySegments )
+              boundary( line );
+            else
+              element( type, line, numParameters );
+          }
+        }
+        return true;
+      }
+
+      int parameters ( __DGFReader::BlockType type, int numParameters )
+      {
+        int &current = (type == __DGFReader::Vertex ? numVertexParameters_ : numElementParameters_);
+        if( (type == __DGFReader::Polygon) || (type == __DGFReader::BoundarySegments) )
+          DUNE_THROW( DGFException, "Parameters are not supported in this DGF block." );
+        if( (current != 0) && (current != numParameters) )
+          DUNE_THROW( DGFException, "Inconsistent number of parameters: " << numParameters << " (expected " << current << ")." );
+        current = numParameters;
+        return numParameters;
+      }
+
+      void readVertex ( const __DGFReader::Line &line )
+      {
+        double x[ 2 ];
+        const char *p = __DGFReader::parseReal( __DGFReader::parseReal( line.begin, line.end, x[ 0 ] ), line.end, x[ 1 ] );
+        vertices_.emplace_back( GlobalCoordinate{ static_cast< ct >( x[ 0 ] ), static_cast< ct >( x[ 1 ] ) } );
+        if( numVertexParameters_ > 0 )
+          vertexParameters_.push_back( readParameters( p, line.end, numVertexParameters_ ) );
+      }
+
+      void readElement ( __DGFReader::BlockType type, const __DGFReader::Line &line )
+      {
+        const std::size_t numTokens = line.numTokens();
+        const int numParameters = (type == __DGFReader::Polygon ? 0 : numElementParameters_);
+        const std::size_t numCorners = numTokens - static_cast< std::size_t >( numParameters );
+        if( (numTokens < static_cast< std::size_t >( numParameters ) + 3u)
+            || ((type == __DGFReader::Cube) && (numCorners != 4u)) || ((type == __DGFReader::Simplex) && (numCorners != 3u)) )
+          DUNE_THROW( DGFException, "Invalid element in DGF file: " << std::string( line.begin, line.end ) );
+
+        const char *p = line.begin;
+        for( std::size_t i = 0u; i < numCorners; ++i )
+        {
+          std::size_t v;
+          p = __DGFReader::parseInteger( p, line.end, v );
+          corners_.push_back( v );
+        }
+        if( type == __DGFReader::Cube )
+          std::swap( corners_[ corners_.size()-2u ], corners_[ corners_.size()-1u ] );
+        offsets_.push_back( corners_.size() );
+
+        if( numParameters > 0 )
+          elementParameters_.push_back( readParameters( p, line.end, numParameters ) );
+      }
+
+      void readBoundarySegment ( const __DGFReader::Line &line )
+      {
+        int id;
+        std::size_t v0, v1;
+        const char *p = __DGFReader::skipSpace( line.begin, line.end );
+        const bool negative = ((p != line.end) && (*p == '-'));
+        p = __DGFReader::parseInteger( p + (negative ? 1 : 0), line.end, id );
+        p = __DGFReader::parseInteger( __DGFReader::parseInteger( p, line.end, v0 ), line.end, v1 );
+        v0 -= vertexOffset_;
+        v1 -= vertexOffset_;
+
+        std::string parameter;
+        p = __DGFReader::skipSpace( p, line.end );
+        if( (p != line.end) && (*p == ':') )
+          parameter.assign( __DGFReader::skipSpace( p+1, line.end ), line.end );
+        boundarySegments_[ std::minmax( v0, v1 ) ] = BoundaryData( negative ? -id : id, std::move( parameter ) );
+      }
+
+      static std::vector< double > readParameters ( const char *p, const char *end, int numParameters )
+      {
+        std::vector< double > parameters( numParameters );
+        for( double &parameter : parameters )
+          p = __DGFReader::parseReal( p, end, parameter );
+        return parameters;
+      }
+
+      std::vector< GlobalCoordinate > vertices_;
+      std::vector< std::size_t > offsets_, corners_;
+      std::vector< std::vector< double > > vertexParameters_, elementParameters_;
+      std::map< Key, BoundaryData > boundarySegments_;
+      int numVertexParameters_ = 0, numElementParameters_ = 0;
+      std::size_t vertexOffset_ = 0u;
+    };
+
+  } // namespace __PolygonGrid
+
+} // namespace Dune
+
+#endif // #ifndef DUNE_POLYGONGRID_DGFREADER_HH
@@ -75,9 +75,9 @@ namespace Dune
 
       Geometry geometry () const { return Geometry( GeometryImpl( item() ) ); }
 
-      EntitySeed seed () const { return EntitySeedImpl( item().index() ); }
+      EntitySeed seed () const { return EntitySeedImpl( item().index(), level() ); }
 
-      int level () const noexcept { return 0; }
+      int level () const noexcept { return item().mesh().level(); }
 
       bool equals ( const This &other ) const { return (item_ == other.item_); }
 
@@ -197,27 +197,40 @@ namespace Dune
       std::size_t subIndex ( int codim, std::size_t i ) const noexcept
       {
         assert( i < subEntities( codim ) );
+        // edge indices are precomputed in the order of the half edges, corners are the targets
+        const auto &mesh = item().mesh();
         switch( codim )
         {
         case 0:
           return __PolygonGrid::subEntity( item(), Dune::Codim< 0 >(), i ).uniqueIndex();
 
         case 1:
-          return __PolygonGrid::subEntity( item(), Dune::Codim< 1 >(), i ).uniqueIndex();
+          return mesh.edgeIndex( mesh.begin( item().index() ) + static_cast< std::ptrdiff_t >( i ) );
 
         case 2:
-          return __PolygonGrid::subEntity( item(), Dune::Codim< 2 >(), i ).uniqueIndex();
+          return mesh.target( mesh.begin( item().index() ) + static_cast< std::ptrdiff_t >( i ) );
 
         default:
           std::terminate();
         }
       }
 
-      bool isLeaf () const noexcept { return true; }
+      bool isLeaf () const noexcept { return item().mesh().leaf(); }
 
-      Dune::Entity< 0, 2, Grid, __PolygonGrid::Entity > father () const { assert( hasFather() ); std::terminate(); }
+      Dune::Entity< 0, 2, Grid, __PolygonGrid::Entity > father () const
+      {
+        assert( hasFather() );
+        const auto &mesh = item().mesh();
+        return This( Item( mesh.father().get(), NodeIndex( mesh.father( item().index() ), Dual ) ) );
+      }
 
-      bool hasFather () const { return false; }
+      /**
+       * \brief return true, if the entity has a father
+       *
+       * \note Only the cells of the primal mesh are nested within the
+       *       hierarchy. Dual cells never have a father.
+       */
+      bool hasFather () const { return (item().index().type() == Dual) && static_cast< bool >( item().mesh().father() ); }
 
       LocalGeometry geometryInFather () const { assert( hasFather() ); std::terminate(); }
 
@@ -225,7 +238,11 @@ namespace Dune
       HierarchicIterator hend ( int maxLevel ) const { return HierarchicIteratorImpl(); }
 
       bool isRegular () const { return true; }
-      bool isNew () const { return false; }
+      bool isNew () const
+      {
+        const auto &mesh = item().mesh();
+        return hasFather() && mesh.leaf() && (mesh.father()->children().size( mesh.father( item().index() ) ) > 1u);
+      }
       bool mightVanish () const { return false; }
 
       bool hasBoundaryIntersections () const
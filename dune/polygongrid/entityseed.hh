@@ -26,17 +26,19 @@ namespace Dune
       static const int codimension = codim;
 
       EntitySeed () = default;
-      explicit EntitySeed ( const Index &index ) : index_( index ) {}
+      explicit EntitySeed ( const Index &index, int level = 0 ) : index_( index ), level_( level ) {}
 
       bool isValid () const noexcept { return static_cast< bool >( index() ); }
 
-      bool operator== ( const This &other ) const noexcept { return (index() == other.index()); }
-      bool operator!= ( const This &other ) const noexcept { return (index() != other.index()); }
+      bool operator== ( const This &other ) const noexcept { return (index() == other.index()) && (level() == other.level()); }
+      bool operator!= ( const This &other ) const noexcept { return !(*this == other); }
 
       Index index () const noexcept { return index_; }
+      int level () const noexcept { return level_; }
 
     private:
       Index index_;
+      int level_ = 0;
     };
 
   } // namespace __PolygonGrid
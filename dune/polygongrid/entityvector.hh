@@ -0,0 +1,130 @@
+#ifndef DUNE_POLYGONGRID_ENTITYVECTOR_HH
+#define DUNE_POLYGONGRID_ENTITYVECTOR_HH
+
+#include <cassert>
+#include <cstddef>
+
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+
+#include <dune/common/alignedallocator.hh>
+
+#include <dune/polygongrid/mesh.hh>
+
+namespace Dune
+{
+
+  namespace __PolygonGrid
+  {
+
+    // EntityVector
+    // ------------
+
+    /**
+     * \brief flat array of data attached to the entities of a given codimension
+     *
+     * The data is stored contiguously and 64 byte aligned and indexed
+     * directly by the entity index. As all entities of a codimension share
+     * the same geometry type (none), this replaces the generic mappers.
+     * The vector can be sized for either the primal or the dual grid.
+     */
+    template< class T, int codim >
+    class EntityVector
+    {
+      typedef EntityVector< T, codim > This;
+
+    public:
+      static const int codimension = codim;
+      static const std::size_t alignment = 64u;
+
+      typedef std::vector< T, Dune::AlignedAllocator< T, alignment > > Container;
+
+      typedef typename Container::value_type value_type;
+      typedef typename Container::size_type size_type;
+      typedef typename Container::reference reference;
+      typedef typename Container::const_reference const_reference;
+      typedef typename Container::iterator iterator;
+      typedef typename Container::const_iterator const_iterator;
+
+      EntityVector () = default;
+
+      template< class ct >
+      EntityVector ( const Mesh< ct > &mesh, MeshType type, const T &value = T() )
+        : data_( size( mesh, type ), value )
+      {}
+
+      /** \brief construct for the entities of a PolygonGrid grid view */
+      template< class GridView, std::enable_if_t< (GridView::dimension == 2), int > = 0 >
+      explicit EntityVector ( const GridView &gridView, const T &value = T() )
+        : data_( gridView.size( codim ), value )
+      {}
+
+      template< class ct >
+      void resize ( const Mesh< ct > &mesh, MeshType type, const T &value = T() )
+      {
+        data_.resize( size( mesh, type ), value );
+      }
+
+      void fill ( const T &value ) { std::fill( data_.begin(), data_.end(), value ); }
+
+      const_reference operator[] ( size_type i ) const noexcept { assert( i < size() ); return data_[ i ]; }
+      reference operator[] ( size_type i ) noexcept { assert( i < size() ); return data_[ i ]; }
+
+      template< class Entity, std::enable_if_t< (Entity::codimension == codim), int > = 0 >
+      const_reference operator[] ( const Entity &entity ) const noexcept
+      {
+        return (*this)[ entity.impl().index() ];
+      }
+
+      template< class Entity, std::enable_if_t< (Entity::codimension == codim), int > = 0 >
+      reference operator[] ( const Entity &entity ) noexcept
+      {
+        return (*this)[ entity.impl().index() ];
+      }
+
+      const_iterator begin () const noexcept { return data_.begin(); }
+      iterator begin () noexcept { return data_.begin(); }
+
+      const_iterator end () const noexcept { return data_.end(); }
+      iterator end () noexcept { return data_.end(); }
+
+      const T *data () const noexcept { return data_.data(); }
+      T *data () noexcept { return data_.data(); }
+
+      bool empty () const noexcept { return data_.empty(); }
+      size_type size () const noexcept { return data_.size(); }
+
+      const Container &container () const noexcept { return data_; }
+      Container &container () noexcept { return data_; }
+
+      template< class ct >
+      static size_type size ( const Mesh< ct > &mesh, MeshType type ) noexcept
+      {
+        static_assert( (codim >= 0) && (codim <= 2), "Invalid codimension" );
+        return (codim == 0 ? mesh.numCells( type ) : (codim == 1 ? mesh.numEdges( type ) : mesh.numVertices( type )));
+      }
+
+    private:
+      Container data_;
+    };
+
+
+
+    // CellVector, EdgeVector, VertexVector
+    // ------------------------------------
+
+    template< class T >
+    using CellVector = EntityVector< T, 0 >;
+
+    template< class T >
+    using EdgeVector = EntityVector< T, 1 >;
+
+    template< class T >
+    using VertexVector = EntityVector< T, 2 >;
+
+  } // namespace __PolygonGrid
+
+} // namespace Dune
+
+#endif // #ifndef DUNE_POLYGONGRID_ENTITYVECTOR_HH
@@ -0,0 +1,141 @@
+#ifndef DUNE_POLYGONGRID_FIXEDVALENCE_HH
+#define DUNE_POLYGONGRID_FIXEDVALENCE_HH
+
+#include <cassert>
+#include <cstddef>
+
+#include <array>
+#include <type_traits>
+
+#include <dune/polygongrid/mesh.hh>
+#include <dune/polygongrid/polygonmoments.hh>
+
+namespace Dune
+{
+
+  namespace __PolygonGrid
+  {
+
+    // dynamicValence
+    // --------------
+
+    /** \brief valence of a FixedValenceMesh whose polygons may differ in size */
+    static constexpr std::size_t dynamicValence = 0u;
+
+
+
+    // FixedValenceMesh
+    // ----------------
+
+    /**
+     * \brief view of the primal cells of a mesh, all polygons having N corners
+     *
+     * If all polygons share the same number of corners N (e.g., all
+     * triangles, quadrilaterals or hexagons), the rows of the cells in the
+     * mesh structure are N entries apart. This view replaces the offset
+     * lookup by the compile-time stride N, so that loops over the corners
+     * have a constant trip count and can be fully unrolled.
+     *
+     * For N = dynamicValence, the offsets are used, i.e., the view works
+     * for arbitrary meshes. Use dispatchValence to select the view matching
+     * Mesh::polygonSize at run time.
+     */
+    template< class ct, std::size_t N >
+    class FixedValenceMesh
+    {
+      typedef FixedValenceMesh< ct, N > This;
+
+    public:
+      typedef __PolygonGrid::Mesh< ct > Mesh;
+
+      typedef typename Mesh::GlobalCoordinate GlobalCoordinate;
+
+      static constexpr std::size_t valence = N;
+
+      explicit FixedValenceMesh ( const Mesh &mesh ) noexcept
+        : mesh_( mesh )
+      {
+        assert( (N == dynamicValence) || (mesh.polygonSize() == N) );
+      }
+
+      std::size_t numCells () const noexcept { return mesh().numCells( Primal ); }
+
+      /** \brief number of corners of cell i */
+      std::size_t size ( std::size_t i ) const noexcept { return (N != dynamicValence ? N : cells().size( i )); }
+
+      /** \brief half edge ending in corner j of cell i */
+      HalfEdgeIndex halfEdge ( std::size_t i, std::size_t j ) const noexcept
+      {
+        assert( j < size( i ) );
+        return HalfEdgeIndex( (N != dynamicValence ? N*i : cells().begin_of( i )) + j, Primal );
+      }
+
+      /** \brief corner j of cell i (as seen from the cell, i.e., including periodic shifts) */
+      GlobalCoordinate corner ( std::size_t i, std::size_t j ) const noexcept { return mesh().position( halfEdge( i, j ) ); }
+
+      /** \brief index of the vertex in corner j of cell i */
+      std::size_t vertex ( std::size_t i, std::size_t j ) const noexcept { return mesh().target( halfEdge( i, j ) ); }
+
+      /** \brief index of the edge ending in corner j of cell i */
+      std::size_t edge ( std::size_t i, std::size_t j ) const noexcept { return mesh().edgeIndex( halfEdge( i, j ) ); }
+
+      /** \brief all corners of cell i (only for fixed valence) */
+      template< std::size_t n = N, std::enable_if_t< (n != dynamicValence), int > = 0 >
+      std::array< GlobalCoordinate, N > corners ( std::size_t i ) const noexcept
+      {
+        std::array< GlobalCoordinate, N > corners;
+        for( std::size_t j = 0u; j < N; ++j )
+          corners[ j ] = corner( i, j );
+        return corners;
+      }
+
+      /** \brief volume and centroid of cell i, relative to its first corner */
+      PolygonMoments< ct > moments ( std::size_t i ) const noexcept
+      {
+        return polygonMoments( size( i ), [ this, i ] ( std::size_t j ) { return corner( i, j ); } );
+      }
+
+      ct volume ( std::size_t i ) const noexcept { return moments( i ).volume(); }
+
+      GlobalCoordinate center ( std::size_t i ) const noexcept { return moments( i ).center(); }
+
+      const Mesh &mesh () const noexcept { return mesh_; }
+
+    private:
+      const MultiVector< IndexPair > &cells () const noexcept { return mesh().nodes( Dual ); }
+
+      const Mesh &mesh_;
+    };
+
+
+
+    // dispatchValence
+    // ---------------
+
+    /**
+     * \brief call f with the FixedValenceMesh matching the polygon size of the mesh
+     *
+     * Uniform triangle, quadrilateral and hexagon meshes are dispatched to
+     * the corresponding fixed valence; all other meshes use dynamicValence.
+     */
+    template< class ct, class F >
+    inline decltype( auto ) dispatchValence ( const Mesh< ct > &mesh, F &&f )
+    {
+      switch( mesh.polygonSize() )
+      {
+      case 3u:
+        return f( FixedValenceMesh< ct, 3u >( mesh ) );
+      case 4u:
+        return f( FixedValenceMesh< ct, 4u >( mesh ) );
+      case 6u:
+        return f( FixedValenceMesh< ct, 6u >( mesh ) );
+      default:
+        return f( FixedValenceMesh< ct, dynamicValence >( mesh ) );
+      }
+    }
+
+  } // namespace __PolygonGrid
+
+} // namespace Dune
+
+#endif // #ifndef DUNE_POLYGONGRID_FIXEDVALENCE_HH
@@ -15,6 +15,7 @@
 #include <dune/grid/common/geometry.hh>
 
 #include <dune/polygongrid/identitymatrix.hh>
+#include <dune/polygongrid/polygonmoments.hh>
 #include <dune/polygongrid/subentity.hh>
 
 namespace Dune
@@ -85,39 +86,17 @@ namespace Dune
 
       int corners () const noexcept { return numSubEntities( cell_, Dune::Codim< 2 >() ); }
 
-      const GlobalCoordinate &corner ( int i ) const noexcept
+      GlobalCoordinate corner ( int i ) const noexcept
       {
-        return subEntity( cell_, Dune::Codim< 2 >(), i ).position();
+        // use the position as seen from the cell (differs from the vertex position across periodic boundaries)
+        return cell_.halfEdges().begin()[ i ].targetPosition();
       }
 
-      GlobalCoordinate center () const noexcept
-      {
-        GlobalCoordinate center( 0 );
-        ctype volume = 0;
-        for( int i = 0; i < corners(); ++i )
-        {
-          const GlobalCoordinate &x = corner( i );
-          const GlobalCoordinate &y = corner( (i+1) % corners() );
-          const ctype weight = x[ 0 ]*y[ 1 ] - x[ 1 ]*y[ 0 ];
-          center.axpy( weight, x+y );
-          volume += weight;
-        }
-        return center *= ctype( 1 ) / (ctype( 3 )*volume);
-      }
+      GlobalCoordinate center () const noexcept { return moments().center(); }
 
       GeometryType type () const noexcept { return GeometryTypes::none( mydimension ); }
 
-      ctype volume () const noexcept
-      {
-        ctype volume = 0;
-        for( int i = 0; i < corners(); ++i )
-        {
-          const GlobalCoordinate &x = corner( i );
-          const GlobalCoordinate &y = corner( (i+1) % corners() );
-          volume += x[ 0 ]*y[ 1 ] - x[ 1 ]*y[ 0 ];
-        }
-        return volume / ctype( 2 );
-      }
+      ctype volume () const noexcept { return moments().volume(); }
 
       bool affine () const { return false; }
 
@@ -147,6 +126,11 @@ namespace Dune
       }
 
     private:
+      __PolygonGrid::PolygonMoments< ctype > moments () const noexcept
+      {
+        return __PolygonGrid::polygonMoments( corners(), [ this ] ( std::size_t i ) { return corner( i ); } );
+      }
+
       const CartesianGeometryType& bboxImpl() const
       {
         if( ! bboxImpl_ )
@@ -193,9 +177,10 @@ namespace Dune
 
       int corners () const { return numSubEntities( halfEdge_, Dune::Codim< 1 >() ); }
 
-      const GlobalCoordinate &corner ( int i ) const
+      GlobalCoordinate corner ( int i ) const
       {
-        return subEntity( halfEdge_, Dune::Codim< 1 >(), i ).position();
+        assert( (i >= 0) && (i < 2) );
+        return (i == 1 ? halfEdge_.targetPosition() : halfEdge_.sourcePosition());
       }
 
       GlobalCoordinate center () const
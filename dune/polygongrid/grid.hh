@@ -1,15 +1,20 @@
 #ifndef DUNE_POLYGONGRID_GRID_HH
 #define DUNE_POLYGONGRID_GRID_HH
 
+#include <algorithm>
+#include <limits>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include <dune/geometry/dimension.hh>
 
 #include <dune/grid/common/grid.hh>
 
+#include <dune/polygongrid/agglomeration.hh>
 #include <dune/polygongrid/capabilities.hh>
 #include <dune/polygongrid/gridfamily.hh>
+#include <dune/polygongrid/refinement.hh>
 
 namespace Dune
 {
@@ -56,37 +61,121 @@ namespace Dune
     PolygonGrid ( std::shared_ptr< Mesh > mesh, __PolygonGrid::MeshType type )
       : mesh_( std::move( mesh ) ), type_( std::move( type ) ),
         indexSet_( *mesh_, type_ )
-    {}
+    {
+      if( type_ == __PolygonGrid::Dual )
+        mesh_->buildDual();
+      setupLevels();
+    }
 
     PolygonGrid ( const This &other )
       : mesh_( other.mesh_ ), type_( other.type_ ),
-        indexSet_( *mesh_, type_ )
+        indexSet_( *mesh_, type_ ), levelGrids_( other.levelGrids_ ), maxLevels_( other.maxLevels_ )
     {}
 
     PolygonGrid ( This &other )
       : mesh_( std::move( other.mesh_ ) ), type_( std::move( other.type_ ) ),
-        indexSet_( *mesh_, type_ )
+        indexSet_( *mesh_, type_ ), levelGrids_( std::move( other.levelGrids_ ) ), maxLevels_( other.maxLevels_ )
     {}
 
-    int maxLevel () const { return 0; }
+    int maxLevel () const { return static_cast< int >( levelGrids_.size() ); }
 
     std::size_t numBoundarySegments () const { return mesh().numBoundaries( type() ); }
 
-    MacroGridView macroGridView () const { return __PolygonGrid::GridView< ct > ( *this ); }
+    MacroGridView macroGridView () const { return levelGridView( 0 ); }
+
+    LevelGridView levelGridView ( int level ) const
+    {
+      assert( (level >= 0) && (level <= maxLevel()) );
+      return (level < maxLevel() ? levelGrids_[ level ]->leafGridView() : leafGridView());
+    }
 
-    LevelGridView levelGridView ( int level ) const { assert( level == 0 ); return macroGridView(); }
-    LeafGridView leafGridView () const { return macroGridView(); }
+    LeafGridView leafGridView () const { return __PolygonGrid::GridView< ct > ( *this ); }
 
     const GlobalIdSet &globalIdSet () const { return idSet_; }
     const LocalIdSet &localIdSet () const { return idSet_; }
 
-    bool globalRefine ( int refCount ) { return false; }
+    /**
+     * \brief refine all primal cells refCount times
+     *
+     * \note On the dual grid, the underlying primal cells are refined.
+     */
+    bool globalRefine ( int refCount )
+    {
+      for( int i = 0; i < refCount; ++i )
+      {
+        marks_.assign( mesh().numCells( __PolygonGrid::Primal ), 1 );
+        adapt();
+      }
+      return (refCount > 0);
+    }
+
+    /**
+     * \brief mark a leaf element for refinement
+     *
+     * Only refinement of primal cells is supported, i.e., marks on the dual
+     * grid and coarsening marks are rejected.
+     */
+    bool mark ( int refCount, const typename Traits::template Codim< 0 >::Entity &entity )
+    {
+      if( (type() != __PolygonGrid::Primal) || (&entity.impl().item().mesh() != mesh_.get()) )
+        return false;
+      marks_.resize( mesh().numCells( __PolygonGrid::Primal ), 0 );
+      marks_[ indexSet_.index( entity ) ] = (refCount > 0 ? 1 : 0);
+      return (refCount > 0);
+    }
 
-    bool mark ( int refCount, const typename Traits::template Codim< 0 >::Entity &entity ) const { return false; }
-    int getMark ( const typename Traits::template Codim< 0 >::Entity &entity ) const { return 0; }
+    int getMark ( const typename Traits::template Codim< 0 >::Entity &entity ) const
+    {
+      if( marks_.empty() || (&entity.impl().item().mesh() != mesh_.get()) )
+        return 0;
+      return marks_[ indexSet_.index( entity ) ];
+    }
 
     bool preAdapt () { return false; }
-    bool adapt () { return false; }
+
+    /**
+     * \brief refine all marked elements
+     *
+     * The marked polygons are split into quadrilaterals and their neighbors
+     * receive the edge midpoints (see __PolygonGrid::refine), so no closure
+     * refinement is necessary. The previous leaf mesh becomes the next
+     * coarser level; unrefined elements keep their leaf index. Unless the
+     * number of levels is limited (see limitLevels), the hierarchy grows
+     * with each adaptation. Entities not changed by the refinement keep
+     * their ids, so data attached to ids persists across adaptation.
+     *
+     * Piecewise constant data can be transferred using
+     * __PolygonGrid::RestrictProlong< ct >( grid.sharedMesh() ).
+     */
+    bool adapt ()
+    {
+      if( std::find( marks_.begin(), marks_.end(), 1 ) == marks_.end() )
+      {
+        marks_.clear();
+        return false;
+      }
+
+      if( mesh().periodic() )
+        DUNE_THROW( NotImplemented, "Refinement of periodic meshes not implemented yet" );
+
+      mesh_ = __PolygonGrid::refine( mesh_, marks_ );
+      marks_.clear();
+      if( mesh().level() > maxLevels_ )
+      {
+        // keep the newest levels only, renumbering them from level 0
+        std::vector< std::shared_ptr< Mesh > > meshes( 1u, mesh_ );
+        while( static_cast< int >( meshes.size() ) <= maxLevels_ )
+          meshes.push_back( meshes.back()->father() );
+        attachCopies( meshes, nullptr, {} );
+      }
+      else
+      {
+        indexSet_ = __PolygonGrid::IndexSet< ct >( *mesh_, type_ );
+        setupLevels();
+      }
+      return true;
+    }
+
     void postAdapt () {}
 
     const Communication &comm () const { return comm_; }
@@ -104,7 +193,8 @@ namespace Dune
     {
       typedef __PolygonGrid::Entity< Seed::codimension, 2, const This > EntityImpl;
       typedef typename std::conditional< Seed::codimension == 1, __PolygonGrid::HalfEdge< ct >, __PolygonGrid::Node< ct > >::type Item;
-      return EntityImpl( Item( mesh_.get(), seed.impl().index() ) );
+      const int level = seed.impl().level();
+      return EntityImpl( Item( (level < maxLevel() ? &levelGrids_[ level ]->mesh() : mesh_.get()), seed.impl().index() ) );
     }
 
     // deprecated interface methods
@@ -118,21 +208,170 @@ namespace Dune
     int overlapSize( int ) const { return 0; }
 
     const LeafIndexSet &leafIndexSet () const { return indexSet_; }
-    const LevelIndexSet &levelIndexSet ( int level ) const { assert( level == 0 ); return indexSet_; }
+    const LevelIndexSet &levelIndexSet ( int level ) const
+    {
+      assert( (level >= 0) && (level <= maxLevel()) );
+      return (level < maxLevel() ? levelGrids_[ level ]->leafIndexSet() : indexSet_);
+    }
 
     // non-interface methods
 
+    /**
+     * \brief grid of the dual type sharing the mesh of this grid
+     *
+     * If the mesh was created without its dual data (see
+     * GridFactory::setLazyDual), the data is built on the first call.
+     */
     This dualGrid () const { return This( mesh_, dual( type() ) ); }
 
+    /**
+     * \brief move the primal vertices without changing the topology
+     *
+     * Only the leaf mesh can be moved, so the grid must not have coarser
+     * levels (see coarsen and adapt).
+     *
+     * \note The mesh is shared with the dual grid, which is moved, too.
+     */
+    void setPositions ( const std::vector< typename Mesh::GlobalCoordinate > &vertices )
+    {
+      checkUnrefined();
+      mesh_->setPositions( vertices );
+    }
+
+    /** \brief move the primal vertices by f( i, x ), see setPositions */
+    template< class F >
+    void movePositions ( F &&f )
+    {
+      checkUnrefined();
+      mesh_->movePositions( std::forward< F >( f ) );
+    }
+
+    /**
+     * \brief add coarser levels by agglomeration of neighboring cells
+     *
+     * Each new level is obtained from the current coarsest level by merging
+     * pairs of neighboring primal cells (see __PolygonGrid::coarsen). The
+     * leaf level remains unchanged; the level of all existing levels is
+     * increased by the number of levels added.
+     *
+     * The meshes of the existing levels are shared with other grids (e.g.,
+     * the dual grid), so they are not modified. Instead, this grid switches
+     * to detached copies of them (see __PolygonGrid::Mesh::detachedCopy),
+     * which keep the entity ids.
+     *
+     * \param[in]  count  maximum number of levels to add
+     *
+     * \returns number of levels actually added
+     *
+     * \note Copies of this grid (including its dual grid) created before
+     *       coarsening or adaptation keep their hierarchy.
+     */
+    int coarsen ( int count = 1 )
+    {
+      if( mesh().periodic() )
+        DUNE_THROW( NotImplemented, "Coarsening of periodic meshes not implemented yet" );
+
+      // existing meshes, starting with the leaf
+      std::vector< std::shared_ptr< Mesh > > meshes( 1u, mesh_ );
+      while( meshes.back()->father() )
+        meshes.push_back( meshes.back()->father() );
+
+      // new coarse meshes, starting with the finest
+      std::vector< std::shared_ptr< Mesh > > coarse;
+      std::vector< std::vector< std::size_t > > fathers;
+      for( const Mesh *coarsest = meshes.back().get(); static_cast< int >( coarse.size() ) < count; coarsest = coarse.back().get() )
+      {
+        fathers.emplace_back();
+        std::shared_ptr< Mesh > father = __PolygonGrid::coarsen( *coarsest, fathers.back() );
+        if( !father )
+          break;
+        coarse.push_back( std::move( father ) );
+      }
+      if( coarse.empty() )
+        return 0;
+
+      // attach the levels, starting with the coarsest
+      for( std::size_t i = coarse.size()-1u; i > 0u; --i )
+        coarse[ i-1u ]->setFather( coarse[ i ], std::move( fathers[ i ] ) );
+      attachCopies( meshes, coarse.front(), std::move( fathers.front() ) );
+      return static_cast< int >( coarse.size() );
+    }
+
+    /**
+     * \brief limit the number of coarser levels kept by adapt
+     *
+     * If an adaptation exceeds the limit, the oldest levels are dropped and
+     * the remaining ones are renumbered, starting with level 0. As in
+     * coarsen, this grid switches to detached copies of the remaining
+     * meshes, so the entity ids do not change.
+     *
+     * \param[in]  levels  maximum number of coarser levels (at least 1, so
+     *                     data can be transferred from the father, see adapt)
+     */
+    void limitLevels ( int levels )
+    {
+      assert( levels >= 1 );
+      maxLevels_ = levels;
+    }
+
     const Mesh &mesh () const { return *mesh_; }
     MeshType type () const { return type_; }
 
+    /** \brief shared ownership of the leaf mesh, e.g., to keep its data alive while it is referenced elsewhere */
+    const std::shared_ptr< Mesh > &sharedMesh () const noexcept { return mesh_; }
+
   private:
+    PolygonGrid ( std::shared_ptr< Mesh > mesh, __PolygonGrid::MeshType type, std::vector< std::shared_ptr< const This > > levelGrids )
+      : mesh_( std::move( mesh ) ), type_( std::move( type ) ),
+        indexSet_( *mesh_, type_ ), levelGrids_( std::move( levelGrids ) )
+    {
+      if( type_ == __PolygonGrid::Dual )
+        mesh_->buildDual();
+    }
+
+    // switch to detached copies of the given meshes (starting with the leaf), attaching the coarsest one to father
+    void attachCopies ( const std::vector< std::shared_ptr< Mesh > > &meshes, std::shared_ptr< Mesh > father, std::vector< std::size_t > fathers )
+    {
+      for( auto it = meshes.rbegin(); it != meshes.rend(); ++it )
+      {
+        std::shared_ptr< Mesh > copy = (*it)->detachedCopy();
+        if( father )
+          copy->setFather( std::move( father ), std::move( fathers ) );
+        fathers = (*it)->fathers();
+        father = std::move( copy );
+      }
+
+      mesh_ = std::move( father );
+      indexSet_ = __PolygonGrid::IndexSet< ct >( *mesh_, type_ );
+      setupLevels();
+    }
+
+    void checkUnrefined () const
+    {
+      if( maxLevel() > 0 )
+        DUNE_THROW( InvalidStateException, "Cannot move the vertices of a grid with coarser levels." );
+    }
+
+    void setupLevels ()
+    {
+      std::vector< std::shared_ptr< Mesh > > meshes;
+      for( std::shared_ptr< Mesh > father = mesh_->father(); father; father = father->father() )
+        meshes.push_back( father );
+
+      // create grids for the coarser levels, starting with level 0
+      levelGrids_.clear();
+      for( auto it = meshes.rbegin(); it != meshes.rend(); ++it )
+        levelGrids_.emplace_back( new This( *it, type_, levelGrids_ ) );
+    }
+
     std::shared_ptr< Mesh > mesh_;
     __PolygonGrid::MeshType type_;
     Communication comm_;
     LocalIdSet idSet_;
     __PolygonGrid::IndexSet< ct > indexSet_;
+    std::vector< std::shared_ptr< const This > > levelGrids_;
+    std::vector< char > marks_;
+    int maxLevels_ = std::numeric_limits< int >::max();
   };
 
 } // namespace Dune
@@ -1,12 +1,17 @@
 #ifndef DUNE_POLYGONGRID_GRIDFACTORY_HH
 #define DUNE_POLYGONGRID_GRIDFACTORY_HH
 
+#include <cmath>
+
 #include <algorithm>
+#include <limits>
+#include <map>
 #include <memory>
 #include <utility>
 #include <vector>
 
 #include <dune/common/exceptions.hh>
+#include <dune/common/fmatrix.hh>
 
 #include <dune/geometry/type.hh>
 
@@ -14,6 +19,11 @@
 
 #include <dune/polygongrid/grid.hh>
 #include <dune/polygongrid/mesh.hh>
+#include <dune/polygongrid/orientation.hh>
+#include <dune/polygongrid/periodic.hh>
+#include <dune/polygongrid/renumbering.hh>
+#include <dune/polygongrid/repair.hh>
+#include <dune/polygongrid/sparsitypattern.hh>
 
 namespace Dune
 {
@@ -31,6 +41,7 @@ namespace Dune
 
     typedef PolygonGrid< ct > Grid;
     typedef FieldVector< ct, 2 > GlobalCoordinate;
+    typedef FieldMatrix< ct, 2, 2 > WorldMatrix;
 
     typedef typename Grid::CollectiveCommunication Communication;
 
@@ -62,27 +73,128 @@ namespace Dune
         std::swap( polygon[ 2 ], polygon[ 3 ] );
       }
 
-      // insert polygon oriented counter-clockwise
-      const GlobalCoordinate a = vertices_[ polygon[ 1 ] ] - vertices_[ polygon[ 0 ] ];
-      const GlobalCoordinate b = vertices_[ polygon[ 2 ] ] - vertices_[ polygon[ 0 ] ];
-      if( a[ 0 ]*b[ 1 ] - a[ 1 ]*b[ 0 ] < ct( 0 ) )
-        std::reverse( polygon.begin(), polygon.end() );
+      // the polygons are oriented counter-clockwise in createGrid
+      polygons_.push_back( polygon );
+    }
 
-      // todo: improve to take convex hull of inserted vertices
+    void insertBoundarySegment ( const std::vector< unsigned int > &vertices )
+    {
+      boundarySegments_.emplace( boundaryKey( vertices ), nullptr );
+    }
 
-      polygons_.push_back( polygon );
+    void insertBoundarySegment ( const std::vector< unsigned int > &vertices, std::shared_ptr< BoundarySegment< dimension, 2 > > segment )
+    {
+      boundarySegments_[ boundaryKey( vertices ) ] = std::move( segment );
+    }
+
+    /**
+     * \brief assign a boundary id to a boundary edge
+     *
+     * Boundary edges without an explicitly assigned id get the id 1.
+     *
+     * \note This is not an interface method.
+     */
+    void insertBoundaryId ( const std::vector< unsigned int > &vertices, int id )
+    {
+      boundaryIds_[ boundaryKey( vertices ) ] = id;
     }
 
-    void insertBoundarySegment ( const std::vector< unsigned int > & )
+    /**
+     * \brief insert a periodic face transformation
+     *
+     * Boundary edges that are mapped onto other boundary edges by the
+     * transformation x -> matrix x + shift are identified when the grid is
+     * created, i.e., the grid becomes periodic. Only translations are
+     * supported, so the matrix must be the identity.
+     */
+    void insertFaceTransformation ( const WorldMatrix &matrix, const GlobalCoordinate &shift )
     {
-      DUNE_THROW( NotImplemented, "Method insertBoundarySegment() not implemented yet" );
+      for( int i = 0; i < 2; ++i )
+        for( int j = 0; j < 2; ++j )
+          if( std::abs( matrix[ i ][ j ] - ct( i == j ? 1 : 0 ) ) > std::numeric_limits< ct >::epsilon() )
+            DUNE_THROW( NotImplemented, "PolygonGrid only supports periodic translations" );
+      translations_.push_back( shift );
     }
 
-    void insertBoundarySegment ( const std::vector< unsigned int > &, std::shared_ptr< BoundarySegment< dimension, 2 > > )
+    /**
+     * \brief renumber the cells to reduce the bandwidth of cell based matrices
+     *
+     * If enabled, createGrid computes a reverse Cuthill-McKee ordering of
+     * the cells (coupled across edges) and builds the grid from the
+     * reordered polygons. The permutation and the bandwidth before and
+     * after renumbering are available afterwards.
+     *
+     * \note This is not an interface method.
+     */
+    void setCellRenumbering ( bool renumber ) { renumber_ = renumber; }
+
+    /**
+     * \brief permutation of the cells applied by the last call to createGrid
+     *
+     * Element i (in insertion order) has index cellPermutation()[ i ] in
+     * the created grid. Elements removed by the input repair (see
+     * setInputRepair) are mapped to __PolygonGrid::RepairReport::invalid.
+     * The vector is empty, if no renumbering took place.
+     *
+     * \note This is not an interface method.
+     */
+    const std::vector< std::size_t > &cellPermutation () const noexcept { return permutation_; }
+
+    /**
+     * \brief bandwidth of the cell coupling before and after renumbering
+     *
+     * \note This is not an interface method.
+     */
+    std::pair< std::size_t, std::size_t > cellBandwidth () const noexcept { return bandwidth_; }
+
+    /**
+     * \brief repair degenerate and non-manifold input before creating the grid
+     *
+     * If enabled, createGrid welds vertices closer than the tolerance, removes
+     * edges of zero length and polygons of zero area, and splits
+     * non-manifold vertices (see __PolygonGrid::repairPolygons). Boundary ids
+     * and segments refer to the inserted vertices and are mapped to the
+     * repaired edges. Element i of the created grid is the i-th polygon that
+     * was not removed (before cell renumbering, see cellPermutation). The
+     * applied changes are available afterwards.
+     *
+     * \note This is not an interface method.
+     */
+    void setInputRepair ( bool repair, double tolerance = 0.0 )
     {
-      DUNE_THROW( NotImplemented, "Method insertBoundarySegment() not implemented yet" );
+      repair_ = repair;
+      repairTolerance_ = tolerance;
     }
 
+    /**
+     * \brief changes applied to the input by the last call to createGrid
+     *
+     * \note This is not an interface method.
+     */
+    const __PolygonGrid::RepairReport &repairReport () const noexcept { return repairReport_; }
+
+    /**
+     * \brief classify the cells as convex or non-convex on creation
+     *
+     * If enabled, the created mesh stores the convexity of each cell, see
+     * Mesh::convex.
+     *
+     * \note This is not an interface method.
+     */
+    void setConvexityClassification ( bool classify ) { classifyConvexity_ = classify; }
+
+    /**
+     * \brief build only the data required by the primal grid on creation
+     *
+     * If enabled, the data only required by the dual grid (dual positions
+     * and edge indices) is built by the first call to
+     * PolygonGrid::dualGrid(), see Mesh::buildDual. The time and memory
+     * saved show up as the dual phases of the mesh profile.
+     *
+     * \note This is not an interface method.
+     */
+    void setLazyDual ( bool lazyDual ) { lazyDual_ = lazyDual; }
+
     virtual unsigned int
     insertionIndex ( const typename Grid::Traits::template Codim< 0 >::Entity &entity ) const
     {
@@ -113,14 +225,141 @@ namespace Dune
 
     std::unique_ptr< Grid >createGrid ()
     {
-      return std::unique_ptr< Grid > (new Grid( std::make_shared< typename Grid::Mesh >( vertices_, polygons_ ), __PolygonGrid::Primal ));
+      std::vector< GlobalCoordinate > vertices( vertices_ );
+      __PolygonGrid::MultiVector< std::size_t > polygons( polygons_ );
+      __PolygonGrid::orientPolygons( vertices, polygons );
+
+      repairReport_ = __PolygonGrid::RepairReport();
+      if( repair_ )
+        repairReport_ = __PolygonGrid::repairPolygons( vertices, polygons, repairTolerance_ );
+
+      // identify periodic boundaries on copies, as the boundary data refers to the polygons as inserted
+      std::vector< GlobalCoordinate > meshVertices( vertices );
+      __PolygonGrid::MultiVector< std::size_t > meshPolygons( polygons );
+      __PolygonGrid::MultiVector< GlobalCoordinate > shifts;
+      if( !translations_.empty() )
+        shifts = __PolygonGrid::identifyPeriodicBoundaries( meshVertices, meshPolygons, translations_ );
+
+      permutation_.clear();
+      bandwidth_ = std::make_pair( 0u, 0u );
+      if( renumber_ )
+      {
+        // the cells are coupled across shared (including periodic) edges of the polygons
+        const __PolygonGrid::MultiVector< std::size_t > pattern = __PolygonGrid::cellPattern( meshPolygons, meshVertices.size() );
+        permutation_ = __PolygonGrid::reverseCuthillMcKee( pattern );
+        bandwidth_ = std::make_pair( __PolygonGrid::bandwidth( pattern ), __PolygonGrid::bandwidth( pattern, permutation_ ) );
+        polygons = __PolygonGrid::permuteRows( polygons, permutation_ );
+        meshPolygons = __PolygonGrid::permuteRows( meshPolygons, permutation_ );
+        if( !translations_.empty() )
+          shifts = __PolygonGrid::permuteRows( shifts, permutation_ );
+
+        // refer to the elements in insertion order, including those removed by the repair
+        if( !repairReport_.removedPolygons.empty() )
+        {
+          std::vector< std::size_t > permutation( polygons_.size(), __PolygonGrid::RepairReport::invalid );
+          auto removed = repairReport_.removedPolygons.begin();
+          for( std::size_t i = 0u, k = 0u; i < permutation.size(); ++i )
+          {
+            if( (removed != repairReport_.removedPolygons.end()) && (*removed == i) )
+              ++removed;
+            else
+              permutation[ i ] = permutation_[ k++ ];
+          }
+          permutation_ = std::move( permutation );
+        }
+      }
+
+      std::shared_ptr< typename Grid::Mesh > mesh;
+      if( translations_.empty() )
+        mesh = std::make_shared< typename Grid::Mesh >( meshVertices, meshPolygons, lazyDual_ );
+      else
+        mesh = std::make_shared< typename Grid::Mesh >( meshVertices, meshPolygons, shifts, lazyDual_ );
+
+      // attach boundary ids and segments to the boundary edges (in terms of the inserted vertices)
+      const bool haveSegments = std::any_of( boundarySegments_.begin(), boundarySegments_.end(), [] ( const auto &segment ) { return static_cast< bool >( segment.second ); } );
+      if( haveSegments || !boundaryIds_.empty() )
+      {
+        std::vector< Key > boundaries = __PolygonGrid::boundaryVertices( *mesh, polygons );
+
+        // compare the edges in terms of the (first welded) inserted vertices
+        std::map< Key, std::shared_ptr< BoundarySegment< dimension, 2 > > > boundarySegments;
+        std::map< Key, int > boundaryIds;
+        if( repair_ )
+        {
+          const __PolygonGrid::RepairReport &report = repairReport_;
+          auto inserted = [ &report ] ( Key key ) {
+              return std::minmax( report.vertexOrigin[ key.first ], report.vertexOrigin[ key.second ] );
+            };
+          auto repaired = [ &report, &inserted ] ( Key key ) {
+              key = Key( report.vertexMap[ key.first ], report.vertexMap[ key.second ] );
+              const bool valid = (key.first != __PolygonGrid::RepairReport::invalid) && (key.second != __PolygonGrid::RepairReport::invalid);
+              return (valid ? inserted( key ) : Key( __PolygonGrid::RepairReport::invalid, __PolygonGrid::RepairReport::invalid ));
+            };
+          for( Key &key : boundaries )
+            key = inserted( key );
+          for( const auto &segment : boundarySegments_ )
+            boundarySegments[ repaired( segment.first ) ] = segment.second;
+          for( const auto &id : boundaryIds_ )
+            boundaryIds[ repaired( id.first ) ] = id.second;
+        }
+        else
+        {
+          boundarySegments = boundarySegments_;
+          boundaryIds = boundaryIds_;
+        }
+
+        std::vector< int > ids( boundaryIds.empty() ? 0u : boundaries.size(), 1 );
+        for( std::size_t i = 0u; i < ids.size(); ++i )
+        {
+          const auto pos = boundaryIds.find( boundaries[ i ] );
+          if( pos != boundaryIds.end() )
+            ids[ i ] = pos->second;
+        }
+        mesh->setBoundaryIds( std::move( ids ) );
+
+        std::vector< std::shared_ptr< BoundarySegment< dimension, 2 > > > segments( haveSegments ? boundaries.size() : 0u );
+        for( std::size_t i = 0u; i < segments.size(); ++i )
+        {
+          const auto pos = boundarySegments.find( boundaries[ i ] );
+          if( pos != boundarySegments.end() )
+            segments[ i ] = pos->second;
+        }
+        mesh->setBoundarySegments( std::move( segments ) );
+      }
+
+      if( classifyConvexity_ )
+        mesh->classifyConvexity();
+
+      return std::unique_ptr< Grid > (new Grid( std::move( mesh ), __PolygonGrid::Primal ));
     }
 
     Communication comm () const { return Communication(); }
 
   private:
+    typedef std::pair< std::size_t, std::size_t > Key;
+
+    Key boundaryKey ( const std::vector< unsigned int > &vertices ) const
+    {
+      if( vertices.size() != 2u )
+        DUNE_THROW( GridError, "Boundary segments must consist of 2 vertices, not " << vertices.size() << "." );
+      if( std::max( vertices[ 0 ], vertices[ 1 ] ) >= vertices_.size() )
+        DUNE_THROW( GridError, "No such vertex: " << std::max( vertices[ 0 ], vertices[ 1 ] ) << "." );
+      return (vertices[ 0 ] < vertices[ 1 ] ? Key( vertices[ 0 ], vertices[ 1 ] ) : Key( vertices[ 1 ], vertices[ 0 ] ));
+    }
+
     std::vector< GlobalCoordinate > vertices_;
     __PolygonGrid::MultiVector< std::size_t > polygons_;
+    std::vector< GlobalCoordinate > translations_;
+    std::map< Key, std::shared_ptr< BoundarySegment< dimension, 2 > > > boundarySegments_;
+    std::map< Key, int > boundaryIds_;
+    bool renumber_ = false;
+    std::vector< std::size_t > permutation_;
+    std::pair< std::size_t, std::size_t > bandwidth_ = std::make_pair( 0u, 0u );
+    bool repair_ = false;
+    double repairTolerance_ = 0.0;
+    __PolygonGrid::RepairReport repairReport_;
+    bool classifyConvexity_ = false;
+    bool lazyDual_ = false;
   };
 
 } // namespace Dune
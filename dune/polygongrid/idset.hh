@@ -1,6 +1,10 @@
 #ifndef DUNE_POLYGONGRID_IDSET_HH
 #define DUNE_POLYGONGRID_IDSET_HH
 
+#include <cassert>
+#include <cstddef>
+
+#include <limits>
 #include <type_traits>
 
 #include <dune/geometry/dimension.hh>
@@ -48,7 +52,7 @@ namespace Dune
       template< int codim >
       Id id ( const typename Codim< codim >::Entity &entity ) const
       {
-        return id( entity.impl().index(), codim );
+        return id( persistentId( entity.impl().item() ), codim );
       }
 
       template< class Entity >
@@ -60,11 +64,29 @@ namespace Dune
       template< int cd >
       Id subId ( const typename Codim< cd >::Entity &entity, int i, int codim ) const
       {
-        return id( entity.impl().subIndex( codim, i ), codim );
+        const auto &item = entity.impl().item();
+        if( codim == cd )
+          return id( persistentId( item ), codim );
+        else if( codim == 1 )
+          return id( item.mesh().edgeId( entity.impl().subIndex( codim, i ) ), codim );
+        else
+          return id( item.mesh().nodeId( NodeIndex( entity.impl().subIndex( codim, i ), vertexType( item ) ) ), codim );
       }
 
     private:
-      static constexpr Id id ( std::size_t index, std::size_t codim ) noexcept { return (index << 2) | codim; }
+      static std::size_t persistentId ( const Node< ct > &node ) noexcept { return node.mesh().nodeId( node.index() ); }
+      static std::size_t persistentId ( const HalfEdge< ct > &halfEdge ) noexcept { return halfEdge.mesh().edgeId( halfEdge.uniqueIndex() ); }
+
+      // the corners of a cell are nodes of the dual type, those of an edge are its targets
+      static MeshType vertexType ( const Node< ct > &cell ) noexcept { return dual( cell.index().type() ); }
+      static MeshType vertexType ( const HalfEdge< ct > &halfEdge ) noexcept { return halfEdge.target().index().type(); }
+
+      // the persistent ids are unique within the hierarchy of meshes (see Mesh::nodeId), so the codimension suffices to distinguish the entities
+      static Id id ( std::size_t persistent, std::size_t codim ) noexcept
+      {
+        assert( (persistent >> (std::numeric_limits< Id >::digits - 2)) == 0u );
+        return (Id( persistent ) << 2) | Id( codim );
+      }
     };
 
   } // namespace __PolygonGrid
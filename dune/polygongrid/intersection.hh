@@ -65,7 +65,7 @@ namespace Dune
 
       bool neighbor () const noexcept { return item().neighbor().regular(); }
 
-      int boundaryId () const noexcept { return 1; }
+      int boundaryId () const noexcept { assert( boundary() ); return item().neighbor().boundaryId(); }
 
       std::size_t boundarySegmentIndex () const noexcept { assert( boundary() ); return item().neighbor().boundaryIndex(); }
 
@@ -94,8 +94,8 @@ namespace Dune
       {
         const auto& geom = this->geometry();
         const auto& elemGeo = this->outside().geometry();
-        const auto& c0 = elemGeo.local( geom.corner( 0 ) );
-        const auto& c1 = elemGeo.local( geom.corner( 1 ) );
+        const auto& c0 = elemGeo.local( geom.corner( 0 ) - shift() );
+        const auto& c1 = elemGeo.local( geom.corner( 1 ) - shift() );
         return LocalGeometry( LocalGeometryImpl(c0 , c1) );
         assert( false );
         DUNE_THROW( InvalidStateException, "Intersection::geometryInOutside does not make for arbitrary polytopes." );
@@ -112,12 +112,28 @@ namespace Dune
         return normal *= ctype( 1 ) / normal.two_norm();
       }
 
+      /**
+       * \brief translation from the frame of the outside element into the frame of the inside element
+       *
+       * The shift is nonzero only for intersections on a periodic boundary.
+       * In this case, a point x of the outside element is located at
+       * x + shift() when seen from the inside element.
+       */
+      GlobalCoordinate shift () const { return item().shift(); }
+
+      /** \brief boundary segment inserted for this boundary intersection (nullptr, if none) */
+      const typename Item::Mesh::BoundarySegment *boundarySegment () const noexcept
+      {
+        assert( boundary() );
+        return item().mesh().boundarySegment( item().neighbor().index() );
+      }
+
       const Item &item () const { return item_; }
 
     private:
       GlobalCoordinate outerNormal () const
       {
-        const GlobalCoordinate tangent = (item().target().position() - item().flip().target().position());
+        const GlobalCoordinate tangent = (item().targetPosition() - item().sourcePosition());
         return GlobalCoordinate{ tangent[ 1 ], -tangent[ 0 ] };
       }
 
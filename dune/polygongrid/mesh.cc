@@ -164,38 +164,46 @@ namespace Dune
 
       // sort regular primal nodes
       for( std::size_t i = 0; i < numVertices; ++i )
-      {
-        auto node1 = nodes[ Primal ][ i ];
-        const std::size_t n1 = node1.size();
-        std::size_t k1 = (node1[ 0 ].first >= numPolygons ? 2u : 0u);
-        while( true )
-        {
-          assert( k1 < n1 );
-          // look at preceeding half edge
-          auto node2 = nodes[ Dual ][ node1[ k1 ].first ];
-          const std::size_t n2 = node2.size();
-          const std::size_t k2 = node1[ k1 ].second;
-          ++k1;
-
-          // the preceeding vertex points to us
-          assert( node2[ (k2+n2-1)%n2 ].first == i );
-          node2[ (k2+n2-1)%n2 ].second = k1 % n1;
-
-          // now find the next half edge
-          std::size_t nbvtx = node2[ (k2+n2-2)%n2 ].first;
-          auto pos = std::find_if( node1.begin()+k1, node1.end(), [ &nodes, nbvtx ] ( IndexPair p ) { return (nodes[ Dual ][ p ].first == nbvtx); } );
-          assert( (k1 == n1) || (pos != node1.end()) );
-          if( pos == node1.end() )
-            break;
-          std::swap( node1[ k1 ], *pos );
-        }
-      }
+        sortVertexNode( nodes, i, numPolygons );
 
       return nodes;
     }
 
 
 
+    // sortVertexNode
+    // --------------
+
+    void sortVertexNode ( MeshStructure &nodes, std::size_t vertex, std::size_t numPolygons )
+    {
+      auto node1 = nodes[ Primal ][ vertex ];
+      const std::size_t n1 = node1.size();
+      std::size_t k1 = (node1[ 0 ].first >= numPolygons ? 2u : 0u);
+      while( true )
+      {
+        assert( k1 < n1 );
+        // look at preceeding half edge
+        auto node2 = nodes[ Dual ][ node1[ k1 ].first ];
+        const std::size_t n2 = node2.size();
+        const std::size_t k2 = node1[ k1 ].second;
+        ++k1;
+
+        // the preceeding vertex points to us
+        assert( node2[ (k2+n2-1)%n2 ].first == vertex );
+        node2[ (k2+n2-1)%n2 ].second = k1 % n1;
+
+        // now find the next half edge
+        std::size_t nbvtx = node2[ (k2+n2-2)%n2 ].first;
+        auto pos = std::find_if( node1.begin()+k1, node1.end(), [ &nodes, nbvtx ] ( IndexPair p ) { return (nodes[ Dual ][ p ].first == nbvtx); } );
+        assert( (k1 == n1) || (pos != node1.end()) );
+        if( pos == node1.end() )
+          break;
+        std::swap( node1[ k1 ], *pos );
+      }
+    }
+
+
+
     // checkStructure
     // --------------
 
@@ -266,6 +274,25 @@ namespace Dune
       return edgeIndices;
     }
 
+
+
+    // dualEdgeIndices
+    // ---------------
+
+    std::vector< std::size_t > dualEdgeIndices ( const MeshStructure &nodes, MeshType type, const std::vector< std::size_t > &edgeIndices )
+    {
+      // half edge k of the given type is half edge position_of( cells[ k ] ) of the dual type
+      const MultiVector< IndexPair > &cells = nodes[ dual( type ) ];
+      const MultiVector< IndexPair > &dualCells = nodes[ type ];
+      assert( edgeIndices.size() == dualCells.values().size() );
+
+      std::vector< std::size_t > dualEdgeIndices( cells.values().size() );
+      parallelFor( 0u, cells.values().size(), [ &cells, &dualCells, &edgeIndices, &dualEdgeIndices ] ( std::size_t k ) {
+          dualEdgeIndices[ k ] = edgeIndices[ dualCells.position_of( cells.values()[ k ] ) ];
+        } );
+      return dualEdgeIndices;
+    }
+
   } // namespace __PolygonGrid
 
 } // namespace Dune
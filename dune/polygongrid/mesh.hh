@@ -1,12 +1,18 @@
 #ifndef DUNE_POLYGONGRID_MESH_HH
 #define DUNE_POLYGONGRID_MESH_HH
 
+#include <cassert>
 #include <cstddef>
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <iostream>
 #include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -15,7 +21,14 @@
 
 #include <dune/geometry/dimension.hh>
 
+#include <dune/grid/common/boundarysegment.hh>
+#include <dune/grid/common/exceptions.hh>
+
+#include <dune/polygongrid/meshprofile.hh>
 #include <dune/polygongrid/multivector.hh>
+#include <dune/polygongrid/orientation.hh>
+#include <dune/polygongrid/parallel.hh>
+#include <dune/polygongrid/polygonmoments.hh>
 
 namespace Dune
 {
@@ -135,63 +148,238 @@ namespace Dune
 
     MeshStructure meshStructure ( std::size_t numVertices, const MultiVector< std::size_t > &polygons, const MultiVector< std::size_t > &boundaries );
 
+    void sortVertexNode ( MeshStructure &nodes, std::size_t vertex, std::size_t numPolygons );
+
     bool checkStructure ( const MeshStructure &nodes, MeshType type, std::ostream &out = std::cout );
     bool checkStructure ( const MeshStructure &nodes, std::ostream &out = std::cout );
 
     std::vector< std::size_t > edgeIndices ( const MeshStructure &nodes, MeshType type );
+    std::vector< std::size_t > dualEdgeIndices ( const MeshStructure &nodes, MeshType type, const std::vector< std::size_t > &edgeIndices );
+
+
+
+    // updateDualPositions
+    // -------------------
+
+    /**
+     * \brief recompute the positions of the dual nodes in place
+     *
+     * Given the primal positions, this function updates the cell centers
+     * and the positions of the boundary edge and boundary vertex cells. No
+     * memory is allocated.
+     */
+    template< class V >
+    inline void updateDualPositions ( const MeshStructure &nodes, std::size_t numVertices, const std::array< std::vector< V >, 2 > &shifts, const std::vector< V > &primal, std::vector< V > &dual )
+    {
+      typedef typename FieldTraits< V >::field_type ctype;
 
+      const std::size_t numBoundaries = (nodes[ Primal ].size() - numVertices) / 2u;
+      const std::size_t numPolygons = (nodes[ Dual ].size() - 2u*numBoundaries);
 
+      assert( dual.size() == nodes[ Dual ].size() );
 
-    // vertexPositions
+      // position of the target of a primal half edge as seen from its cell
+      auto corner = [ &nodes, &shifts, &primal ] ( std::size_t k ) {
+        V x = primal[ nodes[ Dual ].values()[ k ].first ];
+        return (shifts[ Primal ].empty() ? x : x += shifts[ Primal ][ k ]);
+      };
+
+      // for now, use the average of polygon vertices as center position
+      parallelFor( 0u, numPolygons, [ &nodes, &dual, &corner ] ( std::size_t i ) {
+          V center( 0 );
+          for( std::size_t k = nodes[ Dual ].begin_of( i ); k != nodes[ Dual ].end_of( i ); ++k )
+            center += corner( k );
+          dual[ i ] = center *= ctype( 1 ) / ctype( nodes[ Dual ].size( i ) );
+        } );
+
+      parallelFor( 0u, numBoundaries, [ &nodes, &dual, &corner, numBoundaries, numPolygons ] ( std::size_t i ) {
+          const std::size_t k = nodes[ Dual ].begin_of( numPolygons + i );
+
+          // positions for boundary edge cells
+          V &edge = dual[ numPolygons + i ];
+          edge = V( 0 );
+          for( std::size_t j = 0u; j < 2u; ++j )
+            edge.axpy( ctype( 1 ) / ctype( 2 ), corner( k+j ) );
+
+          // positions for boundary vertex cells
+          dual[ numPolygons + numBoundaries + i ] = corner( k );
+        } );
+    }
+
+
+
+    // updatePositions
     // ---------------
 
+    /**
+     * \brief recompute positions derived from the primal vertex positions
+     *
+     * Given the positions of the regular primal nodes (i.e., the vertices),
+     * this function updates the positions of all other nodes in place:
+     * the dual boundary nodes and, unless positions[ Dual ] is empty (see
+     * Mesh::dualBuilt), the cell centers and the boundary edge and boundary
+     * vertex cells. No memory is allocated.
+     *
+     * For periodic meshes, shifts[ Primal ] contains the translation of the
+     * target of each primal half edge (see halfEdgeShifts); otherwise it is
+     * empty.
+     */
     template< class V >
-    inline std::array< std::vector< V >, 2 > positions ( const MeshStructure &nodes, const std::vector< V > &vertices )
+    inline void updatePositions ( const MeshStructure &nodes, std::size_t numVertices, const std::array< std::vector< V >, 2 > &shifts, std::array< std::vector< V >, 2 > &positions )
     {
       typedef typename FieldTraits< V >::field_type ctype;
 
-      const std::size_t numVertices = vertices.size();
       const std::size_t numBoundaries = (nodes[ Primal ].size() - numVertices) / 2u;
       const std::size_t numPolygons = (nodes[ Dual ].size() - 2u*numBoundaries);
 
+      assert( positions[ Primal ].size() == nodes[ Primal ].size() );
+
+      std::vector< V > &primal = positions[ Primal ];
+      auto corner = [ &nodes, &shifts, &primal ] ( std::size_t k ) {
+        V x = primal[ nodes[ Dual ].values()[ k ].first ];
+        return (shifts[ Primal ].empty() ? x : x += shifts[ Primal ][ k ]);
+      };
+
+      // positions for dual boundaries
+      parallelFor( 0u, numBoundaries, [ &nodes, &primal, &corner, numVertices, numPolygons ] ( std::size_t i ) {
+          const std::size_t k = nodes[ Dual ].begin_of( numPolygons + i );
+          V edge( 0 );
+          for( std::size_t j = 0u; j < 2u; ++j )
+            edge.axpy( ctype( 1 ) / ctype( 2 ), corner( k+j ) );
+          for( std::size_t j = 0u; j < 2u; ++j )
+          {
+            V &node = primal[ numVertices + 2*i+j ];
+            node = V( 0 );
+            node.axpy( ctype( 1 ) / ctype( 2 ), corner( k+j ) );
+            node.axpy( ctype( 1 ) / ctype( 2 ), edge );
+          }
+        } );
+
+      if( !positions[ Dual ].empty() )
+        updateDualPositions( nodes, numVertices, shifts, primal, positions[ Dual ] );
+    }
+
+
+
+    // halfEdgeShifts
+    // --------------
+
+    /**
+     * \brief translations of the half edge targets for periodic meshes
+     *
+     * In a periodic mesh, a vertex on the periodic boundary is shared by
+     * polygons on both sides of the domain. Each cell (primal or dual) is
+     * therefore given its own frame and each half edge stores the
+     * translation to apply to the position of its target to obtain its
+     * position as seen from the cell whose boundary contains it.
+     *
+     * The translations of the dual half edges and of the half edges of the
+     * boundary cells are derived from the translations of the polygon
+     * corners.
+     *
+     * \param[in]  nodes          mesh structure
+     * \param[in]  numVertices    number of regular primal nodes
+     * \param[in]  cornerShifts   translation of each polygon corner
+     *
+     * \returns translations for primal half edges (index Primal) and dual half edges (index Dual)
+     */
+    template< class V >
+    inline std::array< std::vector< V >, 2 > halfEdgeShifts ( const MeshStructure &nodes, std::size_t numVertices, const MultiVector< V > &cornerShifts )
+    {
+      const std::size_t numBoundaries = (nodes[ Primal ].size() - numVertices) / 2u;
+      const std::size_t numPolygons = (nodes[ Dual ].size() - 2u*numBoundaries);
+
+      std::array< std::vector< V >, 2 > shifts;
+      std::vector< V > &primal = shifts[ Primal ];
+      std::vector< V > &dual = shifts[ Dual ];
+      primal.resize( nodes[ Dual ].values().size(), V( 0 ) );
+      dual.resize( nodes[ Primal ].values().size(), V( 0 ) );
+
+      // the polygons are stored in the same order as the corners
+      assert( cornerShifts.size() == numPolygons );
+      std::copy( cornerShifts.values().begin(), cornerShifts.values().end(), primal.begin() );
+
+      // boundary cells live in the frame of the adjacent polygon
+      parallelFor( 0u, numBoundaries, [ &nodes, &primal, numBoundaries, numPolygons ] ( std::size_t i ) {
+          const std::size_t k = nodes[ Dual ].begin_of( numPolygons + i );
+          const IndexPair p = nodes[ Primal ][ nodes[ Dual ].values()[ k+1 ] ];
+          const std::size_t n = nodes[ Dual ].size( p.first );
+          primal[ k ] = primal[ nodes[ Dual ].position_of( p.first, p.second ) ];
+          primal[ k+1 ] = primal[ nodes[ Dual ].position_of( p.first, (p.second+n-1) % n ) ];
+          primal[ nodes[ Dual ].begin_of( numPolygons + numBoundaries + i ) ] = primal[ k ];
+        } );
+
+      // dual cells of regular vertices: a cell seen from the vertex is translated by the inverse shift of the vertex within the cell
+      parallelFor( 0u, numVertices, [ &nodes, &primal, &dual ] ( std::size_t v ) {
+          for( std::size_t k = nodes[ Primal ].begin_of( v ); k != nodes[ Primal ].end_of( v ); ++k )
+          {
+            const IndexPair p = nodes[ Primal ].values()[ k ];
+            const std::size_t n = nodes[ Dual ].size( p.first );
+            dual[ k ] = V( 0 ) - primal[ nodes[ Dual ].position_of( p.first, (p.second+n-1) % n ) ];
+          }
+        } );
+
+      // dual boundary nodes connect the frames of two consecutive boundary edges
+      parallelFor( 0u, numBoundaries, [ &nodes, &primal, &dual, numVertices, numBoundaries, numPolygons ] ( std::size_t i ) {
+          const std::size_t k = nodes[ Primal ].begin_of( numVertices + 2*i+1 );
+          const std::size_t j = nodes[ Primal ].values()[ k ].first - numBoundaries;
+          dual[ k ] = primal[ nodes[ Dual ].begin_of( numPolygons + i ) + 1 ] - primal[ nodes[ Dual ].begin_of( j ) ];
+        } );
+
+      return shifts;
+    }
+
+
+
+    // primalPositions
+    // ---------------
+
+    /** \brief positions of all primal nodes, i.e., the vertices followed by the dual boundary nodes */
+    template< class V >
+    inline std::vector< V > primalPositions ( const MeshStructure &nodes, const std::vector< V > &vertices, const std::array< std::vector< V >, 2 > &shifts = {} )
+    {
       std::array< std::vector< V >, 2 > positions;
       positions[ Primal ].resize( nodes[ Primal ].size(), V( 0 ) );
-      positions[ Dual ].resize( nodes[ Dual ].size(), V( 0 ) );
 
       // copy given vertex positions
       std::copy( vertices.begin(), vertices.end(), positions[ Primal ].begin() );
 
-      // for now, use the average of polygon vertices as center position
-      for( std::size_t i = 0u; i < numPolygons; ++i )
-      {
-        for( IndexPair j : nodes[ Dual ][ i ] )
-          positions[ Dual ][ i ] += positions[ Primal ][ j.first ];
-        positions[ Dual ][ i ] *= ctype( 1 ) / ctype( nodes[ Dual ][ i ].size() );
-      }
+      updatePositions( nodes, vertices.size(), shifts, positions );
+      return std::move( positions[ Primal ] );
+    }
 
-      // positions for boundary edge cells
-      for( std::size_t i = numPolygons; i < numPolygons + numBoundaries; ++i )
-      {
-        for( std::size_t j = 0u; j < 2u; ++j )
-          positions[ Dual ][ i ].axpy( ctype( 1 ) / ctype( 2 ), positions[ Primal ][ nodes[ Dual ][ i ][ j ].first ] );
-      }
 
-      // positions for boundary vertex cells
-      for( std::size_t i = numPolygons + numBoundaries; i < numPolygons + 2u*numBoundaries; ++i )
-        positions[ Dual ][ i ] = positions[ Primal ][ nodes[ Dual ][ i ][ 0 ].first ];
 
-      // positions for dual boundaries
-      for( std::size_t i = 0u; i < numBoundaries; ++i )
+    // dualPositions
+    // -------------
+
+    /** \brief positions of all dual nodes, given the positions of the primal nodes */
+    template< class V >
+    inline std::vector< V > dualPositions ( const MeshStructure &nodes, std::size_t numVertices, const std::array< std::vector< V >, 2 > &shifts, const std::vector< V > &primal )
+    {
+      std::vector< V > dual( nodes[ Dual ].size(), V( 0 ) );
+      updateDualPositions( nodes, numVertices, shifts, primal, dual );
+      return dual;
+    }
+
+
+
+    // uniformSize
+    // -----------
+
+    /** \brief common size of the first numRows rows of a multi vector (0, if the sizes differ or there are no rows) */
+    template< class T >
+    inline std::size_t uniformSize ( const MultiVector< T > &v, std::size_t numRows ) noexcept
+    {
+      if( numRows == 0u )
+        return 0u;
+      const std::size_t size = v.size( 0 );
+      for( std::size_t i = 1u; i < numRows; ++i )
       {
-        for( std::size_t j = 0u; j < 2u; ++j )
-        {
-          const std::size_t v = nodes[ Dual ][ numPolygons + i ][ j ].first;
-          positions[ Primal ][ numVertices + 2*i+j ].axpy( ctype( 1 ) / ctype( 2 ), positions[ Primal ][ v ] );
-          positions[ Primal ][ numVertices + 2*i+j ].axpy( ctype( 1 ) / ctype( 2 ), positions[ Dual ][ numPolygons + i ] );
-        }
+        if( v.size( i ) != size )
+          return 0u;
       }
-
-      return positions;
+      return size;
     }
 
 
@@ -211,21 +399,155 @@ namespace Dune
     public:
       typedef FieldVector< ct, 2 > GlobalCoordinate;
 
-      Mesh ( const std::vector< GlobalCoordinate > &vertices, const MultiVector< std::size_t > &polygons )
+      typedef Dune::BoundarySegment< 2, 2 > BoundarySegment;
+
+      /**
+       * \brief construct mesh
+       *
+       * If lazyDual is true, only the data required by the primal grid is
+       * built; the dual positions and edge indices are built by the first
+       * call to buildDual(). The mesh structure itself is
+       * always complete, as the primal cells are stored as dual nodes.
+       */
+      Mesh ( const std::vector< GlobalCoordinate > &vertices, const MultiVector< std::size_t > &polygons, bool lazyDual = false )
+        : numRegularNodes_{{ vertices.size(), polygons.size() }}
+      {
+        const MultiVector< std::size_t > boundaries = profile_.measure( "boundaries", [ this, &polygons ] () { return __PolygonGrid::boundaries( numRegularNodes_[ Primal ], polygons ); } );
+        nodes_ = profile_.measure( "meshStructure", [ this, &polygons, &boundaries ] () { return __PolygonGrid::meshStructure( numRegularNodes_[ Primal ], polygons, boundaries ); } );
+        positions_[ Primal ] = profile_.measure( "positions", [ this, &vertices ] () { return __PolygonGrid::primalPositions( nodes_, vertices ); } );
+        edgeIndices_[ Primal ] = profile_.measure( "edgeIndices", [ this ] () { return __PolygonGrid::edgeIndices( nodes_, Primal ); } );
+        polygonSize_ = __PolygonGrid::uniformSize( nodes_[ Dual ], numRegularNodes_[ Dual ] );
+        idBase_ = drawIds( numNodes( Primal ) + numNodes( Dual ) + numEdges( Dual ) );
+        if( !lazyDual )
+          buildDual();
+      }
+
+      /**
+       * \brief construct mesh with prescribed boundary edges
+       *
+       * Each boundary edge (b0, b1) is stored reversed, i.e., it is
+       * traversed from b1 to b0 by its adjacent polygon. The order of the
+       * boundary edges determines the boundary indices.
+       */
+      Mesh ( const std::vector< GlobalCoordinate > &vertices, const MultiVector< std::size_t > &polygons, const MultiVector< std::size_t > &boundaries, bool lazyDual = false )
         : numRegularNodes_{{ vertices.size(), polygons.size() }}
       {
-        MultiVector< std::size_t > boundaries = __PolygonGrid::boundaries( numRegularNodes_[ Primal ], polygons );
-        nodes_ = __PolygonGrid::meshStructure( numRegularNodes_[ Primal ], polygons, boundaries );
-        positions_ = __PolygonGrid::positions( nodes_, vertices );
-        edgeIndices_ = __PolygonGrid::edgeIndices( nodes_, Primal );
+        nodes_ = profile_.measure( "meshStructure", [ this, &polygons, &boundaries ] () { return __PolygonGrid::meshStructure( numRegularNodes_[ Primal ], polygons, boundaries ); } );
+        positions_[ Primal ] = profile_.measure( "positions", [ this, &vertices ] () { return __PolygonGrid::primalPositions( nodes_, vertices ); } );
+        edgeIndices_[ Primal ] = profile_.measure( "edgeIndices", [ this ] () { return __PolygonGrid::edgeIndices( nodes_, Primal ); } );
+        polygonSize_ = __PolygonGrid::uniformSize( nodes_[ Dual ], numRegularNodes_[ Dual ] );
+        idBase_ = drawIds( numNodes( Primal ) + numNodes( Dual ) + numEdges( Dual ) );
+        if( !lazyDual )
+          buildDual();
+      }
+
+      /**
+       * \brief construct periodic mesh
+       *
+       * The periodic boundaries must already be identified, i.e., polygons
+       * on both sides of a periodic boundary share their vertices (see
+       * identifyPeriodicBoundaries). The position of corner j of polygon i
+       * is given by vertices[ polygons[ i ][ j ] ] + shifts[ i ][ j ].
+       */
+      Mesh ( const std::vector< GlobalCoordinate > &vertices, const MultiVector< std::size_t > &polygons, const MultiVector< GlobalCoordinate > &shifts, bool lazyDual = false )
+        : numRegularNodes_{{ vertices.size(), polygons.size() }}
+      {
+        const MultiVector< std::size_t > boundaries = profile_.measure( "boundaries", [ this, &polygons ] () { return __PolygonGrid::boundaries( numRegularNodes_[ Primal ], polygons ); } );
+        nodes_ = profile_.measure( "meshStructure", [ this, &polygons, &boundaries ] () { return __PolygonGrid::meshStructure( numRegularNodes_[ Primal ], polygons, boundaries ); } );
+        shifts_ = profile_.measure( "halfEdgeShifts", [ this, &shifts ] () { return __PolygonGrid::halfEdgeShifts( nodes_, numRegularNodes_[ Primal ], shifts ); } );
+        positions_[ Primal ] = profile_.measure( "positions", [ this, &vertices ] () { return __PolygonGrid::primalPositions( nodes_, vertices, shifts_ ); } );
+        edgeIndices_[ Primal ] = profile_.measure( "edgeIndices", [ this ] () { return __PolygonGrid::edgeIndices( nodes_, Primal ); } );
+        polygonSize_ = __PolygonGrid::uniformSize( nodes_[ Dual ], numRegularNodes_[ Dual ] );
+        idBase_ = drawIds( numNodes( Primal ) + numNodes( Dual ) + numEdges( Dual ) );
+        if( !lazyDual )
+          buildDual();
+      }
+
+      /**
+       * \brief construct mesh from a prebuilt structure
+       *
+       * The structure must be laid out as by meshStructure, i.e., the
+       * polygons come first, followed by the boundary edge and boundary
+       * vertex nodes. This allows a mesh derived from another one (see
+       * refine) to patch the structure of the other mesh instead of
+       * rebuilding it.
+       */
+      Mesh ( const std::vector< GlobalCoordinate > &vertices, MeshStructure nodes, bool lazyDual = false )
+        : numRegularNodes_{{ vertices.size(), nodes[ Dual ].size() - (nodes[ Primal ].size() - vertices.size()) }},
+          nodes_( std::move( nodes ) )
+      {
+        assert( checkStructure( nodes_ ) );
+        positions_[ Primal ] = profile_.measure( "positions", [ this, &vertices ] () { return __PolygonGrid::primalPositions( nodes_, vertices ); } );
+        edgeIndices_[ Primal ] = profile_.measure( "edgeIndices", [ this ] () { return __PolygonGrid::edgeIndices( nodes_, Primal ); } );
+        polygonSize_ = __PolygonGrid::uniformSize( nodes_[ Dual ], numRegularNodes_[ Dual ] );
+        idBase_ = drawIds( numNodes( Primal ) + numNodes( Dual ) + numEdges( Dual ) );
+        if( !lazyDual )
+          buildDual();
       }
 
+      /**
+       * \brief move the vertices of the mesh
+       *
+       * The topology of the mesh remains untouched; all positions depending
+       * on the vertex positions are updated in place. Only this mesh is
+       * moved, i.e., the coarser and finer meshes of its hierarchy (see
+       * father and children) keep their positions.
+       *
+       * \param[in]  vertices  new positions of the (regular) primal vertices
+       */
+      void setPositions ( const std::vector< GlobalCoordinate > &vertices )
+      {
+        assert( vertices.size() == numRegularNodes( Primal ) );
+        std::vector< GlobalCoordinate > &positions = positions_[ Primal ];
+        parallelFor( 0u, vertices.size(), [ &vertices, &positions ] ( std::size_t i ) { positions[ i ] = vertices[ i ]; } );
+        updatePositions();
+      }
+
+      /**
+       * \brief move the vertices of the mesh
+       *
+       * The new position of vertex i is given by f( i, x ), where x denotes
+       * its current position. As the vertices are processed concurrently, f
+       * must be safe to call from multiple threads.
+       */
+      template< class F >
+      void movePositions ( F &&f )
+      {
+        std::vector< GlobalCoordinate > &positions = positions_[ Primal ];
+        parallelFor( 0u, numRegularNodes( Primal ), [ &f, &positions ] ( std::size_t i ) { positions[ i ] = f( i, static_cast< const GlobalCoordinate & >( positions[ i ] ) ); } );
+        updatePositions();
+      }
+
+      /**
+       * \brief build the data only required by the dual grid
+       *
+       * For meshes constructed with lazyDual, this builds the dual
+       * positions and edge indices on the first call; later calls return
+       * immediately. Concurrent calls are safe, but the vertices must not be
+       * moved meanwhile. The profile records the phases dualPositions and
+       * dualEdgeIndices, i.e., the time and memory a primal-only mesh saves.
+       */
+      void buildDual ()
+      {
+        std::call_once( dual_.once, [ this ] () {
+            positions_[ Dual ] = profile_.measure( "dualPositions", [ this ] () { return __PolygonGrid::dualPositions( nodes_, numRegularNodes_[ Primal ], shifts_, positions_[ Primal ] ); } );
+            edgeIndices_[ Dual ] = profile_.measure( "dualEdgeIndices", [ this ] () { return __PolygonGrid::dualEdgeIndices( nodes_, Dual, edgeIndices_[ Primal ] ); } );
+            dual_.built.store( true, std::memory_order_release );
+            if( classifyConvexity_ )
+              updateConvexity();
+          } );
+      }
+
+      /** \brief return true, if the data required by the dual grid is available (see buildDual) */
+      bool dualBuilt () const noexcept { return dual_.built.load( std::memory_order_acquire ); }
+
       NodeIndex target ( HalfEdgeIndex index ) const noexcept { return NodeIndex( indexPair( index ).first, index.type() ); }
 
+      /** \brief index of the edge of a half edge (precomputed for both mesh types, see buildDual) */
       std::size_t edgeIndex ( HalfEdgeIndex index ) const noexcept
       {
-        // We only store edge indices for the primal mesh.
-        return edgeIndices_[ index.type() == Primal ? index : dual( index ) ];
+        assert( index < edgeIndices_[ index.type() ].size() );
+        return edgeIndices_[ index.type() ][ index ];
       }
 
       const GlobalCoordinate &position ( NodeIndex index ) const noexcept
@@ -234,6 +556,99 @@ namespace Dune
         return positions_[ index.type() ][ index ];
       }
 
+      /**
+       * \brief position of the target of a half edge as seen from its cell
+       *
+       * For non-periodic meshes, this coincides with position( target( index ) ).
+       */
+      GlobalCoordinate position ( HalfEdgeIndex index ) const noexcept
+      {
+        GlobalCoordinate x = position( target( index ) );
+        return (periodic() ? x += shift( index ) : x);
+      }
+
+      /** \brief translation of the target of a half edge into the frame of its cell */
+      GlobalCoordinate shift ( HalfEdgeIndex index ) const noexcept
+      {
+        return (periodic() ? shifts_[ index.type() ][ index ] : GlobalCoordinate( 0 ));
+      }
+
+      /**
+       * \brief translation from the frame of the neighbor into the frame of the cell
+       *
+       * A point x in the frame of the neighboring cell across the half edge
+       * corresponds to x + neighborShift( index ) in the frame of the cell.
+       * The shift is nonzero only across periodic boundaries.
+       */
+      GlobalCoordinate neighborShift ( HalfEdgeIndex index ) const noexcept
+      {
+        return (periodic() ? shifts_[ index.type() ][ index ] + shifts_[ dual( index.type() ) ][ dual( index ) ] : GlobalCoordinate( 0 ));
+      }
+
+      /** \brief return true, if the mesh has periodic boundaries */
+      bool periodic () const noexcept { return !shifts_[ Primal ].empty(); }
+
+      /**
+       * \brief index of the primal boundary edge a boundary node belongs to
+       *
+       * For the primal mesh, the boundary node is the boundary edge node
+       * itself. For the dual mesh, each primal boundary edge is split into
+       * two boundary nodes.
+       */
+      std::size_t boundaryEdge ( NodeIndex index ) const noexcept
+      {
+        assert( !regular( index ) );
+        const std::size_t k = static_cast< std::size_t >( index ) - numRegularNodes( index.type() );
+        return (index.type() == Primal ? k / 2u : k);
+      }
+
+      /** \brief boundary id of a boundary node (defaults to 1) */
+      int boundaryId ( NodeIndex index ) const noexcept
+      {
+        return (boundaryIds_.empty() ? 1 : boundaryIds_[ boundaryEdge( index ) ]);
+      }
+
+      /** \brief boundary segment of a boundary node (nullptr, if none was inserted) */
+      const BoundarySegment *boundarySegment ( NodeIndex index ) const noexcept
+      {
+        return (boundarySegments_.empty() ? nullptr : boundarySegments_[ boundaryEdge( index ) ].get());
+      }
+
+      /** \brief boundary ids for each primal boundary edge (empty, if all ids are 1) */
+      const std::vector< int > &boundaryIds () const noexcept { return boundaryIds_; }
+
+      /** \brief boundary segments for each primal boundary edge (empty, if none were inserted) */
+      const std::vector< std::shared_ptr< BoundarySegment > > &boundarySegments () const noexcept { return boundarySegments_; }
+
+      void setBoundaryIds ( std::vector< int > ids )
+      {
+        assert( ids.empty() || (ids.size() == numBoundaries( Primal )) );
+        boundaryIds_ = std::move( ids );
+      }
+
+      void setBoundarySegments ( std::vector< std::shared_ptr< BoundarySegment > > segments )
+      {
+        assert( segments.empty() || (segments.size() == numBoundaries( Primal )) );
+        boundarySegments_ = std::move( segments );
+      }
+
+      /**
+       * \brief copy boundary ids and segments from another mesh
+       *
+       * Primal boundary edge i of this mesh obtains the boundary data of
+       * boundary edge origin[ i ] of the other mesh.
+       */
+      void copyBoundaryData ( const This &other, const std::vector< std::size_t > &origin )
+      {
+        assert( origin.size() == numBoundaries( Primal ) );
+        boundaryIds_.resize( other.boundaryIds_.empty() ? 0u : origin.size() );
+        for( std::size_t i = 0u; i < boundaryIds_.size(); ++i )
+          boundaryIds_[ i ] = other.boundaryIds_[ origin[ i ] ];
+        boundarySegments_.resize( other.boundarySegments_.empty() ? 0u : origin.size() );
+        for( std::size_t i = 0u; i < boundarySegments_.size(); ++i )
+          boundarySegments_[ i ] = other.boundarySegments_[ origin[ i ] ];
+      }
+
       HalfEdgeIndex dual ( HalfEdgeIndex index ) const noexcept
       {
         return HalfEdgeIndex( nodes( index.type() ).position_of( indexPair( index ) ), dual( index.type() ) );
@@ -287,7 +702,247 @@ namespace Dune
 
       const MultiVector< IndexPair > &nodes ( MeshType type ) const { return nodes_[ type ]; }
 
+      /** \brief positions of all nodes of a type, i.e., position( NodeIndex( i, type ) ) for all i (empty for Dual, unless dualBuilt()) */
+      const std::vector< GlobalCoordinate > &positions ( MeshType type ) const noexcept { return positions_[ type ]; }
+
+      /** \brief edge index of each half edge of a type, ordered like nodes( dual( type ) ).values() (empty for Dual, unless dualBuilt()) */
+      const std::vector< std::size_t > &edgeIndices ( MeshType type ) const noexcept { return edgeIndices_[ type ]; }
+
+      /** \brief level of this mesh within its hierarchy (0 for the coarsest mesh, see setFather) */
+      int level () const noexcept { return level_; }
+
+      /**
+       * \brief persistent id of a node
+       *
+       * A constructed mesh draws new ids for all of its entities. Meshes
+       * derived from it (see refine and agglomerate) share its id counter and
+       * keep the ids of the entities they inherit unchanged (see inheritIds),
+       * so ids are unique and persistent within a hierarchy. Detached copies
+       * keep the ids, as they represent the same entities (see detachedCopy).
+       */
+      std::size_t nodeId ( NodeIndex index ) const noexcept
+      {
+        if( nodeIds_[ index.type() ].empty() )
+          return idBase_ + (index.type() == Dual ? numNodes( Primal ) : 0u) + static_cast< std::size_t >( index );
+        return nodeIds_[ index.type() ][ index ];
+      }
+
+      /** \brief persistent id of an edge, given by its edge index (shared by both mesh types, see nodeId) */
+      std::size_t edgeId ( std::size_t edge ) const noexcept
+      {
+        assert( edge < numEdges( Dual ) );
+        return (edgeIds_.empty() ? idBase_ + numNodes( Primal ) + numNodes( Dual ) + edge : edgeIds_[ edge ]);
+      }
+
+      /**
+       * \brief inherit the persistent ids from another mesh of the same hierarchy
+       *
+       * Node i of type T obtains the id of node nodeOrigins[ T ][ i ] of the
+       * other mesh. The edge of half edge k (ordered like
+       * nodes( Dual ).values()) obtains the id of the edge of half edge
+       * halfEdgeOrigins[ k ] of the other mesh. Entities without origin
+       * (std::numeric_limits< std::size_t >::max()) obtain new ids from the
+       * counter shared with the other mesh.
+       *
+       * \throws GridError if the ids of the hierarchy are exhausted
+       */
+      void inheritIds ( const This &other, const std::array< std::vector< std::size_t >, 2 > &nodeOrigins, const std::vector< std::size_t > &halfEdgeOrigins )
+      {
+        const std::size_t none = std::numeric_limits< std::size_t >::max();
+        assert( (nodeOrigins[ Primal ].size() == numNodes( Primal )) && (nodeOrigins[ Dual ].size() == numNodes( Dual )) );
+        assert( halfEdgeOrigins.size() == nodes_[ Dual ].values().size() );
+
+        for( MeshType type : { Primal, Dual } )
+        {
+          nodeIds_[ type ].resize( numNodes( type ) );
+          for( std::size_t i = 0u; i < nodeIds_[ type ].size(); ++i )
+            nodeIds_[ type ][ i ] = (nodeOrigins[ type ][ i ] != none ? other.nodeId( NodeIndex( nodeOrigins[ type ][ i ], type ) ) : none);
+        }
+        edgeIds_.assign( numEdges( Dual ), none );
+        for( std::size_t k = 0u; k < halfEdgeOrigins.size(); ++k )
+        {
+          if( halfEdgeOrigins[ k ] != none )
+            edgeIds_[ edgeIndices_[ Primal ][ k ] ] = other.edgeId( other.edgeIndices_[ Primal ][ halfEdgeOrigins[ k ] ] );
+        }
+
+        // draw new ids for all entities without origin
+        idCounter_ = other.idCounter_;
+        std::size_t count = std::count( edgeIds_.begin(), edgeIds_.end(), none );
+        for( MeshType type : { Primal, Dual } )
+          count += std::count( nodeIds_[ type ].begin(), nodeIds_[ type ].end(), none );
+        std::size_t id = drawIds( count );
+        for( std::vector< std::size_t > *ids : { &nodeIds_[ Primal ], &nodeIds_[ Dual ], &edgeIds_ } )
+        {
+          for( std::size_t &i : *ids )
+            i = (i != none ? i : id++);
+        }
+      }
+
+      /** \brief return true, if no finer mesh has been derived from this one */
+      bool leaf () const noexcept { return children_.empty(); }
+
+      /**
+       * \brief number of corners shared by all polygons (0, if the polygons differ in size)
+       *
+       * For uniform meshes, the primal cells can be accessed with a
+       * compile-time stride, see FixedValenceMesh.
+       */
+      std::size_t polygonSize () const noexcept { return polygonSize_; }
+
+      /**
+       * \brief classify the cells of both grids as convex or non-convex
+       *
+       * Kernels may query convex( cell ) to select faster code paths for
+       * convex cells. Once classified, the classification is kept up to date
+       * when the vertices are moved. The cells of the dual grid are
+       * classified once the dual data is built (see buildDual).
+       */
+      void classifyConvexity ()
+      {
+        classifyConvexity_ = true;
+        updateConvexity();
+      }
+
+      /** \brief return true, if classifyConvexity() has been called */
+      bool convexityClassified () const noexcept { return classifyConvexity_; }
+
+      /** \brief return true, if a cell (i.e., a regular node of the dual type) is convex (requires classifyConvexity()) */
+      bool convex ( NodeIndex cell ) const noexcept
+      {
+        assert( classifyConvexity_ && (cell < convex_[ cell.type() ].size()) );
+        return convex_[ cell.type() ][ cell ];
+      }
+
+      /** \brief timings and memory of the construction phases (empty, unless profiling was enabled, see meshProfiling) */
+      const MeshProfile &profile () const noexcept { return profile_; }
+
+      /** \brief bytes allocated by each array of the mesh */
+      std::vector< std::pair< std::string, std::size_t > > memoryUsage () const
+      {
+        using __PolygonGrid::memoryUsage;
+        return { { "nodes[primal]", memoryUsage( nodes_[ Primal ] ) }, { "nodes[dual]", memoryUsage( nodes_[ Dual ] ) },
+                 { "positions[primal]", memoryUsage( positions_[ Primal ] ) }, { "positions[dual]", memoryUsage( positions_[ Dual ] ) },
+                 { "shifts[primal]", memoryUsage( shifts_[ Primal ] ) }, { "shifts[dual]", memoryUsage( shifts_[ Dual ] ) },
+                 { "edgeIndices[primal]", memoryUsage( edgeIndices_[ Primal ] ) }, { "edgeIndices[dual]", memoryUsage( edgeIndices_[ Dual ] ) },
+                 { "convex[primal]", memoryUsage( convex_[ Primal ] ) }, { "convex[dual]", memoryUsage( convex_[ Dual ] ) },
+                 { "boundaryIds", memoryUsage( boundaryIds_ ) },
+                 { "nodeIds[primal]", memoryUsage( nodeIds_[ Primal ] ) }, { "nodeIds[dual]", memoryUsage( nodeIds_[ Dual ] ) }, { "edgeIds", memoryUsage( edgeIds_ ) },
+                 { "boundarySegments", memoryUsage( boundarySegments_ ) }, { "fathers", memoryUsage( fathers_ ) }, { "children", memoryUsage( children_ ) } };
+      }
+
+      /** \brief coarser mesh, this mesh has been derived from (if any) */
+      const std::shared_ptr< This > &father () const noexcept { return father_; }
+
+      /** \brief index of the father of a primal cell within the coarser mesh */
+      std::size_t father ( std::size_t cell ) const noexcept { assert( father_ ); return fathers_[ cell ]; }
+
+      /** \brief index of the father for each primal cell (empty, if there is no coarser mesh) */
+      const std::vector< std::size_t > &fathers () const noexcept { return fathers_; }
+
+      /** \brief primal cells of the finer mesh derived from each primal cell of this mesh */
+      const MultiVector< std::size_t > &children () const noexcept { return children_; }
+
+      /**
+       * \brief attach this mesh to a coarser one
+       *
+       * \param[in]  father   coarser mesh
+       * \param[in]  fathers  index of the father for each primal cell of this mesh
+       *
+       * The corresponding child map is stored within the father. The level
+       * of this mesh is set to the level of the father plus one; the levels
+       * of meshes already derived from this one are not updated, so
+       * hierarchies are to be built from the coarsest mesh on.
+       */
+      void setFather ( std::shared_ptr< This > father, std::vector< std::size_t > fathers )
+      {
+        assert( father && (fathers.size() == numCells( Primal )) );
+        father_ = std::move( father );
+        fathers_ = std::move( fathers );
+        level_ = father_->level_ + 1;
+
+        std::vector< std::size_t > count( father_->numCells( Primal ), 0u );
+        for( std::size_t i : fathers_ )
+          ++count[ i ];
+        father_->children_.resize( count );
+        std::fill( count.begin(), count.end(), 0u );
+        for( std::size_t i = 0u; i < fathers_.size(); ++i )
+          father_->children_[ fathers_[ i ] ][ count[ fathers_[ i ] ]++ ] = i;
+      }
+
+      /**
+       * \brief copy of this mesh without father and children
+       *
+       * The copy can be attached to a different hierarchy without affecting
+       * this mesh. It keeps the ids, as it represents the same entities
+       * (see nodeId).
+       */
+      std::shared_ptr< This > detachedCopy () const
+      {
+        std::shared_ptr< This > copy = std::make_shared< This >( *this );
+        copy->father_.reset();
+        copy->fathers_.clear();
+        copy->children_ = MultiVector< std::size_t >();
+        copy->level_ = 0;
+        return copy;
+      }
+
     private:
+      // state of the dual data built on demand (copies of a mesh with dual data need not build it again)
+      struct DualState
+      {
+        DualState () = default;
+
+        DualState ( const DualState &other )
+          : built( other.built.load( std::memory_order_acquire ) )
+        {
+          if( built.load( std::memory_order_relaxed ) )
+            std::call_once( once, [] () {} );
+        }
+
+        DualState &operator= ( const DualState & ) = delete;
+
+        std::once_flag once;
+        std::atomic< bool > built{ false };
+      };
+
+      // draw consecutive ids from the counter of the hierarchy, leaving the lowest two bits of the id to the codimension (see IdSet)
+      std::size_t drawIds ( std::size_t count )
+      {
+        const std::size_t maxIds = (std::numeric_limits< std::size_t >::max() >> 2);
+        std::size_t first = idCounter_->load();
+        do
+        {
+          if( count > maxIds - first )
+            DUNE_THROW( GridError, "Persistent ids of the mesh hierarchy exhausted." );
+        }
+        while( !idCounter_->compare_exchange_weak( first, first + count ) );
+        return first;
+      }
+
+      void updatePositions ()
+      {
+        __PolygonGrid::updatePositions( nodes_, numRegularNodes_[ Primal ], shifts_, positions_ );
+        if( classifyConvexity_ )
+          updateConvexity();
+      }
+
+      void updateConvexity ()
+      {
+        for( MeshType type : { Primal, Dual } )
+        {
+          // the corners of the dual cells (i.e., the primal nodes) are dual positions
+          if( (type == Primal) && !dualBuilt() )
+            continue;
+
+          convex_[ type ].resize( numRegularNodes( type ) );
+          parallelFor( 0u, convex_[ type ].size(), [ this, type ] ( std::size_t i ) {
+              const NodeIndex cell( i, type );
+              const HalfEdgeIndex begin = this->begin( cell );
+              convex_[ type ][ i ] = __PolygonGrid::convex( size( cell ), [ this, begin ] ( std::size_t j ) { return position( begin + static_cast< std::ptrdiff_t >( j ) ); } );
+            } );
+        }
+      }
+
       const IndexPair &indexPair ( HalfEdgeIndex index ) const noexcept
       {
         assert( index < nodes_[ dual( index.type() ) ].values().size() );
@@ -297,9 +952,170 @@ namespace Dune
       std::array< std::size_t, 2 > numRegularNodes_;
       MeshStructure nodes_;
       std::array< std::vector< GlobalCoordinate >, 2 > positions_;
-      std::vector< std::size_t > edgeIndices_;
+      std::array< std::vector< GlobalCoordinate >, 2 > shifts_;
+      std::vector< int > boundaryIds_;
+      std::vector< std::shared_ptr< BoundarySegment > > boundarySegments_;
+      std::array< std::vector< std::size_t >, 2 > edgeIndices_;
+      std::shared_ptr< This > father_;
+      std::vector< std::size_t > fathers_;
+      MultiVector< std::size_t > children_;
+      MeshProfile profile_;
+      std::size_t polygonSize_ = 0u;
+      bool classifyConvexity_ = false;
+      std::array< std::vector< char >, 2 > convex_;
+      DualState dual_;
+      int level_ = 0;
+      std::shared_ptr< std::atomic< std::size_t > > idCounter_ = std::make_shared< std::atomic< std::size_t > >( 0u );
+      std::size_t idBase_ = 0u;
+      std::array< std::vector< std::size_t >, 2 > nodeIds_;
+      std::vector< std::size_t > edgeIds_;
     };
 
+
+
+    // cellMoments
+    // -----------
+
+    /** \brief volume and centroid of a cell, given by the index of its node in the dual structure */
+    template< class ct >
+    inline PolygonMoments< ct > cellMoments ( const Mesh< ct > &mesh, NodeIndex cell ) noexcept
+    {
+      const HalfEdgeIndex begin = mesh.begin( cell );
+      return polygonMoments( mesh.size( cell ), [ &mesh, begin ] ( std::size_t j ) { return mesh.position( begin + static_cast< std::ptrdiff_t >( j ) ); } );
+    }
+
+
+
+    // cellVolume
+    // ----------
+
+    template< class ct >
+    inline ct cellVolume ( const Mesh< ct > &mesh, NodeIndex cell ) noexcept
+    {
+      return cellMoments( mesh, cell ).volume();
+    }
+
+
+
+    // cellCentroid
+    // ------------
+
+    template< class ct >
+    inline typename Mesh< ct >::GlobalCoordinate cellCentroid ( const Mesh< ct > &mesh, NodeIndex cell ) noexcept
+    {
+      return cellMoments( mesh, cell ).center();
+    }
+
+
+
+    // boundaryVertices
+    // ----------------
+
+    /**
+     * \brief vertices of the polygon edge adjacent to each primal boundary edge
+     *
+     * The polygons must be those the mesh was constructed from (in the same
+     * order), but their vertex numbering may differ, e.g., the numbering
+     * before identification of periodic boundaries.
+     *
+     * \returns sorted pair of vertices for each primal boundary edge
+     */
+    template< class ct >
+    inline std::vector< std::pair< std::size_t, std::size_t > > boundaryVertices ( const Mesh< ct > &mesh, const MultiVector< std::size_t > &polygons )
+    {
+      const std::size_t numPolygons = mesh.numCells( Primal );
+      assert( polygons.size() == numPolygons );
+
+      std::vector< std::pair< std::size_t, std::size_t > > vertices( mesh.numBoundaries( Primal ) );
+      parallelFor( 0u, numPolygons, [ &mesh, &polygons, &vertices, numPolygons ] ( std::size_t i ) {
+          const NodeIndex cell( i, Dual );
+          const std::size_t size = polygons.size( i );
+          std::size_t k = 0u;
+          for( HalfEdgeIndex h = mesh.begin( cell ); h != mesh.end( cell ); ++h, ++k )
+          {
+            // half edge k connects corner k-1 with corner k
+            const NodeIndex neighbor = mesh.target( mesh.dual( h ) );
+            if( mesh.regular( neighbor ) )
+              continue;
+            const std::size_t v0 = polygons[ i ][ (k > 0u ? k : size) - 1u ];
+            const std::size_t v1 = polygons[ i ][ k ];
+            vertices[ static_cast< std::size_t >( neighbor ) - numPolygons ] = std::minmax( v0, v1 );
+          }
+        } );
+      return vertices;
+    }
+
+
+
+
+    // MeshStatistics
+    // --------------
+
+    struct MeshStatistics
+    {
+      std::size_t numVertices = 0u, numPolygons = 0u, numEdges = 0u, numBoundaries = 0u;
+
+      /** \brief number of vertices for each number of incident edges */
+      std::map< std::size_t, std::size_t > valences;
+
+      /** \brief number of polygons for each number of corners */
+      std::map< std::size_t, std::size_t > polygonSizes;
+
+      /** \brief bytes allocated by each array of the mesh */
+      std::vector< std::pair< std::string, std::size_t > > memory;
+    };
+
+    inline std::ostream &operator<< ( std::ostream &out, const MeshStatistics &statistics )
+    {
+      out << "vertices: " << statistics.numVertices << ", polygons: " << statistics.numPolygons << ", edges: " << statistics.numEdges << ", boundaries: " << statistics.numBoundaries << std::endl;
+      out << "valences:";
+      for( const auto &valence : statistics.valences )
+        out << " " << valence.first << " (" << valence.second << ")";
+      out << std::endl << "polygon sizes:";
+      for( const auto &size : statistics.polygonSizes )
+        out << " " << size.first << " (" << size.second << ")";
+      out << std::endl;
+      for( const auto &memory : statistics.memory )
+        out << memory.first << ": " << memory.second << " bytes" << std::endl;
+      return out;
+    }
+
+
+
+    // meshStatistics
+    // --------------
+
+    template< class ct >
+    inline MeshStatistics meshStatistics ( const Mesh< ct > &mesh )
+    {
+      MeshStatistics statistics;
+      statistics.numVertices = mesh.numVertices( Primal );
+      statistics.numPolygons = mesh.numCells( Primal );
+      statistics.numEdges = mesh.numEdges( Primal );
+      statistics.numBoundaries = mesh.numBoundaries( Primal );
+      statistics.memory = mesh.memoryUsage();
+
+      // each edge is counted by the polygon containing the half edge with the smaller index
+      const MultiVector< IndexPair > &polygons = mesh.nodes( Dual );
+      std::vector< std::size_t > valences( statistics.numVertices, 0u );
+      for( std::size_t i = 0u; i < statistics.numPolygons; ++i )
+      {
+        ++statistics.polygonSizes[ polygons.size( i ) ];
+        const std::size_t begin = polygons.begin_of( i ), end = polygons.end_of( i );
+        for( std::size_t k = begin; k < end; ++k )
+        {
+          const HalfEdgeIndex h( k, Primal );
+          if( static_cast< std::size_t >( mesh.flip( h ) ) < k )
+            continue;
+          ++valences[ polygons.values()[ k ].first ];
+          ++valences[ polygons.values()[ (k > begin ? k : end) - 1u ].first ];
+        }
+      }
+      for( std::size_t valence : valences )
+        ++statistics.valences[ valence ];
+      return statistics;
+    }
+
   } // namespace __PolygonGrid
 
 } // namespace Dune
@@ -0,0 +1,450 @@
+#ifndef DUNE_POLYGONGRID_MESHIO_HH
+#define DUNE_POLYGONGRID_MESHIO_HH
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+#include <dune/common/fvector.hh>
+
+#include <dune/grid/io/file/dgfparser/dgfexception.hh>
+
+#include <dune/polygongrid/dgfreader.hh>
+#include <dune/polygongrid/multivector.hh>
+#include <dune/polygongrid/parallel.hh>
+
+namespace Dune
+{
+
+  namespace __PolygonGrid
+  {
+
+    namespace __MeshIO
+    {
+
+      static const char binaryMagic[ 8 ] = { 'P', 'G', 'M', 'E', 'S', 'H', '0', '1' };
+
+
+
+      // readRange
+      // ---------
+
+      /** \brief read a byte range of a file, using concurrent reads of large chunks */
+      inline void readRange ( const std::string &filename, std::size_t offset, std::size_t size, char *data, std::size_t chunkSize = std::size_t( 1 ) << 24 )
+      {
+        const std::size_t numChunks = (size + chunkSize - 1u) / chunkSize;
+        parallelFor( 0u, numChunks, [ &filename, offset, size, data, chunkSize ] ( std::size_t k ) {
+            const std::size_t first = k*chunkSize;
+            const std::size_t count = std::min( chunkSize, size - first );
+            std::ifstream input( filename, std::ios::binary );
+            input.seekg( static_cast< std::streamoff >( offset + first ) );
+            if( !input.read( data + first, static_cast< std::streamsize >( count ) ) )
+              DUNE_THROW( IOError, "Unable to read " << count << " bytes at offset " << offset + first << " from '" << filename << "'." );
+          }, 1u );
+      }
+
+
+
+      // readFile
+      // --------
+
+      inline std::vector< char > readFile ( const std::string &filename )
+      {
+        std::ifstream input( filename, std::ios::binary | std::ios::ate );
+        if( !input )
+          DUNE_THROW( IOError, "Unable to open file '" << filename << "'." );
+        std::vector< char > buffer( static_cast< std::size_t >( input.tellg() ) );
+        readRange( filename, 0u, buffer.size(), buffer.data() );
+        return buffer;
+      }
+
+
+
+      // Line Helpers
+      // ------------
+
+      /** \brief end of the line starting at p (excluding the line feed) */
+      inline const char *lineEnd ( const char *p, const char *end ) noexcept
+      {
+        const void *q = std::memchr( p, '\n', static_cast< std::size_t >( end - p ) );
+        return (q ? static_cast< const char * >( q ) : end);
+      }
+
+      /** \brief first line start at or after p */
+      inline const char *lineStart ( const char *begin, const char *p, const char *end ) noexcept
+      {
+        if( (p == begin) || (p == end) || (*(p-1) == '\n') )
+          return p;
+        const char *q = lineEnd( p, end );
+        return (q != end ? q+1 : end);
+      }
+
+      /** \brief split [begin, end) into at most n ranges starting at line starts */
+      inline std::vector< const char * > splitLines ( const char *begin, const char *end, std::size_t n )
+      {
+        std::vector< const char * > ranges( n+1u );
+        const std::size_t size = static_cast< std::size_t >( end - begin );
+        for( std::size_t k = 0u; k <= n; ++k )
+          ranges[ k ] = lineStart( begin, begin + (k*size) / n, end );
+        ranges.erase( std::unique( ranges.begin(), ranges.end() ), ranges.end() );
+        return ranges;
+      }
+
+
+
+      // DGFBlock
+      // --------
+
+      struct DGFBlock
+      {
+        __DGFReader::BlockType type;
+        const char *begin, *end;
+        int numParameters;
+      };
+
+
+
+      // findDGFBlocks
+      // -------------
+
+      /**
+       * \brief locate the data of the mesh blocks within a DGF file
+       *
+       * Data lines never start with a letter or '#', so the lines delimiting
+       * the blocks can be collected concurrently. The block structure is then
+       * obtained by walking through these lines only.
+       */
+      inline std::vector< DGFBlock > findDGFBlocks ( const char *begin, const char *end, std::size_t &vertexOffset )
+      {
+        using namespace __DGFReader;
+
+        const std::vector< const char * > ranges = splitLines( begin, end, std::max< std::size_t >( numThreads(), 1u ) );
+        std::vector< std::vector< const char * > > markers( ranges.size()-1u );
+        parallelFor( 0u, markers.size(), [ &ranges, &markers, end ] ( std::size_t k ) {
+            for( const char *p = ranges[ k ]; p != ranges[ k+1 ]; )
+            {
+              const char *q = lineEnd( p, end );
+              const Line line( p, q );
+              if( line.isKeyword() || line.isTerminator() )
+                markers[ k ].push_back( p );
+              p = (q != end ? q+1 : end);
+            }
+          }, 1u );
+
+        std::vector< DGFBlock > blocks;
+        DGFBlock *block = nullptr;
+        for( const std::vector< const char * > &chunk : markers )
+        {
+          for( const char *p : chunk )
+          {
+            const char *q = lineEnd( p, end );
+            const Line line( p, q );
+            const char *next = (q != end ? q+1 : end);
+            if( block )
+            {
+              // block header lines must precede the data
+              if( line.isTerminator() )
+              {
+                block->end = p;
+                block = nullptr;
+              }
+              else if( line.keyword() == "PARAMETERS" )
+              {
+                block->numParameters = line.value< int >();
+                block->begin = next;
+              }
+              else if( (line.keyword() == "FIRSTINDEX") && (block->type == Vertex) )
+              {
+                vertexOffset = line.value< std::size_t >();
+                block->begin = next;
+              }
+              else if( block->type != Ignored )
+                DUNE_THROW( DGFException, "Unknown keyword in DGF block: " << line.keyword() << "." );
+            }
+            else if( line.isKeyword() )
+            {
+              bool supported = true;
+              const BlockType type = blockType( line.keyword(), supported );
+              if( !supported )
+                DUNE_THROW( DGFException, "DGF block " << line.keyword() << " cannot be read in parallel." );
+              if( type != None )
+              {
+                blocks.push_back( DGFBlock{ type, next, end, 0 } );
+                block = &blocks.back();
+              }
+            }
+          }
+        }
+
+        // only vertex and element data are read
+        blocks.erase( std::remove_if( blocks.begin(), blocks.end(), [] ( const DGFBlock &b ) { return (b.type == Ignored) || (b.type == BoundarySegments); } ), blocks.end() );
+        return blocks;
+      }
+
+
+
+      // DGFChunk
+      // --------
+
+      /** \brief thread local buffers for one byte range of a DGF block */
+      template< class ct >
+      struct DGFChunk
+      {
+        void parse ( const DGFBlock &block, const char *begin, const char *end )
+        {
+          using namespace __DGFReader;
+
+          for( const char *p = begin; p != end; )
+          {
+            const char *q = lineEnd( p, end );
+            const Line line( p, q );
+            p = (q != end ? q+1 : end);
+            if( line.empty() )
+              continue;
+
+            if( block.type == Vertex )
+            {
+              double x[ 2 ];
+              parseReal( parseReal( line.begin, line.end, x[ 0 ] ), line.end, x[ 1 ] );
+              vertices.emplace_back( FieldVector< ct, 2 >{ static_cast< ct >( x[ 0 ] ), static_cast< ct >( x[ 1 ] ) } );
+              continue;
+            }
+
+            const int numParameters = (block.type == Polygon ? 0 : block.numParameters);
+            const std::size_t numTokens = line.numTokens();
+            const std::size_t numCorners = numTokens - static_cast< std::size_t >( numParameters );
+            if( (numTokens < static_cast< std::size_t >( numParameters ) + 3u)
+                || ((block.type == Cube) && (numCorners != 4u)) || ((block.type == Simplex) && (numCorners != 3u)) )
+              DUNE_THROW( DGFException, "Invalid element in DGF file: " << std::string( line.begin, line.end ) );
+
+            const char *r = line.begin;
+            for( std::size_t i = 0u; i < numCorners; ++i )
+            {
+              std::size_t v;
+              r = parseInteger( r, line.end, v );
+              corners.push_back( v );
+            }
+            if( block.type == Cube )
+              std::swap( corners[ corners.size()-2u ], corners[ corners.size()-1u ] );
+            offsets.push_back( corners.size() );
+          }
+        }
+
+        std::vector< FieldVector< ct, 2 > > vertices;
+        std::vector< std::size_t > offsets = std::vector< std::size_t >( 1u, 0u );
+        std::vector< std::size_t > corners;
+      };
+
+    } // namespace __MeshIO
+
+
+
+    // readDGFParallel
+    // ---------------
+
+    /**
+     * \brief read vertices and polygons from a DGF file using all threads
+     *
+     * The file is loaded by concurrent reads and the data of the Vertex,
+     * Cube, Simplex and Polygon blocks is split into byte ranges at line
+     * boundaries. The ranges are parsed concurrently into thread local
+     * buffers, which are finally merged into the arrays consumed by Mesh.
+     *
+     * Parameters are skipped and all other blocks are ignored; blocks that
+     * require the generic DGF parser (e.g., Interval) are rejected. The
+     * orientation of the polygons is not changed.
+     */
+    template< class ct >
+    inline void readDGFParallel ( const std::string &filename, std::vector< FieldVector< ct, 2 > > &vertices, MultiVector< std::size_t > &polygons )
+    {
+      const std::vector< char > buffer = __MeshIO::readFile( filename );
+      const char *const begin = buffer.data(), *const end = buffer.data() + buffer.size();
+
+      std::size_t vertexOffset = 0u;
+      const std::vector< __MeshIO::DGFBlock > blocks = __MeshIO::findDGFBlocks( begin, end, vertexOffset );
+
+      // split blocks into byte ranges of similar size
+      std::size_t size = 0u;
+      for( const __MeshIO::DGFBlock &block : blocks )
+        size += static_cast< std::size_t >( block.end - block.begin );
+      const std::size_t rangeSize = std::max< std::size_t >( size / (4u*numThreads() + 1u), 1u << 16 );
+
+      std::vector< std::pair< std::size_t, std::pair< const char *, const char * > > > ranges;
+      for( std::size_t b = 0u; b < blocks.size(); ++b )
+      {
+        const std::size_t n = static_cast< std::size_t >( blocks[ b ].end - blocks[ b ].begin ) / rangeSize + 1u;
+        const std::vector< const char * > split = __MeshIO::splitLines( blocks[ b ].begin, blocks[ b ].end, n );
+        for( std::size_t k = 0u; k+1u < split.size(); ++k )
+          ranges.emplace_back( b, std::make_pair( split[ k ], split[ k+1 ] ) );
+      }
+
+      std::vector< __MeshIO::DGFChunk< ct > > chunks( ranges.size() );
+      parallelFor( 0u, ranges.size(), [ &blocks, &ranges, &chunks ] ( std::size_t k ) {
+          chunks[ k ].parse( blocks[ ranges[ k ].first ], ranges[ k ].second.first, ranges[ k ].second.second );
+        }, 1u );
+
+      // merge thread local buffers
+      std::vector< std::size_t > vertexBase( chunks.size()+1u, 0u ), polygonBase( chunks.size()+1u, 0u ), cornerBase( chunks.size()+1u, 0u );
+      for( std::size_t k = 0u; k < chunks.size(); ++k )
+      {
+        vertexBase[ k+1 ] = vertexBase[ k ] + chunks[ k ].vertices.size();
+        polygonBase[ k+1 ] = polygonBase[ k ] + chunks[ k ].offsets.size() - 1u;
+        cornerBase[ k+1 ] = cornerBase[ k ] + chunks[ k ].corners.size();
+      }
+
+      const std::size_t numVertices = vertexBase.back();
+      vertices.resize( numVertices );
+      std::vector< std::size_t > offsets( polygonBase.back() + 1u, 0u ), corners( cornerBase.back() );
+      parallelFor( 0u, chunks.size(), [ &chunks, &vertexBase, &polygonBase, &cornerBase, &vertices, &offsets, &corners, vertexOffset, numVertices ] ( std::size_t k ) {
+          __MeshIO::DGFChunk< ct > &chunk = chunks[ k ];
+          std::copy( chunk.vertices.begin(), chunk.vertices.end(), vertices.begin() + vertexBase[ k ] );
+          for( std::size_t i = 1u; i < chunk.offsets.size(); ++i )
+            offsets[ polygonBase[ k ] + i ] = cornerBase[ k ] + chunk.offsets[ i ];
+          for( std::size_t i = 0u; i < chunk.corners.size(); ++i )
+          {
+            const std::size_t v = chunk.corners[ i ] - vertexOffset;
+            if( v >= numVertices )
+              DUNE_THROW( DGFException, "No such vertex: " << chunk.corners[ i ] << "." );
+            corners[ cornerBase[ k ] + i ] = v;
+          }
+          chunk = __MeshIO::DGFChunk< ct >();
+        }, 1u );
+
+      polygons = MultiVector< std::size_t >( std::move( offsets ), std::move( corners ) );
+    }
+
+
+
+    // writeBinaryMesh
+    // ---------------
+
+    /**
+     * \brief write vertices and polygons in a simple binary format
+     *
+     * The file consists of an 8 byte magic number, the numbers of vertices,
+     * polygons and corners (as 64 bit unsigned integers), the vertex
+     * positions (as pairs of doubles), the polygon offsets and the polygon
+     * corners (as 64 bit unsigned integers). All data is stored in native
+     * byte order.
+     */
+    template< class ct >
+    inline void writeBinaryMesh ( const std::string &filename, const std::vector< FieldVector< ct, 2 > > &vertices, const MultiVector< std::size_t > &polygons )
+    {
+      std::ofstream output( filename, std::ios::binary );
+      if( !output )
+        DUNE_THROW( IOError, "Unable to open file '" << filename << "'." );
+
+      auto write = [ &output ] ( const auto &value ) { output.write( reinterpret_cast< const char * >( &value ), sizeof( value ) ); };
+      output.write( __MeshIO::binaryMagic, sizeof( __MeshIO::binaryMagic ) );
+      write( std::uint64_t( vertices.size() ) );
+      write( std::uint64_t( polygons.size() ) );
+      write( std::uint64_t( polygons.values().size() ) );
+      for( const FieldVector< ct, 2 > &x : vertices )
+      {
+        write( static_cast< double >( x[ 0 ] ) );
+        write( static_cast< double >( x[ 1 ] ) );
+      }
+      for( std::size_t offset : polygons.offsets() )
+        write( std::uint64_t( offset ) );
+      for( std::size_t v : polygons.values() )
+        write( std::uint64_t( v ) );
+
+      if( !output )
+        DUNE_THROW( IOError, "Unable to write file '" << filename << "'." );
+    }
+
+
+
+    // readBinaryMesh
+    // --------------
+
+    /**
+     * \brief read vertices and polygons written by writeBinaryMesh
+     *
+     * The arrays are read by concurrent reads of large chunks and the
+     * polygons are validated concurrently.
+     */
+    template< class ct >
+    inline void readBinaryMesh ( const std::string &filename, std::vector< FieldVector< ct, 2 > > &vertices, MultiVector< std::size_t > &polygons )
+    {
+      std::uint64_t header[ 3 ];
+      char magic[ sizeof( __MeshIO::binaryMagic ) ];
+      std::uint64_t fileSize;
+      {
+        std::ifstream input( filename, std::ios::binary );
+        if( !input.read( magic, sizeof( magic ) ) || !std::equal( magic, magic + sizeof( magic ), __MeshIO::binaryMagic ) )
+          DUNE_THROW( IOError, "File '" << filename << "' is not a binary polygon mesh." );
+        if( !input.read( reinterpret_cast< char * >( header ), sizeof( header ) ) )
+          DUNE_THROW( IOError, "Unable to read header of '" << filename << "'." );
+        if( !input.seekg( 0, std::ios::end ) )
+          DUNE_THROW( IOError, "Unable to determine size of '" << filename << "'." );
+        fileSize = static_cast< std::uint64_t >( input.tellg() );
+      }
+
+      // check the sizes in the header against the file size before allocating anything (dividing to avoid overflows)
+      std::uint64_t remaining = fileSize - (sizeof( magic ) + sizeof( header ));
+      auto consume = [ &remaining ] ( std::uint64_t count, std::uint64_t size ) {
+          if( count > remaining / size )
+            return false;
+          remaining -= count*size;
+          return true;
+        };
+      const bool valid = consume( header[ 0 ], 2u*sizeof( double ) ) && (header[ 1 ] < remaining / sizeof( std::uint64_t ))
+                         && consume( header[ 1 ]+1u, sizeof( std::uint64_t ) ) && consume( header[ 2 ], sizeof( std::uint64_t ) ) && (remaining == 0u);
+      if( !valid || (std::max( { header[ 0 ], header[ 1 ]+1u, header[ 2 ] } ) > std::numeric_limits< std::size_t >::max() / 2u) )
+        DUNE_THROW( IOError, "Header of '" << filename << "' does not match the size of the file." );
+
+      const std::size_t numVertices = header[ 0 ], numPolygons = header[ 1 ], numCorners = header[ 2 ];
+      std::size_t offset = sizeof( magic ) + sizeof( header );
+
+      std::vector< double > positions( 2u*numVertices );
+      __MeshIO::readRange( filename, offset, positions.size()*sizeof( double ), reinterpret_cast< char * >( positions.data() ) );
+      offset += positions.size()*sizeof( double );
+      vertices.resize( numVertices );
+      parallelFor( 0u, numVertices, [ &positions, &vertices ] ( std::size_t i ) {
+          vertices[ i ] = FieldVector< ct, 2 >{ static_cast< ct >( positions[ 2*i ] ), static_cast< ct >( positions[ 2*i+1 ] ) };
+        } );
+      positions = std::vector< double >();
+
+      auto readIndices = [ &filename, &offset ] ( std::size_t size ) {
+          std::vector< std::size_t > indices( size );
+          if( sizeof( std::size_t ) == sizeof( std::uint64_t ) )
+            __MeshIO::readRange( filename, offset, size*sizeof( std::uint64_t ), reinterpret_cast< char * >( indices.data() ) );
+          else
+          {
+            std::vector< std::uint64_t > buffer( size );
+            __MeshIO::readRange( filename, offset, size*sizeof( std::uint64_t ), reinterpret_cast< char * >( buffer.data() ) );
+            std::copy( buffer.begin(), buffer.end(), indices.begin() );
+          }
+          offset += size*sizeof( std::uint64_t );
+          return indices;
+        };
+      std::vector< std::size_t > offsets = readIndices( numPolygons+1u );
+      std::vector< std::size_t > corners = readIndices( numCorners );
+
+      if( (offsets.front() != 0u) || (offsets.back() != numCorners) )
+        DUNE_THROW( IOError, "Invalid polygon offsets in '" << filename << "'." );
+      parallelFor( 0u, numPolygons, [ &offsets, &corners, &filename, numVertices ] ( std::size_t i ) {
+          if( (offsets[ i+1 ] < offsets[ i ] + 3u) || (offsets[ i+1 ] > corners.size()) )
+            DUNE_THROW( IOError, "Invalid polygon " << i << " in '" << filename << "'." );
+          for( std::size_t k = offsets[ i ]; k < offsets[ i+1 ]; ++k )
+            if( corners[ k ] >= numVertices )
+              DUNE_THROW( IOError, "Invalid vertex " << corners[ k ] << " in '" << filename << "'." );
+        } );
+
+      polygons = MultiVector< std::size_t >( std::move( offsets ), std::move( corners ) );
+    }
+
+  } // namespace __PolygonGrid
+
+} // namespace Dune
+
+#endif // #ifndef DUNE_POLYGONGRID_MESHIO_HH
@@ -67,6 +67,8 @@ namespace Dune
         return uniqueIndex() - mesh().numRegularNodes( index().type() );
       }
 
+      int boundaryId () const noexcept { return mesh().boundaryId( index() ); }
+
       const Mesh &mesh () const noexcept { return *mesh_; }
       Index index () const noexcept { return index_; }
 
@@ -106,6 +108,8 @@ namespace Dune
       typedef __PolygonGrid::Node< ctype > Node;
       typedef __PolygonGrid::Node< ctype > Cell;
 
+      typedef typename Mesh::GlobalCoordinate GlobalCoordinate;
+
       typedef HalfEdgeIndex Index;
 
       HalfEdge () noexcept = default;
@@ -120,6 +124,15 @@ namespace Dune
       /** \brief obtain node, the half edge points to */
       Node target () const noexcept { return Node( mesh_, mesh().target( index() ) ); }
 
+      /** \brief position of the target as seen from the cell */
+      GlobalCoordinate targetPosition () const noexcept { return mesh().position( index() ); }
+
+      /** \brief position of the source (i.e., the target of the flipped half edge) as seen from the cell */
+      GlobalCoordinate sourcePosition () const noexcept { return mesh().position( mesh().flip( index() ) ) + mesh().neighborShift( index() ); }
+
+      /** \brief translation from the frame of the neighbor into the frame of the cell (nonzero only across periodic boundaries) */
+      GlobalCoordinate shift () const noexcept { return mesh().neighborShift( index() ); }
+
       /** \brief obtain neighboring cell (whose boundary contains the flipped half edge) */
       Cell neighbor () const noexcept { return Cell( mesh_, mesh().target( mesh().dual( index() ) ) ); }
 
@@ -0,0 +1,145 @@
+#ifndef DUNE_POLYGONGRID_MESHPROFILE_HH
+#define DUNE_POLYGONGRID_MESHPROFILE_HH
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <dune/polygongrid/multivector.hh>
+
+namespace Dune
+{
+
+  namespace __PolygonGrid
+  {
+
+    // meshProfiling
+    // -------------
+
+    inline std::atomic< bool > &meshProfilingFlag () noexcept
+    {
+      // the environment is only read on first use
+      static std::atomic< bool > flag( [] () {
+          const char *env = std::getenv( "DUNE_POLYGONGRID_PROFILE" );
+          return (env && (*env != '\0') && (std::strcmp( env, "0" ) != 0));
+        }() );
+      return flag;
+    }
+
+    /**
+     * \brief return true, if mesh construction shall be profiled
+     *
+     * Profiling is off by default, unless the environment variable
+     * DUNE_POLYGONGRID_PROFILE is set to a nonzero value when the setting is
+     * first used. Afterwards, it is only changed by setMeshProfiling.
+     */
+    inline bool meshProfiling () noexcept { return meshProfilingFlag().load( std::memory_order_relaxed ); }
+
+    /** \brief enable or disable profiling of mesh construction, returning the previous setting */
+    inline bool setMeshProfiling ( bool enable ) noexcept { return meshProfilingFlag().exchange( enable, std::memory_order_relaxed ); }
+
+
+
+    // memoryUsage
+    // -----------
+
+    /** \brief bytes allocated by a vector */
+    template< class T, class A >
+    inline std::size_t memoryUsage ( const std::vector< T, A > &v ) noexcept
+    {
+      return v.capacity() * sizeof( T );
+    }
+
+    /** \brief bytes allocated by a multi vector (offsets and values) */
+    template< class T >
+    inline std::size_t memoryUsage ( const MultiVector< T > &v ) noexcept
+    {
+      return memoryUsage( v.offsets() ) + memoryUsage( v.values() );
+    }
+
+    template< class T, std::size_t n >
+    inline std::size_t memoryUsage ( const std::array< T, n > &a ) noexcept
+    {
+      std::size_t bytes = 0u;
+      for( const T &v : a )
+        bytes += memoryUsage( v );
+      return bytes;
+    }
+
+
+
+    // MeshProfile
+    // -----------
+
+    /**
+     * \brief wall time and memory of the phases of a mesh construction
+     *
+     * The bytes of a phase are those allocated by the arrays it returns;
+     * temporary allocations are not accounted for. Whether phases are
+     * recorded is decided on creation of the profile, so that phases run
+     * later (e.g., by Mesh::buildDual) are recorded consistently.
+     */
+    struct MeshProfile
+    {
+      struct Phase
+      {
+        std::string name;
+        double seconds;
+        std::size_t bytes;
+      };
+
+      /** \brief call f() and record the phase, if profiling is enabled */
+      template< class F >
+      auto measure ( const char *name, F &&f ) -> decltype( f() )
+      {
+        if( !enabled )
+          return f();
+
+        const auto start = std::chrono::steady_clock::now();
+        auto result = f();
+        phases.push_back( Phase{ name, std::chrono::duration< double >( std::chrono::steady_clock::now() - start ).count(), memoryUsage( result ) } );
+        return result;
+      }
+
+      double seconds () const noexcept
+      {
+        double seconds = 0.0;
+        for( const Phase &phase : phases )
+          seconds += phase.seconds;
+        return seconds;
+      }
+
+      std::size_t bytes () const noexcept
+      {
+        std::size_t bytes = 0u;
+        for( const Phase &phase : phases )
+          bytes += phase.bytes;
+        return bytes;
+      }
+
+      bool empty () const noexcept { return phases.empty(); }
+
+      std::vector< Phase > phases;
+      bool enabled = meshProfiling();
+    };
+
+    inline std::ostream &operator<< ( std::ostream &out, const MeshProfile &profile )
+    {
+      for( const MeshProfile::Phase &phase : profile.phases )
+        out << phase.name << ": " << phase.seconds << " s, " << phase.bytes << " bytes" << std::endl;
+      return out << "total: " << profile.seconds() << " s, " << profile.bytes() << " bytes" << std::endl;
+    }
+
+  } // namespace __PolygonGrid
+
+} // namespace Dune
+
+#endif // #ifndef DUNE_POLYGONGRID_MESHPROFILE_HH
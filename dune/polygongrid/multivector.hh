@@ -1,9 +1,13 @@
 #ifndef DUNE_POLYGONGRID_MULTIVECTOR_HH
 #define DUNE_POLYGONGRID_MULTIVECTOR_HH
 
+#include <cassert>
+#include <cstddef>
+
 #include <algorithm>
 #include <initializer_list>
 #include <iterator>
+#include <utility>
 #include <vector>
 
 #include <dune/polygongrid/iteratortags.hh>
@@ -188,6 +192,15 @@ namespace Dune
       explicit MultiVector ( const std::vector< size_type > &counts ) { resize( counts ); }
       MultiVector ( const std::vector< size_type > &counts, const T &value ) { resize( counts, value ); }
 
+      /** \brief construct from compressed row storage (offsets must start with 0 and end with values.size()) */
+      MultiVector ( std::vector< size_type > offsets, std::vector< T > values )
+        : offsets_( std::move( offsets ) ), values_( std::move( values ) )
+      {
+        if( offsets_.empty() )
+          offsets_.push_back( 0u );
+        assert( (offsets_.front() == 0u) && (offsets_.back() == values_.size()) );
+      }
+
       MultiVector ( std::initializer_list< value_type > values ) { assign( values ); }
       MultiVector ( std::initializer_list< std::initializer_list< T > > values ) { assign( values ); }
 
@@ -287,6 +300,8 @@ namespace Dune
         values_.resize( offsets_.back() );
       }
 
+      const std::vector< size_type > &offsets () const noexcept { return offsets_; }
+
       const std::vector< T > &values () const noexcept { return values_; }
       std::vector< T > &values () noexcept { return values_; }
 
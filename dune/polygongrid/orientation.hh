@@ -0,0 +1,113 @@
+#ifndef DUNE_POLYGONGRID_ORIENTATION_HH
+#define DUNE_POLYGONGRID_ORIENTATION_HH
+
+#include <cstddef>
+
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <dune/common/fvector.hh>
+
+#include <dune/polygongrid/multivector.hh>
+#include <dune/polygongrid/parallel.hh>
+#include <dune/polygongrid/polygonmoments.hh>
+
+namespace Dune
+{
+
+  namespace __PolygonGrid
+  {
+
+    // signedArea
+    // ----------
+
+    /**
+     * \brief signed area of the polygon given by its n corners (positive, if oriented counter-clockwise)
+     *
+     * All corners contribute, so that the orientation of non-convex
+     * polygons is detected correctly, whichever corner comes first.
+     */
+    template< class Corner >
+    inline auto signedArea ( std::size_t n, Corner &&corner )
+    {
+      return polygonMoments( n, std::forward< Corner >( corner ) ).volume();
+    }
+
+
+
+    // convex
+    // ------
+
+    /**
+     * \brief return true, if the simple, counter-clockwise polygon given by its n corners is convex
+     *
+     * Collinear consecutive edges (e.g., hanging nodes) are admissible.
+     */
+    template< class Corner >
+    inline bool convex ( std::size_t n, Corner &&corner )
+    {
+      typedef std::decay_t< decltype( corner( 0u ) ) > GlobalCoordinate;
+      typedef AccumulationType< typename GlobalCoordinate::value_type > field_type;
+
+      for( std::size_t j = 0u; j < n; ++j )
+      {
+        const GlobalCoordinate x = corner( j ), y = corner( (j+1u) % n ), z = corner( (j+2u) % n );
+        const field_type a0 = field_type( y[ 0 ] ) - x[ 0 ], a1 = field_type( y[ 1 ] ) - x[ 1 ];
+        const field_type b0 = field_type( z[ 0 ] ) - y[ 0 ], b1 = field_type( z[ 1 ] ) - y[ 1 ];
+        if( a0*b1 < a1*b0 )
+          return false;
+      }
+      return true;
+    }
+
+
+
+    // orientPolygons
+    // --------------
+
+    /**
+     * \brief orient all polygons counter-clockwise
+     *
+     * The orientation of each polygon is decided by its signed area; all
+     * polygons are processed in one parallel pass.
+     *
+     * \returns number of reversed polygons
+     */
+    template< class ct >
+    inline std::size_t orientPolygons ( const std::vector< FieldVector< ct, 2 > > &vertices, MultiVector< std::size_t > &polygons )
+    {
+      std::vector< char > reversed( polygons.size(), 0 );
+      parallelFor( 0u, polygons.size(), [ &vertices, &polygons, &reversed ] ( std::size_t i ) {
+          auto polygon = polygons[ i ];
+          if( signedArea( polygon.size(), [ &vertices, &polygon ] ( std::size_t j ) { return vertices[ polygon[ j ] ]; } ) >= ct( 0 ) )
+            return;
+          std::reverse( polygon.begin(), polygon.end() );
+          reversed[ i ] = 1;
+        } );
+      return std::count( reversed.begin(), reversed.end(), 1 );
+    }
+
+
+
+    // convexPolygons
+    // --------------
+
+    /** \brief convexity of each (counter-clockwise) polygon */
+    template< class ct >
+    inline std::vector< char > convexPolygons ( const std::vector< FieldVector< ct, 2 > > &vertices, const MultiVector< std::size_t > &polygons )
+    {
+      std::vector< char > convex( polygons.size() );
+      parallelFor( 0u, polygons.size(), [ &vertices, &polygons, &convex ] ( std::size_t i ) {
+          const auto polygon = polygons[ i ];
+          convex[ i ] = (__PolygonGrid::convex( polygon.size(), [ &vertices, &polygon ] ( std::size_t j ) { return vertices[ polygon[ j ] ]; } ) ? 1 : 0);
+        } );
+      return convex;
+    }
+
+  } // namespace __PolygonGrid
+
+} // namespace Dune
+
+#endif // #ifndef DUNE_POLYGONGRID_ORIENTATION_HH
@@ -0,0 +1,91 @@
+#ifndef DUNE_POLYGONGRID_PARALLEL_HH
+#define DUNE_POLYGONGRID_PARALLEL_HH
+
+#include <cstddef>
+
+#include <algorithm>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace Dune
+{
+
+  namespace __PolygonGrid
+  {
+
+    // numThreads
+    // ----------
+
+    /**
+     * \brief number of threads used by parallelFor
+     *
+     * Defaults to the hardware concurrency; setting it to 1 serializes all
+     * mesh kernels.
+     */
+    inline std::size_t &numThreads () noexcept
+    {
+      static std::size_t numThreads = std::max( std::thread::hardware_concurrency(), 1u );
+      return numThreads;
+    }
+
+
+
+    // parallelFor
+    // -----------
+
+    /**
+     * \brief apply f( i ) for all i in [begin, end)
+     *
+     * The range is split into contiguous chunks, which are processed
+     * concurrently. The calls to f must therefore be independent of each
+     * other. Ranges smaller than grainSize are processed by the calling
+     * thread.
+     */
+    template< class F >
+    inline void parallelFor ( std::size_t begin, std::size_t end, F &&f, std::size_t grainSize = 16384u )
+    {
+      const std::size_t size = (end > begin ? end - begin : 0u);
+      const std::size_t numChunks = std::min( numThreads(), std::max< std::size_t >( size / std::max< std::size_t >( grainSize, 1u ), 1u ) );
+      if( numChunks <= 1u )
+      {
+        for( std::size_t i = begin; i < end; ++i )
+          f( i );
+        return;
+      }
+
+      std::exception_ptr exception;
+      std::mutex mutex;
+      auto chunk = [ &f, &exception, &mutex ] ( std::size_t first, std::size_t last ) {
+        try
+        {
+          for( std::size_t i = first; i < last; ++i )
+            f( i );
+        }
+        catch( ... )
+        {
+          std::lock_guard< std::mutex > guard( mutex );
+          if( !exception )
+            exception = std::current_exception();
+        }
+      };
+
+      std::vector< std::thread > threads;
+      threads.reserve( numChunks-1 );
+      for( std::size_t k = 1u; k < numChunks; ++k )
+        threads.emplace_back( chunk, begin + (k*size) / numChunks, begin + ((k+1)*size) / numChunks );
+      chunk( begin, begin + size / numChunks );
+      for( std::thread &thread : threads )
+        thread.join();
+
+      if( exception )
+        std::rethrow_exception( exception );
+    }
+
+  } // namespace __PolygonGrid
+
+} // namespace Dune
+
+#endif // #ifndef DUNE_POLYGONGRID_PARALLEL_HH
@@ -0,0 +1,214 @@
+#ifndef DUNE_POLYGONGRID_PERIODIC_HH
+#define DUNE_POLYGONGRID_PERIODIC_HH
+
+#include <cmath>
+#include <cstddef>
+
+#include <algorithm>
+#include <limits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+#include <dune/common/fvector.hh>
+
+#include <dune/polygongrid/mesh.hh>
+#include <dune/polygongrid/multivector.hh>
+
+namespace Dune
+{
+
+  namespace __PolygonGrid
+  {
+
+    namespace __Periodic
+    {
+
+      // VertexClasses
+      // -------------
+
+      /**
+       * \brief union-find structure for vertices identified up to a translation
+       *
+       * Each vertex x is represented by its root r and the translation t with
+       * x = r + t.
+       */
+      template< class V >
+      class VertexClasses
+      {
+      public:
+        explicit VertexClasses ( std::size_t size )
+          : parent_( size ), offset_( size, V( 0 ) )
+        {
+          for( std::size_t i = 0u; i < size; ++i )
+            parent_[ i ] = i;
+        }
+
+        std::pair< std::size_t, V > find ( std::size_t x )
+        {
+          if( parent_[ x ] == x )
+            return std::make_pair( x, V( 0 ) );
+
+          const std::pair< std::size_t, V > root = find( parent_[ x ] );
+          parent_[ x ] = root.first;
+          offset_[ x ] += root.second;
+          return std::make_pair( parent_[ x ], offset_[ x ] );
+        }
+
+        /** \brief identify y with x + translation (the smaller root remains representative) */
+        bool unite ( std::size_t x, std::size_t y, const V &translation, typename FieldTraits< V >::field_type tolerance )
+        {
+          std::pair< std::size_t, V > rx = find( x ), ry = find( y );
+          if( rx.first == ry.first )
+            return ((rx.second + translation - ry.second).two_norm() <= tolerance);
+
+          // y = ry + oy = rx + ox + t
+          if( ry.first > rx.first )
+          {
+            parent_[ ry.first ] = rx.first;
+            offset_[ ry.first ] = rx.second + translation - ry.second;
+          }
+          else
+          {
+            parent_[ rx.first ] = ry.first;
+            offset_[ rx.first ] = ry.second - translation - rx.second;
+          }
+          return true;
+        }
+
+      private:
+        std::vector< std::size_t > parent_;
+        std::vector< V > offset_;
+      };
+
+
+
+      // PointHash
+      // ---------
+
+      struct PointHash
+      {
+        std::size_t operator() ( const std::pair< long long, long long > &key ) const noexcept
+        {
+          return static_cast< std::size_t >( key.first ) * 0x9e3779b97f4a7c15ull ^ static_cast< std::size_t >( key.second );
+        }
+      };
+
+    } // namespace __Periodic
+
+
+
+    // identifyPeriodicBoundaries
+    // --------------------------
+
+    /**
+     * \brief identify boundary edges matching under given translations
+     *
+     * A boundary edge is matched with another one, if the latter is the
+     * former translated by one of the given translations (within the given
+     * tolerance). The vertices of matched edges are identified; the
+     * identified vertices are removed and the polygons are renumbered
+     * accordingly. Afterwards, the matched edges are interior edges of the
+     * mesh.
+     *
+     * The returned translations for each polygon corner allow to recover
+     * the original positions. They are to be passed to the corresponding
+     * Mesh constructor.
+     *
+     * \param       vertices      positions of the vertices
+     * \param       polygons      vertices of each (counter-clockwise oriented) polygon
+     * \param[in]   translations  translations mapping one side of the domain onto the other
+     * \param[in]   tolerance     absolute tolerance for matching positions
+     *
+     * \returns translation of each polygon corner
+     */
+    template< class ct >
+    inline MultiVector< FieldVector< ct, 2 > > identifyPeriodicBoundaries ( std::vector< FieldVector< ct, 2 > > &vertices, MultiVector< std::size_t > &polygons,
+                                                                            const std::vector< FieldVector< ct, 2 > > &translations, ct tolerance = ct( 1e-8 ) )
+    {
+      typedef FieldVector< ct, 2 > GlobalCoordinate;
+      typedef std::pair< long long, long long > Key;
+
+      const std::size_t numVertices = vertices.size();
+      const MultiVector< std::size_t > bnds = boundaries( numVertices, polygons );
+
+      // hash boundary edges by their midpoints
+      const ct cellSize = std::max( ct( 4 ) * tolerance, std::numeric_limits< ct >::min() );
+      auto key = [ cellSize ] ( const GlobalCoordinate &x, int di, int dj ) {
+        return Key( std::llround( std::floor( x[ 0 ] / cellSize ) ) + di, std::llround( std::floor( x[ 1 ] / cellSize ) ) + dj );
+      };
+      auto midpoint = [ &vertices, &bnds ] ( std::size_t i ) { return (vertices[ bnds[ i ][ 0 ] ] + vertices[ bnds[ i ][ 1 ] ]) * ct( 1 ) / ct( 2 ); };
+
+      std::unordered_multimap< Key, std::size_t, __Periodic::PointHash > edges;
+      for( std::size_t i = 0u; i < bnds.size(); ++i )
+        edges.emplace( key( midpoint( i ), 0, 0 ), i );
+
+      // match translated boundary edges; edge (a0, a1) is traversed from a1 to a0, so its image is (b0, b1) = (a1, a0) + t
+      __Periodic::VertexClasses< GlobalCoordinate > classes( numVertices );
+      std::vector< char > matched( bnds.size(), 0 );
+      for( const GlobalCoordinate &translation : translations )
+      {
+        for( std::size_t i = 0u; i < bnds.size(); ++i )
+        {
+          if( matched[ i ] )
+            continue;
+
+          const GlobalCoordinate image = midpoint( i ) + translation;
+          for( int d = 0; (d < 9) && !matched[ i ]; ++d )
+          {
+            const auto range = edges.equal_range( key( image, d % 3 - 1, d / 3 - 1 ) );
+            for( auto it = range.first; it != range.second; ++it )
+            {
+              const std::size_t j = it->second;
+              if( matched[ j ] || (j == i) )
+                continue;
+              if( ((vertices[ bnds[ i ][ 1 ] ] + translation - vertices[ bnds[ j ][ 0 ] ]).two_norm() > tolerance)
+                  || ((vertices[ bnds[ i ][ 0 ] ] + translation - vertices[ bnds[ j ][ 1 ] ]).two_norm() > tolerance) )
+                continue;
+
+              if( !classes.unite( bnds[ i ][ 1 ], bnds[ j ][ 0 ], translation, tolerance ) || !classes.unite( bnds[ i ][ 0 ], bnds[ j ][ 1 ], translation, tolerance ) )
+                DUNE_THROW( InvalidStateException, "Inconsistent periodic identification of vertices " << bnds[ i ][ 0 ] << " and " << bnds[ i ][ 1 ] << "." );
+              matched[ i ] = matched[ j ] = 1;
+              break;
+            }
+          }
+        }
+      }
+
+      // renumber vertices, keeping the representatives only
+      std::vector< std::size_t > vertexMap( numVertices, std::numeric_limits< std::size_t >::max() );
+      std::size_t numNewVertices = 0u;
+      for( std::size_t v = 0u; v < numVertices; ++v )
+      {
+        if( classes.find( v ).first == v )
+        {
+          vertices[ numNewVertices ] = vertices[ v ];
+          vertexMap[ v ] = numNewVertices++;
+        }
+      }
+      vertices.resize( numNewVertices );
+
+      MultiVector< GlobalCoordinate > shifts( polygons.sizes() );
+      for( std::size_t i = 0u; i < polygons.size(); ++i )
+      {
+        for( std::size_t j = 0u; j < polygons.size( i ); ++j )
+        {
+          const std::pair< std::size_t, GlobalCoordinate > root = classes.find( polygons[ i ][ j ] );
+          polygons[ i ][ j ] = vertexMap[ root.first ];
+          shifts[ i ][ j ] = root.second;
+        }
+
+        std::vector< std::size_t > corners( polygons[ i ].begin(), polygons[ i ].end() );
+        std::sort( corners.begin(), corners.end() );
+        if( std::adjacent_find( corners.begin(), corners.end() ) != corners.end() )
+          DUNE_THROW( InvalidStateException, "Polygon " << i << " is identified with itself by periodicity." );
+      }
+      return shifts;
+    }
+
+  } // namespace __PolygonGrid
+
+} // namespace Dune
+
+#endif // #ifndef DUNE_POLYGONGRID_PERIODIC_HH
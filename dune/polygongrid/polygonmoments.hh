@@ -0,0 +1,123 @@
+#ifndef DUNE_POLYGONGRID_POLYGONMOMENTS_HH
+#define DUNE_POLYGONGRID_POLYGONMOMENTS_HH
+
+#include <cstddef>
+
+#include <limits>
+#include <type_traits>
+
+#include <dune/common/fvector.hh>
+
+namespace Dune
+{
+
+  namespace __PolygonGrid
+  {
+
+    // AccumulationType
+    // ----------------
+
+    /**
+     * \brief field type used to accumulate geometric quantities
+     *
+     * Coordinate types less precise than double (e.g., float) are
+     * accumulated in double; all others are used as is.
+     */
+    template< class ct >
+    using AccumulationType = std::conditional_t< (std::numeric_limits< ct >::digits < std::numeric_limits< double >::digits), double, ct >;
+
+
+
+    // PolygonMoments
+    // --------------
+
+    /**
+     * \brief volume and centroid of a polygon by the shoelace formula
+     *
+     * The corners are taken relative to a per-cell origin (usually the first
+     * corner) and the products are accumulated in AccumulationType< ct >.
+     * This avoids the cancellation of the shoelace products for coordinates
+     * far from the global origin, which is especially severe in single
+     * precision.
+     *
+     * \note The moments are accurate for the corners as given. The mesh
+     *       stores absolute coordinates of type ct, though, so in single
+     *       precision the positions themselves are rounded relative to
+     *       their distance from the origin. For meshes far from the origin,
+     *       translate the coordinates before storing them in single
+     *       precision.
+     */
+    template< class ct >
+    class PolygonMoments
+    {
+      typedef PolygonMoments< ct > This;
+
+    public:
+      typedef AccumulationType< ct > field_type;
+
+      typedef FieldVector< ct, 2 > GlobalCoordinate;
+
+      explicit PolygonMoments ( const GlobalCoordinate &origin ) noexcept
+        : origin_{ field_type( origin[ 0 ] ), field_type( origin[ 1 ] ) }
+      {}
+
+      /** \brief add the edge from corner x to corner y */
+      void add ( const GlobalCoordinate &x, const GlobalCoordinate &y ) noexcept
+      {
+        const field_type x0 = field_type( x[ 0 ] ) - origin_[ 0 ], x1 = field_type( x[ 1 ] ) - origin_[ 1 ];
+        const field_type y0 = field_type( y[ 0 ] ) - origin_[ 0 ], y1 = field_type( y[ 1 ] ) - origin_[ 1 ];
+        const field_type weight = x0*y1 - x1*y0;
+        volume_ += weight;
+        moment_[ 0 ] += weight * (x0 + y0);
+        moment_[ 1 ] += weight * (x1 + y1);
+      }
+
+      ct volume () const noexcept { return ct( volume_ / field_type( 2 ) ); }
+
+      GlobalCoordinate center () const noexcept
+      {
+        const field_type factor = field_type( 1 ) / (field_type( 3 )*volume_);
+        return GlobalCoordinate{ ct( origin_[ 0 ] + factor*moment_[ 0 ] ), ct( origin_[ 1 ] + factor*moment_[ 1 ] ) };
+      }
+
+    private:
+      field_type origin_[ 2 ];
+      field_type moment_[ 2 ] = { field_type( 0 ), field_type( 0 ) };
+      field_type volume_ = field_type( 0 );
+    };
+
+
+
+    // polygonMoments
+    // --------------
+
+    /**
+     * \brief moments of the polygon given by its n corners, relative to the first one
+     *
+     * The corners are obtained by calling corner( j ) for j = 0, ..., n-1.
+     * As the edges adjacent to the first corner do not contribute, only the
+     * remaining n-2 edges are added.
+     */
+    template< class Corner >
+    inline auto polygonMoments ( std::size_t n, Corner &&corner ) noexcept
+    {
+      typedef std::decay_t< decltype( corner( std::size_t( 0u ) ) ) > GlobalCoordinate;
+
+      PolygonMoments< typename GlobalCoordinate::value_type > moments( corner( 0u ) );
+      if( n < 3u )
+        return moments;
+      GlobalCoordinate x = corner( 1u );
+      for( std::size_t j = 2u; j < n; ++j )
+      {
+        const GlobalCoordinate y = corner( j );
+        moments.add( x, y );
+        x = y;
+      }
+      return moments;
+    }
+
+  } // namespace __PolygonGrid
+
+} // namespace Dune
+
+#endif // #ifndef DUNE_POLYGONGRID_POLYGONMOMENTS_HH
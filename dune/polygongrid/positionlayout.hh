@@ -0,0 +1,198 @@
+#ifndef DUNE_POLYGONGRID_POSITIONLAYOUT_HH
+#define DUNE_POLYGONGRID_POSITIONLAYOUT_HH
+
+#include <cassert>
+#include <cstddef>
+
+#include <vector>
+
+#include <dune/common/alignedallocator.hh>
+
+#include <dune/polygongrid/mesh.hh>
+#include <dune/polygongrid/parallel.hh>
+#include <dune/polygongrid/polygonmoments.hh>
+
+namespace Dune
+{
+
+  namespace __PolygonGrid
+  {
+
+    // SoAPositions
+    // ------------
+
+    /**
+     * \brief node positions of a mesh, stored as separate x and y arrays
+     *
+     * This is an alternative to the interleaved (AoS) storage of the mesh
+     * positions: Kernels that only need one coordinate or process many
+     * nodes at once read contiguous, 64 byte aligned arrays.
+     *
+     * The positions are copied from the mesh; call update() after moving
+     * the mesh vertices.
+     */
+    template< class ct >
+    class SoAPositions
+    {
+      typedef SoAPositions< ct > This;
+
+    public:
+      typedef __PolygonGrid::Mesh< ct > Mesh;
+
+      typedef typename Mesh::GlobalCoordinate GlobalCoordinate;
+
+      typedef std::vector< ct, Dune::AlignedAllocator< ct, 64u > > Container;
+
+      SoAPositions ( const Mesh &mesh, MeshType type )
+        : mesh_( mesh ), type_( type )
+      {
+        update();
+      }
+
+      void update ()
+      {
+        const std::size_t size = mesh().numNodes( type() );
+        x_.resize( size );
+        y_.resize( size );
+        parallelFor( 0u, size, [ this ] ( std::size_t i ) {
+            const GlobalCoordinate &x = mesh().position( NodeIndex( i, type() ) );
+            x_[ i ] = x[ 0 ];
+            y_[ i ] = x[ 1 ];
+          } );
+      }
+
+      GlobalCoordinate operator[] ( std::size_t i ) const noexcept { return GlobalCoordinate{ x_[ i ], y_[ i ] }; }
+
+      /** \brief volume of a cell of the grid of the same type */
+      ct volume ( std::size_t cell ) const noexcept { return moments( cell ).volume(); }
+
+      /** \brief centroid of a cell of the grid of the same type */
+      GlobalCoordinate center ( std::size_t cell ) const noexcept { return moments( cell ).center(); }
+
+      const Container &x () const noexcept { return x_; }
+      const Container &y () const noexcept { return y_; }
+
+      const Mesh &mesh () const noexcept { return mesh_; }
+      MeshType type () const noexcept { return type_; }
+
+    private:
+      GlobalCoordinate corner ( HalfEdgeIndex h ) const noexcept
+      {
+        GlobalCoordinate x = (*this)[ mesh().target( h ) ];
+        return (mesh().periodic() ? x += mesh().shift( h ) : x);
+      }
+
+      PolygonMoments< ct > moments ( std::size_t cell ) const noexcept
+      {
+        const MultiVector< IndexPair > &cells = mesh().nodes( dual( type() ) );
+        const std::size_t begin = cells.begin_of( cell );
+        return polygonMoments( cells.size( cell ), [ this, begin ] ( std::size_t j ) { return corner( HalfEdgeIndex( begin+j, type() ) ); } );
+      }
+
+      const Mesh &mesh_;
+      MeshType type_;
+      Container x_, y_;
+    };
+
+
+
+    // CellCorners
+    // -----------
+
+    /**
+     * \brief corner positions gathered per cell
+     *
+     * The corners of each cell of the grid of given type are stored in the
+     * order of the half edges, i.e., like the values of
+     * Mesh::nodes( dual( type ) ), as separate x and y arrays. The position
+     * of corner k is the position of HalfEdgeIndex( k, type ) (including
+     * periodic shifts). Cell-wise geometry kernels thus stream contiguous
+     * memory without any indirection, at the cost of storing each vertex
+     * position once per adjacent cell.
+     *
+     * The corners are copied from the mesh; call update() after moving
+     * the mesh vertices.
+     */
+    template< class ct >
+    class CellCorners
+    {
+      typedef CellCorners< ct > This;
+
+    public:
+      typedef __PolygonGrid::Mesh< ct > Mesh;
+
+      typedef typename Mesh::GlobalCoordinate GlobalCoordinate;
+
+      typedef std::vector< ct, Dune::AlignedAllocator< ct, 64u > > Container;
+
+      CellCorners ( const Mesh &mesh, MeshType type )
+        : mesh_( mesh ), type_( type )
+      {
+        update();
+      }
+
+      void update ()
+      {
+        const MultiVector< IndexPair > &cells = this->cells();
+        const std::size_t size = cells.begin_of( numCells() );
+        x_.resize( size );
+        y_.resize( size );
+        parallelFor( 0u, size, [ this ] ( std::size_t k ) {
+            const GlobalCoordinate x = mesh().position( HalfEdgeIndex( k, type() ) );
+            x_[ k ] = x[ 0 ];
+            y_[ k ] = x[ 1 ];
+          } );
+      }
+
+      std::size_t numCells () const noexcept { return mesh().numCells( type() ); }
+
+      std::size_t begin_of ( std::size_t cell ) const noexcept { return cells().begin_of( cell ); }
+      std::size_t end_of ( std::size_t cell ) const noexcept { return cells().end_of( cell ); }
+
+      GlobalCoordinate operator[] ( std::size_t k ) const noexcept { return GlobalCoordinate{ x_[ k ], y_[ k ] }; }
+
+      ct volume ( std::size_t cell ) const noexcept
+      {
+        typedef AccumulationType< ct > field_type;
+        const std::size_t begin = begin_of( cell ), end = end_of( cell );
+        const ct *x = x_.data(), *y = y_.data();
+        const field_type x0 = x[ begin ], y0 = y[ begin ];
+        field_type volume( 0 );
+        for( std::size_t k = begin+1u; k+1u < end; ++k )
+          volume += (field_type( x[ k ] ) - x0)*(field_type( y[ k+1u ] ) - y0) - (field_type( y[ k ] ) - y0)*(field_type( x[ k+1u ] ) - x0);
+        return ct( volume / field_type( 2 ) );
+      }
+
+      GlobalCoordinate center ( std::size_t cell ) const noexcept
+      {
+        const std::size_t begin = begin_of( cell );
+        return polygonMoments( end_of( cell ) - begin, [ this, begin ] ( std::size_t j ) { return (*this)[ begin+j ]; } ).center();
+      }
+
+      /** \brief volumes of all cells */
+      template< class Vector >
+      void volumes ( Vector &volumes ) const
+      {
+        assert( volumes.size() == numCells() );
+        parallelFor( 0u, numCells(), [ this, &volumes ] ( std::size_t i ) { volumes[ i ] = volume( i ); } );
+      }
+
+      const Container &x () const noexcept { return x_; }
+      const Container &y () const noexcept { return y_; }
+
+      const Mesh &mesh () const noexcept { return mesh_; }
+      MeshType type () const noexcept { return type_; }
+
+    private:
+      const MultiVector< IndexPair > &cells () const noexcept { return mesh().nodes( dual( type() ) ); }
+
+      const Mesh &mesh_;
+      MeshType type_;
+      Container x_, y_;
+    };
+
+  } // namespace __PolygonGrid
+
+} // namespace Dune
+
+#endif // #ifndef DUNE_POLYGONGRID_POSITIONLAYOUT_HH
@@ -0,0 +1,410 @@
+#ifndef DUNE_POLYGONGRID_REFINEMENT_HH
+#define DUNE_POLYGONGRID_REFINEMENT_HH
+
+#include <cassert>
+#include <cstddef>
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <dune/polygongrid/mesh.hh>
+#include <dune/polygongrid/multivector.hh>
+#include <dune/polygongrid/parallel.hh>
+
+namespace Dune
+{
+
+  namespace __PolygonGrid
+  {
+
+    // refine
+    // ------
+
+    /**
+     * \brief refine marked primal cells of a mesh
+     *
+     * Each marked polygon with n corners is split into n quadrilaterals,
+     * connecting its centroid with the edge midpoints. The resulting hanging
+     * nodes are resolved by inserting the midpoints into the neighboring
+     * polygons, i.e., no further cells need to be refined for closure.
+     *
+     * The numbering of the new mesh is derived from the old one:
+     * - vertices and unmarked cells keep their indices,
+     * - the first child of a marked cell replaces its father,
+     * - the boundary edges are derived from the old ones, inheriting their
+     *   boundary ids and segments.
+     *
+     * Entities not changed by the refinement, i.e., the old vertices, the
+     * unmarked cells and their unsplit edges, keep their persistent ids (see
+     * Mesh::inheritIds).
+     *
+     * The mesh structure is patched rather than rebuilt: the half edges
+     * around the old vertices are copied from the given mesh, as refinement
+     * does not change their number. Only the half edges around the new
+     * vertices are sorted, which yields the same structure as meshStructure.
+     *
+     * The fine mesh is attached to the given one as its child. Unless the
+     * dual data of the given mesh has been built, the fine mesh defers its
+     * dual data, too (see Mesh::buildDual).
+     *
+     * \param[in]  mesh    mesh to refine
+     * \param[in]  marked  refinement flag for each primal cell
+     *
+     * \returns the refined mesh
+     */
+    template< class ct >
+    inline std::shared_ptr< Mesh< ct > > refine ( const std::shared_ptr< Mesh< ct > > &mesh, const std::vector< char > &marked )
+    {
+      typedef typename Mesh< ct >::GlobalCoordinate GlobalCoordinate;
+
+      const std::size_t numCells = mesh->numCells( Primal );
+      const std::size_t numVertices = mesh->numVertices( Primal );
+      const std::size_t numEdges = mesh->numEdges( Primal );
+      const std::size_t numBoundaries = mesh->numBoundaries( Primal );
+      const std::size_t none = std::numeric_limits< std::size_t >::max();
+      assert( marked.size() == numCells );
+      assert( !mesh->periodic() );
+
+      auto halfEdge = [ &mesh ] ( std::size_t i, std::size_t j ) { return mesh->begin( NodeIndex( i, Dual ) ) + static_cast< std::ptrdiff_t >( j ); };
+      auto size = [ &mesh ] ( std::size_t i ) { return mesh->size( NodeIndex( i, Dual ) ); };
+
+      // number the new vertices: edge midpoints first, then the cell centroids
+      std::vector< std::size_t > midpoints( numEdges, none ), centroids( numCells, none );
+      std::vector< IndexPair > splitCorners( numEdges );
+      for( std::size_t i = 0u; i < numCells; ++i )
+      {
+        if( !marked[ i ] )
+          continue;
+        for( std::size_t j = 0u; j < size( i ); ++j )
+        {
+          const std::size_t e = mesh->edgeIndex( halfEdge( i, j ) );
+          midpoints[ e ] = 0u;
+          splitCorners[ e ] = IndexPair( i, j );
+        }
+      }
+      std::size_t numNewVertices = numVertices;
+      std::vector< IndexPair > midpointCorners;
+      for( std::size_t e = 0u; e < numEdges; ++e )
+      {
+        if( midpoints[ e ] == none )
+          continue;
+        midpoints[ e ] = numNewVertices++;
+        midpointCorners.push_back( splitCorners[ e ] );
+      }
+      for( std::size_t i = 0u; i < numCells; ++i )
+        centroids[ i ] = (marked[ i ] ? numNewVertices++ : none);
+
+      std::vector< GlobalCoordinate > vertices( numNewVertices );
+      parallelFor( 0u, numVertices, [ &mesh, &vertices ] ( std::size_t v ) { vertices[ v ] = mesh->position( NodeIndex( v, Primal ) ); } );
+
+      // number the new cells: children beyond the first are appended
+      std::vector< std::size_t > firstChild( numCells ), counts( numCells );
+      std::size_t numNewCells = numCells;
+      for( std::size_t i = 0u; i < numCells; ++i )
+      {
+        const std::size_t n = size( i );
+        firstChild[ i ] = numNewCells;
+        if( marked[ i ] )
+        {
+          numNewCells += n-1;
+          counts[ i ] = 4u;
+        }
+        else
+        {
+          counts[ i ] = n;
+          for( std::size_t j = 0u; j < n; ++j )
+            counts[ i ] += (midpoints[ mesh->edgeIndex( halfEdge( i, j ) ) ] != none ? 1u : 0u);
+        }
+      }
+      counts.resize( numNewCells, 4u );
+
+      auto child = [ &firstChild ] ( std::size_t i, std::size_t j ) { return (j == 0u ? i : firstChild[ i ] + j-1); };
+
+      // derive boundary edges from the old ones (a split edge keeps its index for the first half)
+      MultiVector< std::size_t > boundaries( std::vector< std::size_t >( numBoundaries, 2u ) );
+      std::vector< std::size_t > boundaryFathers( numBoundaries ), secondHalves( numBoundaries, none );
+      for( std::size_t i = 0u; i < numBoundaries; ++i )
+      {
+        boundaryFathers[ i ] = i;
+        const NodeIndex node( numCells + i, Dual );
+        const HalfEdgeIndex h = ++mesh->begin( node );
+        const std::size_t b0 = mesh->target( mesh->flip( h ) );
+        const std::size_t b1 = mesh->target( h );
+        const std::size_t m = midpoints[ mesh->edgeIndex( h ) ];
+        boundaries[ i ][ 0 ] = b0;
+        boundaries[ i ][ 1 ] = (m != none ? m : b1);
+        if( m != none )
+        {
+          secondHalves[ i ] = boundaries.size();
+          boundaries.push_back( { m, b1 } );
+          boundaryFathers.push_back( i );
+        }
+      }
+      const std::size_t numNewBoundaries = boundaries.size();
+
+      // polygons and boundary nodes, laid out as by meshStructure
+      MeshStructure nodes;
+      counts.insert( counts.end(), numNewBoundaries, 3u );
+      counts.insert( counts.end(), numNewBoundaries, 2u );
+      nodes[ Dual ].resize( counts );
+
+      std::vector< std::size_t > positions( mesh->nodes( Dual ).values().size(), none );
+      std::vector< std::size_t > halfEdgeOrigins( nodes[ Dual ].values().size(), none );
+      parallelFor( 0u, numCells, [ &mesh, &marked, &halfEdge, &size, &child, &midpoints, &centroids, &vertices, &nodes, &positions, &halfEdgeOrigins, none ] ( std::size_t i ) {
+          const std::size_t n = size( i );
+          auto target = [ &mesh, &halfEdge, i ] ( std::size_t j ) { return static_cast< std::size_t >( mesh->target( halfEdge( i, j ) ) ); };
+          auto midpoint = [ &mesh, &halfEdge, &midpoints, i ] ( std::size_t j ) { return midpoints[ mesh->edgeIndex( halfEdge( i, j ) ) ]; };
+          auto corner = [ none ] ( std::size_t v ) { return IndexPair( v, none ); };
+
+          if( marked[ i ] )
+          {
+            // a midpoint shared by two marked cells is computed by the one with smaller index
+            for( std::size_t j = 0u; j < n; ++j )
+            {
+              const HalfEdgeIndex h = halfEdge( i, j );
+              const NodeIndex nb = mesh->target( mesh->dual( h ) );
+              if( !mesh->regular( nb ) || !marked[ nb ] || (i < nb) )
+                vertices[ midpoint( j ) ] = (mesh->position( mesh->target( h ) ) + mesh->position( mesh->target( mesh->flip( h ) ) )) * ct( 1 ) / ct( 2 );
+            }
+            vertices[ centroids[ i ] ] = cellCentroid( *mesh, NodeIndex( i, Dual ) );
+
+            for( std::size_t j = 0u; j < n; ++j )
+            {
+              auto polygon = nodes[ Dual ][ child( i, j ) ];
+              polygon[ 0 ] = corner( midpoint( j ) );
+              polygon[ 1 ] = corner( target( j ) );
+              polygon[ 2 ] = corner( midpoint( (j+1) % n ) );
+              polygon[ 3 ] = corner( centroids[ i ] );
+            }
+          }
+          else
+          {
+            // insert midpoints of split edges, remembering the new position of each corner
+            auto polygon = nodes[ Dual ][ i ];
+            std::size_t k = 0u;
+            for( std::size_t j = 0u; j < n; ++j )
+            {
+              if( midpoint( j ) != none )
+                polygon[ k++ ] = corner( midpoint( j ) );
+              else
+                halfEdgeOrigins[ nodes[ Dual ].position_of( i, k ) ] = halfEdge( i, j );
+              positions[ halfEdge( i, j ) ] = k;
+              polygon[ k++ ] = corner( target( j ) );
+            }
+            assert( k == polygon.size() );
+          }
+        } );
+
+      for( std::size_t i = 0u; i < numNewBoundaries; ++i )
+      {
+        auto edge = nodes[ Dual ][ numNewCells + i ];
+        edge[ 0 ] = IndexPair( boundaries[ i ][ 0 ], 1 );
+        edge[ 1 ] = IndexPair( boundaries[ i ][ 1 ], none );
+        edge[ 2 ] = IndexPair( numNewVertices + 2*i+1, 0 );
+        auto vertex = nodes[ Dual ][ numNewCells + numNewBoundaries + i ];
+        vertex[ 0 ] = IndexPair( boundaries[ i ][ 0 ], 2 );
+        vertex[ 1 ] = IndexPair( numNewVertices + 2*i, 0 );
+      }
+
+      // half edges around the vertices: old vertices keep their number, new ones are found below
+      std::vector< std::size_t > valences( numNewVertices + 2u*numNewBoundaries, 1u );
+      for( std::size_t v = 0u; v < numVertices; ++v )
+        valences[ v ] = mesh->size( NodeIndex( v, Primal ) );
+      for( std::size_t q = 0u; q < midpointCorners.size(); ++q )
+      {
+        const NodeIndex nb = mesh->target( mesh->dual( halfEdge( midpointCorners[ q ].first, midpointCorners[ q ].second ) ) );
+        valences[ numVertices + q ] = 2u + (mesh->regular( nb ) ? (marked[ nb ] ? 2u : 1u) : 3u);
+      }
+      for( std::size_t i = 0u; i < numCells; ++i )
+      {
+        if( marked[ i ] )
+          valences[ centroids[ i ] ] = size( i );
+      }
+      nodes[ Primal ].resize( valences );
+
+      // let the corners of the polygons point to the next half edge around their vertex
+      auto link = [ &nodes ] ( std::size_t v ) {
+          auto node = nodes[ Primal ][ v ];
+          for( std::size_t k = 0u; k < node.size(); ++k )
+          {
+            auto polygon = nodes[ Dual ][ node[ k ].first ];
+            polygon[ (node[ k ].second + polygon.size() - 1u) % polygon.size() ].second = (k+1u) % node.size();
+          }
+        };
+
+      // the half edges around an old vertex are those of the given mesh, renumbered
+      parallelFor( 0u, numVertices, [ &mesh, &marked, &halfEdge, &size, &child, &secondHalves, &positions, &nodes, &link, numCells, numBoundaries, numNewCells, numNewBoundaries, none ] ( std::size_t v ) {
+          const auto father = mesh->nodes( Primal )[ v ];
+          auto node = nodes[ Primal ][ v ];
+          for( std::size_t k = 0u; k < node.size(); ++k )
+          {
+            const std::size_t d = father[ k ].first, p = father[ k ].second;
+            if( d < numCells )
+            {
+              const std::size_t j = (p + size( d ) - 1u) % size( d );
+              node[ k ] = (marked[ d ] ? IndexPair( child( d, j ), 2u ) : IndexPair( d, (positions[ halfEdge( d, j ) ] + 1u) % nodes[ Dual ].size( d ) ));
+            }
+            else if( d < numCells + numBoundaries )
+            {
+              const std::size_t i = d - numCells;
+              node[ k ] = IndexPair( numNewCells + ((p == 2u) && (secondHalves[ i ] != none) ? secondHalves[ i ] : i), p );
+            }
+            else
+              node[ k ] = IndexPair( numNewCells + numNewBoundaries + (d - numCells - numBoundaries), p );
+          }
+
+          // as in meshStructure, interior vertices start with the polygon of least index
+          if( node[ 0 ].first < numNewCells )
+            std::rotate( node.begin(), std::min_element( node.begin(), node.end() ), node.end() );
+          link( v );
+        } );
+
+      // the half edges around a new vertex are sorted as in meshStructure
+      parallelFor( 0u, midpointCorners.size(), [ &mesh, &marked, &halfEdge, &size, &child, &secondHalves, &positions, &midpointCorners, &nodes, numVertices, numCells, numNewCells, numNewBoundaries ] ( std::size_t q ) {
+          const std::size_t i = midpointCorners[ q ].first, j = midpointCorners[ q ].second;
+          const HalfEdgeIndex h = halfEdge( i, j );
+          const NodeIndex nb = mesh->target( mesh->dual( h ) );
+          auto node = nodes[ Primal ][ numVertices + q ];
+          std::size_t k = 0u;
+          if( !mesh->regular( nb ) )
+          {
+            // the midpoint ends the first half of the boundary edge and starts the second one
+            const std::size_t b = static_cast< std::size_t >( nb ) - numCells;
+            node[ k++ ] = IndexPair( numNewCells + secondHalves[ b ], 1u );
+            node[ k++ ] = IndexPair( numNewCells + numNewBoundaries + secondHalves[ b ], 1u );
+            node[ k++ ] = IndexPair( numNewCells + b, 2u );
+          }
+          else if( marked[ nb ] )
+          {
+            const std::size_t jn = static_cast< std::size_t >( mesh->flip( h ) - mesh->begin( nb ) );
+            node[ k++ ] = IndexPair( child( nb, jn ), 1u );
+            node[ k++ ] = IndexPair( child( nb, (jn + size( nb ) - 1u) % size( nb ) ), 3u );
+          }
+          else
+            node[ k++ ] = IndexPair( nb, positions[ mesh->flip( h ) ] );
+          node[ k++ ] = IndexPair( child( i, j ), 1u );
+          node[ k++ ] = IndexPair( child( i, (j + size( i ) - 1u) % size( i ) ), 3u );
+          assert( k == node.size() );
+
+          std::sort( node.begin() + (mesh->regular( nb ) ? 0u : 3u), node.end() );
+          sortVertexNode( nodes, numVertices + q, numNewCells );
+        } );
+      parallelFor( 0u, numCells, [ &marked, &size, &child, &centroids, &nodes, numNewCells ] ( std::size_t i ) {
+          if( !marked[ i ] )
+            return;
+          auto node = nodes[ Primal ][ centroids[ i ] ];
+          for( std::size_t j = 0u; j < size( i ); ++j )
+            node[ j ] = IndexPair( child( i, j ), 0u );
+          sortVertexNode( nodes, centroids[ i ], numNewCells );
+        } );
+
+      for( std::size_t i = 0u; i < numNewBoundaries; ++i )
+      {
+        nodes[ Primal ][ numNewVertices + 2*i ][ 0 ] = IndexPair( numNewCells + i, 0 );
+        const std::size_t j = nodes[ Primal ][ boundaries[ i ][ 1 ] ][ 0 ].first;
+        nodes[ Primal ][ numNewVertices + 2*i+1 ][ 0 ] = IndexPair( j + numNewBoundaries, 0 );
+      }
+
+      std::vector< std::size_t > fathers( numNewCells );
+      parallelFor( 0u, numCells, [ &marked, &size, &child, &fathers ] ( std::size_t i ) {
+          for( std::size_t j = 0u; j < (marked[ i ] ? size( i ) : 1u); ++j )
+            fathers[ child( i, j ) ] = i;
+        } );
+
+      // vertices, unmarked cells and unsplit boundary edges keep their ids
+      std::array< std::vector< std::size_t >, 2 > nodeOrigins{{ std::vector< std::size_t >( nodes[ Primal ].size(), none ), std::vector< std::size_t >( nodes[ Dual ].size(), none ) }};
+      for( std::size_t v = 0u; v < numVertices; ++v )
+        nodeOrigins[ Primal ][ v ] = v;
+      for( std::size_t i = 0u; i < numCells; ++i )
+        nodeOrigins[ Dual ][ i ] = (marked[ i ] ? none : i);
+      for( std::size_t i = 0u; i < numBoundaries; ++i )
+      {
+        nodeOrigins[ Dual ][ numNewCells + numNewBoundaries + i ] = numCells + numBoundaries + i;
+        if( secondHalves[ i ] != none )
+          continue;
+        nodeOrigins[ Dual ][ numNewCells + i ] = numCells + i;
+        for( std::size_t k = 0u; k < 2u; ++k )
+          nodeOrigins[ Primal ][ numNewVertices + 2*i+k ] = numVertices + 2*i+k;
+        for( std::size_t j = 0u; j < 3u; ++j )
+          halfEdgeOrigins[ nodes[ Dual ].position_of( numNewCells + i, j ) ] = mesh->nodes( Dual ).position_of( numCells + i, j );
+        for( std::size_t j = 0u; j < 2u; ++j )
+          halfEdgeOrigins[ nodes[ Dual ].position_of( numNewCells + numNewBoundaries + i, j ) ] = mesh->nodes( Dual ).position_of( numCells + numBoundaries + i, j );
+      }
+
+      std::shared_ptr< Mesh< ct > > fine = std::make_shared< Mesh< ct > >( vertices, std::move( nodes ), !mesh->dualBuilt() );
+      fine->inheritIds( *mesh, nodeOrigins, halfEdgeOrigins );
+      fine->copyBoundaryData( *mesh, boundaryFathers );
+      fine->setFather( mesh, std::move( fathers ) );
+      return fine;
+    }
+
+
+
+    // RestrictProlong
+    // ---------------
+
+    /**
+     * \brief transfer of piecewise constant cell data between a mesh and its father
+     *
+     * The data are stored in flat arrays indexed by the primal cell indices,
+     * e.g., std::vector< double >. The fine mesh (and, through it, its
+     * father) is kept alive by the transfer object, so it remains valid
+     * after the grid has been adapted again.
+     */
+    template< class ct >
+    class RestrictProlong
+    {
+      typedef RestrictProlong< ct > This;
+
+    public:
+      typedef __PolygonGrid::Mesh< ct > Mesh;
+
+      explicit RestrictProlong ( std::shared_ptr< const Mesh > fine )
+        : fine_( std::move( fine ) ), volumes_( fine_->numCells( Primal ) )
+      {
+        assert( fine_->father() );
+        parallelFor( 0u, volumes_.size(), [ this ] ( std::size_t i ) { volumes_[ i ] = cellVolume( *fine_, NodeIndex( i, Dual ) ); } );
+      }
+
+      /** \brief copy the value of each father to all its children */
+      template< class Coarse, class Fine >
+      void prolong ( const Coarse &coarse, Fine &fine ) const
+      {
+        parallelFor( 0u, fine_->numCells( Primal ), [ this, &coarse, &fine ] ( std::size_t i ) { fine[ i ] = coarse[ fine_->father( i ) ]; } );
+      }
+
+      /** \brief assign the volume-weighted average of its children to each father */
+      template< class Fine, class Coarse >
+      void restrict ( const Fine &fine, Coarse &coarse ) const
+      {
+        const MultiVector< std::size_t > &children = fine_->father()->children();
+        parallelFor( 0u, children.size(), [ this, &children, &fine, &coarse ] ( std::size_t i ) {
+            ct volume = 0;
+            auto value = fine[ children[ i ][ 0 ] ];
+            value *= ct( 0 );
+            for( std::size_t j : children[ i ] )
+            {
+              value += volumes_[ j ] * fine[ j ];
+              volume += volumes_[ j ];
+            }
+            coarse[ i ] = value / volume;
+          } );
+      }
+
+      const Mesh &fine () const { return *fine_; }
+      const Mesh &coarse () const { return *fine_->father(); }
+
+    private:
+      std::shared_ptr< const Mesh > fine_;
+      std::vector< ct > volumes_;
+    };
+
+  } // namespace __PolygonGrid
+
+} // namespace Dune
+
+#endif // #ifndef DUNE_POLYGONGRID_REFINEMENT_HH
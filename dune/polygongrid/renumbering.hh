@@ -0,0 +1,193 @@
+#ifndef DUNE_POLYGONGRID_RENUMBERING_HH
+#define DUNE_POLYGONGRID_RENUMBERING_HH
+
+#include <cassert>
+#include <cstddef>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include <dune/polygongrid/mesh.hh>
+#include <dune/polygongrid/multivector.hh>
+#include <dune/polygongrid/sparsitypattern.hh>
+
+namespace Dune
+{
+
+  namespace __PolygonGrid
+  {
+
+    namespace __Renumbering
+    {
+
+      // breadthFirstSearch
+      // ------------------
+
+      /**
+       * \brief visit the unvisited nodes connected to root in breadth first order
+       *
+       * The neighbors of each node are visited by increasing degree (the
+       * Cuthill-McKee order). The visited nodes are appended to order and
+       * marked in visited.
+       *
+       * \returns pair of the position of the first node of the last level in
+       *          order and the number of levels
+       */
+      inline std::pair< std::size_t, std::size_t > breadthFirstSearch ( const MultiVector< std::size_t > &pattern, std::size_t root, std::vector< bool > &visited, std::vector< std::size_t > &order )
+      {
+        std::size_t begin = order.size(), lastLevel = begin, numLevels = 0u;
+        order.push_back( root );
+        visited[ root ] = true;
+
+        std::vector< std::size_t > neighbors;
+        while( begin < order.size() )
+        {
+          const std::size_t end = order.size();
+          lastLevel = begin;
+          ++numLevels;
+          for( ; begin < end; ++begin )
+          {
+            neighbors.clear();
+            for( std::size_t j : pattern[ order[ begin ] ] )
+            {
+              if( !visited[ j ] )
+              {
+                visited[ j ] = true;
+                neighbors.push_back( j );
+              }
+            }
+            std::stable_sort( neighbors.begin(), neighbors.end(), [ &pattern ] ( std::size_t a, std::size_t b ) { return (pattern.size( a ) < pattern.size( b )); } );
+            order.insert( order.end(), neighbors.begin(), neighbors.end() );
+          }
+        }
+        return std::make_pair( lastLevel, numLevels );
+      }
+
+
+
+      // pseudoPeripheralNode
+      // --------------------
+
+      /**
+       * \brief find a node of (nearly) maximal eccentricity in the component of root
+       *
+       * Starting from root, the node of minimal degree in the last level of
+       * the level structure is chosen as long as this increases the number of
+       * levels (George and Liu). The visited flags are left untouched.
+       */
+      inline std::size_t pseudoPeripheralNode ( const MultiVector< std::size_t > &pattern, std::size_t root, std::vector< bool > &visited )
+      {
+        std::vector< std::size_t > order;
+        std::size_t numLevels = 0u;
+        while( true )
+        {
+          order.clear();
+          const std::pair< std::size_t, std::size_t > levels = breadthFirstSearch( pattern, root, visited, order );
+          for( std::size_t i : order )
+            visited[ i ] = false;
+          if( levels.second <= numLevels )
+            return root;
+          numLevels = levels.second;
+
+          root = *std::min_element( order.begin() + levels.first, order.end(), [ &pattern ] ( std::size_t a, std::size_t b ) { return (pattern.size( a ) < pattern.size( b )); } );
+        }
+      }
+
+    } // namespace __Renumbering
+
+
+
+    // bandwidth
+    // ---------
+
+    /**
+     * \brief bandwidth of a square sparsity pattern, i.e., max |i - j| over all entries (i, j)
+     *
+     * If a permutation is given, the bandwidth of the permuted pattern,
+     * i.e., max |permutation[ i ] - permutation[ j ]|, is returned.
+     */
+    inline std::size_t bandwidth ( const MultiVector< std::size_t > &pattern, const std::vector< std::size_t > &permutation = {} )
+    {
+      assert( permutation.empty() || (permutation.size() == pattern.size()) );
+      auto p = [ &permutation ] ( std::size_t i ) { return (permutation.empty() ? i : permutation[ i ]); };
+      std::size_t bandwidth = 0u;
+      for( std::size_t i = 0u; i < pattern.size(); ++i )
+      {
+        for( std::size_t j : pattern[ i ] )
+          bandwidth = std::max( bandwidth, std::max( p( i ), p( j ) ) - std::min( p( i ), p( j ) ) );
+      }
+      return bandwidth;
+    }
+
+
+
+    // reverseCuthillMcKee
+    // -------------------
+
+    /**
+     * \brief bandwidth reducing permutation of a symmetric sparsity pattern
+     *
+     * Each connected component is numbered by the Cuthill-McKee algorithm,
+     * starting from a pseudo-peripheral node; the resulting order is then
+     * reversed.
+     *
+     * \returns permutation, i.e., permutation[ i ] is the new index of row i
+     */
+    inline std::vector< std::size_t > reverseCuthillMcKee ( const MultiVector< std::size_t > &pattern )
+    {
+      const std::size_t size = pattern.size();
+
+      // process the components by increasing minimal degree
+      std::vector< std::size_t > roots( size );
+      for( std::size_t i = 0u; i < size; ++i )
+        roots[ i ] = i;
+      std::stable_sort( roots.begin(), roots.end(), [ &pattern ] ( std::size_t a, std::size_t b ) { return (pattern.size( a ) < pattern.size( b )); } );
+
+      std::vector< bool > visited( size, false );
+      std::vector< std::size_t > order;
+      order.reserve( size );
+      for( std::size_t root : roots )
+      {
+        if( !visited[ root ] )
+          __Renumbering::breadthFirstSearch( pattern, __Renumbering::pseudoPeripheralNode( pattern, root, visited ), visited, order );
+      }
+      assert( order.size() == size );
+
+      std::vector< std::size_t > permutation( size );
+      for( std::size_t k = 0u; k < size; ++k )
+        permutation[ order[ k ] ] = size - 1u - k;
+      return permutation;
+    }
+
+    /** \brief bandwidth reducing permutation of the cells of a mesh, based on their coupling across edges */
+    template< class ct >
+    inline std::vector< std::size_t > reverseCuthillMcKee ( const Mesh< ct > &mesh, MeshType type = Primal )
+    {
+      return reverseCuthillMcKee( cellPattern( mesh, type ) );
+    }
+
+
+
+    // permuteRows
+    // -----------
+
+    /** \brief move row i of a multi vector to row permutation[ i ] */
+    template< class T >
+    inline MultiVector< T > permuteRows ( const MultiVector< T > &v, const std::vector< std::size_t > &permutation )
+    {
+      assert( permutation.size() == v.size() );
+      std::vector< std::size_t > counts( v.size() );
+      for( std::size_t i = 0u; i < v.size(); ++i )
+        counts[ permutation[ i ] ] = v.size( i );
+      MultiVector< T > permuted( counts );
+      for( std::size_t i = 0u; i < v.size(); ++i )
+        std::copy( v[ i ].begin(), v[ i ].end(), permuted[ permutation[ i ] ].begin() );
+      return permuted;
+    }
+
+  } // namespace __PolygonGrid
+
+} // namespace Dune
+
+#endif // #ifndef DUNE_POLYGONGRID_RENUMBERING_HH
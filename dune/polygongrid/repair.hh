@@ -0,0 +1,329 @@
+#ifndef DUNE_POLYGONGRID_REPAIR_HH
+#define DUNE_POLYGONGRID_REPAIR_HH
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include <dune/common/fvector.hh>
+
+#include <dune/polygongrid/mesh.hh>
+#include <dune/polygongrid/multivector.hh>
+#include <dune/polygongrid/parallel.hh>
+#include <dune/polygongrid/polygonmoments.hh>
+#include <dune/polygongrid/validation.hh>
+
+namespace Dune
+{
+
+  namespace __PolygonGrid
+  {
+
+    // RepairReport
+    // ------------
+
+    /** \brief changes applied by repairPolygons */
+    struct RepairReport
+    {
+      static constexpr std::size_t invalid = std::numeric_limits< std::size_t >::max();
+
+      /** \brief return true, if the input was modified */
+      bool changed () const noexcept
+      {
+        return (weldedVertices + removedEdges + removedPolygons.size() + splitVertices + removedVertices > 0u);
+      }
+
+      /** \brief number of vertices welded onto a coincident vertex of smaller index */
+      std::size_t weldedVertices = 0u;
+      /** \brief number of edges of zero length removed from the polygons */
+      std::size_t removedEdges = 0u;
+      /** \brief (input) indices of the polygons removed due to zero area */
+      std::vector< std::size_t > removedPolygons;
+      /** \brief number of vertex copies inserted to split non-manifold vertices */
+      std::size_t splitVertices = 0u;
+      /** \brief number of vertices no longer referenced by any polygon */
+      std::size_t removedVertices = 0u;
+
+      /** \brief repaired index of each input vertex (invalid, if removed) */
+      std::vector< std::size_t > vertexMap;
+      /** \brief input index of each repaired vertex (the smallest index of the welded vertices) */
+      std::vector< std::size_t > vertexOrigin;
+    };
+
+    inline std::ostream &operator<< ( std::ostream &out, const RepairReport &report )
+    {
+      out << "welded vertices: " << report.weldedVertices << ", removed edges: " << report.removedEdges
+          << ", removed polygons: " << report.removedPolygons.size() << ", split vertices: " << report.splitVertices
+          << ", removed vertices: " << report.removedVertices << std::endl;
+      return out;
+    }
+
+
+
+    namespace __Repair
+    {
+
+      // weld
+      // ----
+
+      /**
+       * \brief representative of each vertex, i.e., the smallest index among coincident vertices
+       *
+       * Vertices within the tolerance are coincident; chains of such vertices
+       * are welded onto the same representative. A tolerance of 0 welds
+       * vertices with identical positions only.
+       */
+      template< class ct >
+      inline std::vector< std::size_t > weld ( const std::vector< FieldVector< ct, 2 > > &vertices, double tolerance )
+      {
+        const std::size_t size = vertices.size();
+        std::vector< std::size_t > representative( size );
+        if( tolerance > 0.0 )
+        {
+          const __Validation::SpatialHash< ct > hash( vertices, tolerance );
+          parallelFor( 0u, size, [ &hash, &representative, tolerance ] ( std::size_t i ) {
+              std::size_t candidate = i;
+              hash.forEachNeighbor( i, tolerance, [ &candidate ] ( std::size_t j ) { candidate = std::min( candidate, j ); } );
+              representative[ i ] = candidate;
+            } );
+        }
+        else
+        {
+          std::vector< std::size_t > order( size );
+          std::iota( order.begin(), order.end(), 0u );
+          std::stable_sort( order.begin(), order.end(), [ &vertices ] ( std::size_t a, std::size_t b ) {
+              return std::make_pair( vertices[ a ][ 0 ], vertices[ a ][ 1 ] ) < std::make_pair( vertices[ b ][ 0 ], vertices[ b ][ 1 ] );
+            } );
+          for( std::size_t k = 0u; k < size; ++k )
+            representative[ order[ k ] ] = ((k > 0u) && (vertices[ order[ k ] ] == vertices[ order[ k-1u ] ]) ? representative[ order[ k-1u ] ] : order[ k ]);
+        }
+
+        // candidates have smaller indices, so their representatives are final
+        for( std::size_t i = 0u; i < size; ++i )
+          representative[ i ] = representative[ representative[ i ] ];
+        return representative;
+      }
+
+
+
+      // fans
+      // ----
+
+      /**
+       * \brief decompose the polygons around a vertex into fans
+       *
+       * Two polygons around the vertex belong to the same fan, if they share
+       * an edge emanating from the vertex and no other polygon uses this
+       * edge.
+       *
+       * \returns number of fans; fan[ k ] is the fan of incidence k
+       */
+      inline std::size_t fans ( const MultiVector< std::size_t > &polygons, const MultiVector< IndexPair >::const_reference &incidence, std::vector< std::size_t > &fan )
+      {
+        const std::size_t n = incidence.size();
+        std::vector< std::pair< std::size_t, std::size_t > > wedges( n );
+        for( std::size_t k = 0u; k < n; ++k )
+        {
+          const IndexPair p = incidence[ k ];
+          const std::size_t size = polygons.size( p.first );
+          wedges[ k ] = std::make_pair( polygons[ p.first ][ (p.second + size - 1u) % size ], polygons[ p.first ][ (p.second + 1u) % size ] );
+        }
+
+        fan.resize( n );
+        std::iota( fan.begin(), fan.end(), 0u );
+        auto find = [ &fan ] ( std::size_t k ) {
+            while( fan[ k ] != k )
+              k = fan[ k ] = fan[ fan[ k ] ];
+            return k;
+          };
+
+        for( std::size_t k = 0u; k < n; ++k )
+        {
+          std::size_t successor = n, numSuccessors = 0u, numPredecessors = 0u;
+          for( std::size_t l = 0u; l < n; ++l )
+          {
+            if( wedges[ l ].first == wedges[ k ].second )
+            {
+              successor = l;
+              ++numSuccessors;
+            }
+            numPredecessors += (wedges[ l ].second == wedges[ k ].second ? 1u : 0u);
+          }
+          if( (numSuccessors == 1u) && (numPredecessors == 1u) )
+          {
+            const std::size_t a = find( k ), b = find( successor );
+            fan[ std::max( a, b ) ] = std::min( a, b );
+          }
+        }
+
+        // number the fans by their first incidence
+        std::vector< std::size_t > number( n, n );
+        std::size_t numFans = 0u;
+        for( std::size_t k = 0u; k < n; ++k )
+        {
+          const std::size_t root = find( k );
+          if( number[ root ] == n )
+            number[ root ] = numFans++;
+          fan[ k ] = root;
+        }
+        for( std::size_t k = 0u; k < n; ++k )
+          fan[ k ] = number[ fan[ k ] ];
+        return numFans;
+      }
+
+    } // namespace __Repair
+
+
+
+    // repairPolygons
+    // --------------
+
+    /**
+     * \brief repair degenerate and non-manifold polygonal input
+     *
+     * The following steps are applied (each in parallel, where possible):
+     * - coincident vertices (within the tolerance) are welded, using a
+     *   spatial hash,
+     * - edges of zero length, i.e., repeated consecutive corners, are
+     *   removed from the polygons,
+     * - polygons with less than 3 corners or zero area (up to a sliver of
+     *   width tolerance) are removed,
+     * - non-manifold vertices, i.e., vertices joining multiple fans of
+     *   polygons, are split into one vertex per fan,
+     * - vertices no longer referenced are removed.
+     *
+     * \param      vertices   positions of the vertices (modified)
+     * \param      polygons   polygons in terms of the vertex indices (modified)
+     * \param[in]  tolerance  distance below which vertices are coincident
+     *
+     * \returns report of the applied changes, including the vertex renumbering
+     */
+    template< class ct >
+    inline RepairReport repairPolygons ( std::vector< FieldVector< ct, 2 > > &vertices, MultiVector< std::size_t > &polygons, double tolerance = 0.0 )
+    {
+      RepairReport report;
+
+      const std::vector< std::size_t > representative = __Repair::weld( vertices, tolerance );
+      for( std::size_t i = 0u; i < representative.size(); ++i )
+        report.weldedVertices += (representative[ i ] != i ? 1u : 0u);
+
+      // remove repeated consecutive corners and polygons of zero area
+      std::vector< std::size_t > counts( polygons.size(), 0u );
+      std::vector< char > keep( polygons.size() );
+      parallelFor( 0u, polygons.size(), [ &vertices, &polygons, &representative, &counts, &keep, tolerance ] ( std::size_t i ) {
+          const std::size_t n = polygons.size( i );
+          auto corner = [ &polygons, &representative, i ] ( std::size_t j ) { return representative[ polygons[ i ][ j ] ]; };
+          for( std::size_t j = 0u; j < n; ++j )
+            counts[ i ] += (corner( j ) != corner( (j+1u) % n ) ? 1u : 0u);
+
+          keep[ i ] = 0;
+          if( counts[ i ] < 3u )
+            return;
+          AccumulationType< ct > perimeter( 0 );
+          for( std::size_t j = 0u; j < n; ++j )
+            perimeter += (vertices[ corner( (j+1u) % n ) ] - vertices[ corner( j ) ]).two_norm();
+          const ct volume = polygonMoments( n, [ &vertices, &corner ] ( std::size_t j ) { return vertices[ corner( j ) ]; } ).volume();
+          keep[ i ] = (std::abs( volume ) > tolerance*perimeter / 2 ? 1 : 0);
+        } );
+
+      std::vector< std::size_t > keptCounts;
+      for( std::size_t i = 0u; i < polygons.size(); ++i )
+      {
+        report.removedEdges += polygons.size( i ) - counts[ i ];
+        if( keep[ i ] )
+          keptCounts.push_back( counts[ i ] );
+        else
+          report.removedPolygons.push_back( i );
+      }
+
+      MultiVector< std::size_t > cleaned( keptCounts );
+      {
+        std::vector< std::size_t > kept;
+        kept.reserve( keptCounts.size() );
+        for( std::size_t i = 0u; i < polygons.size(); ++i )
+          if( keep[ i ] )
+            kept.push_back( i );
+        parallelFor( 0u, kept.size(), [ &polygons, &representative, &kept, &cleaned ] ( std::size_t k ) {
+            const auto polygon = polygons[ kept[ k ] ];
+            const std::size_t n = polygon.size();
+            auto corners = cleaned[ k ].begin();
+            for( std::size_t j = 0u; j < n; ++j )
+            {
+              if( representative[ polygon[ j ] ] != representative[ polygon[ (j+1u) % n ] ] )
+                *corners++ = representative[ polygon[ j ] ];
+            }
+          } );
+      }
+
+      // split non-manifold vertices into one vertex per fan
+      const MultiVector< IndexPair > incidence = __Validation::vertexPolygons( vertices.size(), cleaned );
+      std::vector< std::size_t > numFans( vertices.size() );
+      MultiVector< std::size_t > fan( incidence.offsets(), std::vector< std::size_t >( incidence.values().size() ) );
+      parallelFor( 0u, vertices.size(), [ &cleaned, &incidence, &numFans, &fan ] ( std::size_t v ) {
+          std::vector< std::size_t > f;
+          numFans[ v ] = __Repair::fans( cleaned, incidence[ v ], f );
+          std::copy( f.begin(), f.end(), fan[ v ].begin() );
+        } );
+
+      std::vector< std::size_t > firstCopy( vertices.size() );
+      std::size_t numNodes = vertices.size();
+      for( std::size_t v = 0u; v < vertices.size(); ++v )
+      {
+        firstCopy[ v ] = numNodes;
+        numNodes += std::max( numFans[ v ], std::size_t( 1u ) ) - 1u;
+      }
+      report.splitVertices = numNodes - vertices.size();
+      parallelFor( 0u, vertices.size(), [ &cleaned, &incidence, &fan, &firstCopy ] ( std::size_t v ) {
+          for( std::size_t k = 0u; k < incidence.size( v ); ++k )
+          {
+            if( fan[ v ][ k ] > 0u )
+              cleaned[ incidence[ v ][ k ].first ][ incidence[ v ][ k ].second ] = firstCopy[ v ] + fan[ v ][ k ] - 1u;
+          }
+        } );
+
+      // renumber the referenced vertices (copies keep the input index of their vertex)
+      std::vector< std::size_t > origin( numNodes );
+      std::iota( origin.begin(), origin.begin() + vertices.size(), 0u );
+      for( std::size_t v = 0u; v < vertices.size(); ++v )
+        std::fill( origin.begin() + firstCopy[ v ], origin.begin() + firstCopy[ v ] + std::max( numFans[ v ], std::size_t( 1u ) ) - 1u, v );
+
+      std::vector< std::size_t > index( numNodes, RepairReport::invalid );
+      for( std::size_t v : cleaned.values() )
+        index[ v ] = 0u;
+      std::size_t numVertices = 0u;
+      for( std::size_t &i : index )
+        i = (i == 0u ? numVertices++ : RepairReport::invalid);
+      report.removedVertices = vertices.size() + report.splitVertices - report.weldedVertices - numVertices;
+      for( std::size_t &v : cleaned.values() )
+        v = index[ v ];
+
+      std::vector< FieldVector< ct, 2 > > repaired( numVertices );
+      report.vertexOrigin.resize( numVertices );
+      for( std::size_t v = 0u; v < numNodes; ++v )
+      {
+        if( index[ v ] == RepairReport::invalid )
+          continue;
+        repaired[ index[ v ] ] = vertices[ origin[ v ] ];
+        report.vertexOrigin[ index[ v ] ] = origin[ v ];
+      }
+      report.vertexMap.resize( vertices.size() );
+      for( std::size_t i = 0u; i < vertices.size(); ++i )
+        report.vertexMap[ i ] = index[ representative[ i ] ];
+
+      vertices = std::move( repaired );
+      polygons = std::move( cleaned );
+      return report;
+    }
+
+  } // namespace __PolygonGrid
+
+} // namespace Dune
+
+#endif // #ifndef DUNE_POLYGONGRID_REPAIR_HH
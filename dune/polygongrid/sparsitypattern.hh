@@ -0,0 +1,248 @@
+#ifndef DUNE_POLYGONGRID_SPARSITYPATTERN_HH
+#define DUNE_POLYGONGRID_SPARSITYPATTERN_HH
+
+#include <cstddef>
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+#include <dune/polygongrid/mesh.hh>
+#include <dune/polygongrid/multivector.hh>
+#include <dune/polygongrid/parallel.hh>
+
+namespace Dune
+{
+
+  namespace __PolygonGrid
+  {
+
+    namespace __SparsityPattern
+    {
+
+      // buildPattern
+      // ------------
+
+      /**
+       * \brief assemble a CSR pattern from a row generator
+       *
+       * The function row( i, columns ) appends the (possibly duplicate)
+       * column indices of row i. Each row is evaluated twice: once to count
+       * and once to fill the pattern, so no intermediate storage
+       * proportional to the number of nonzeros is required.
+       */
+      template< class Row >
+      inline MultiVector< std::size_t > buildPattern ( std::size_t numRows, Row row )
+      {
+        auto columns = [ &row ] ( std::size_t i, std::vector< std::size_t > &columns ) {
+          columns.clear();
+          row( i, columns );
+          std::sort( columns.begin(), columns.end() );
+          columns.erase( std::unique( columns.begin(), columns.end() ), columns.end() );
+        };
+
+        std::vector< std::size_t > counts( numRows );
+        parallelFor( 0u, numRows, [ &columns, &counts ] ( std::size_t i ) {
+            thread_local std::vector< std::size_t > buffer;
+            columns( i, buffer );
+            counts[ i ] = buffer.size();
+          } );
+
+        MultiVector< std::size_t > pattern( counts );
+        parallelFor( 0u, numRows, [ &columns, &pattern ] ( std::size_t i ) {
+            thread_local std::vector< std::size_t > buffer;
+            columns( i, buffer );
+            pattern[ i ].assign( buffer.begin(), buffer.end() );
+          } );
+        return pattern;
+      }
+
+
+
+      // nodePattern
+      // -----------
+
+      /**
+       * \brief pattern of the first numRows nodes of a type and their neighbors
+       *
+       * Two nodes are neighbors if they are connected by an edge of the
+       * corresponding mesh. The half edges of a node's row directly point to
+       * its neighbors, i.e., no search is required. Non-regular neighbors are
+       * skipped if requested.
+       */
+      template< class ct >
+      inline MultiVector< std::size_t > nodePattern ( const Mesh< ct > &mesh, MeshType type, std::size_t numRows, bool regularOnly )
+      {
+        return buildPattern( numRows, [ &mesh, type, regularOnly ] ( std::size_t i, std::vector< std::size_t > &columns ) {
+            const NodeIndex node( i, type );
+            columns.push_back( i );
+            for( HalfEdgeIndex h = mesh.begin( node ); h != mesh.end( node ); ++h )
+            {
+              const NodeIndex nb = mesh.target( mesh.dual( h ) );
+              if( !regularOnly || mesh.regular( nb ) )
+                columns.push_back( nb );
+            }
+          } );
+      }
+
+    } // namespace __SparsityPattern
+
+
+
+    // squarePattern
+    // -------------
+
+    /**
+     * \brief pattern of the product of a square matrix with itself
+     *
+     * Applied to a first neighbor pattern, this yields the pattern
+     * including the second neighbors.
+     */
+    inline MultiVector< std::size_t > squarePattern ( const MultiVector< std::size_t > &pattern )
+    {
+      return __SparsityPattern::buildPattern( pattern.size(), [ &pattern ] ( std::size_t i, std::vector< std::size_t > &columns ) {
+          for( std::size_t j : pattern[ i ] )
+            columns.insert( columns.end(), pattern[ j ].begin(), pattern[ j ].end() );
+        } );
+    }
+
+
+
+    // cellPattern
+    // -----------
+
+    /**
+     * \brief sparsity pattern of cell-cell coupling across edges
+     *
+     * The pattern is returned in compressed row storage, i.e., the row
+     * offsets and column indices are available via offsets() and values().
+     * Rows and columns refer to the cell indices of the given mesh type;
+     * each row is sorted and contains the diagonal entry.
+     *
+     * \param[in]  mesh             mesh
+     * \param[in]  type             type of the cells (primal or dual)
+     * \param[in]  secondNeighbors  also couple neighbors of neighbors
+     */
+    template< class ct >
+    inline MultiVector< std::size_t > cellPattern ( const Mesh< ct > &mesh, MeshType type, bool secondNeighbors = false )
+    {
+      MultiVector< std::size_t > pattern = __SparsityPattern::nodePattern( mesh, dual( type ), mesh.numCells( type ), true );
+      return (secondNeighbors ? squarePattern( pattern ) : pattern);
+    }
+
+    /**
+     * \brief sparsity pattern of polygon-polygon coupling across shared edges
+     *
+     * The pattern is computed directly from the polygons, i.e., without
+     * building a mesh. For polygons describing a valid mesh, it coincides
+     * with the primal cell pattern of that mesh.
+     *
+     * \param[in]  polygons     vertices of each polygon
+     * \param[in]  numVertices  number of vertices referenced by the polygons
+     */
+    inline MultiVector< std::size_t > cellPattern ( const MultiVector< std::size_t > &polygons, std::size_t numVertices )
+    {
+      // polygons containing each vertex
+      std::vector< std::size_t > counts( numVertices, 0u );
+      for( std::size_t v : polygons.values() )
+        ++counts[ v ];
+      MultiVector< std::size_t > star( counts );
+      std::fill( counts.begin(), counts.end(), 0u );
+      for( std::size_t i = 0u; i < polygons.size(); ++i )
+        for( std::size_t v : polygons[ i ] )
+          star[ v ][ counts[ v ]++ ] = i;
+
+      return __SparsityPattern::buildPattern( polygons.size(), [ &polygons, &star ] ( std::size_t i, std::vector< std::size_t > &columns ) {
+          columns.push_back( i );
+          const auto polygon = polygons[ i ];
+          const std::size_t n = polygon.size();
+          for( std::size_t k = 0u; k < n; ++k )
+          {
+            const std::size_t a = polygon[ k ], b = polygon[ (k+1) % n ];
+            for( std::size_t j : star[ a ] )
+            {
+              // j shares the edge, if it contains b next to a
+              const auto other = polygons[ j ];
+              const std::size_t m = other.size();
+              for( std::size_t l = 0u; (j != i) && (l < m); ++l )
+              {
+                if( (other[ l ] == b) && ((other[ (l+1) % m ] == a) || (other[ (l+m-1) % m ] == a)) )
+                {
+                  columns.push_back( j );
+                  break;
+                }
+              }
+            }
+          }
+        } );
+    }
+
+
+
+    // vertexPattern
+    // -------------
+
+    /**
+     * \brief sparsity pattern of vertex-vertex coupling along edges
+     *
+     * \note For the dual mesh, the boundary nodes are vertices, too.
+     *
+     * \param[in]  mesh             mesh
+     * \param[in]  type             type of the vertices (primal or dual)
+     * \param[in]  secondNeighbors  also couple neighbors of neighbors
+     */
+    template< class ct >
+    inline MultiVector< std::size_t > vertexPattern ( const Mesh< ct > &mesh, MeshType type, bool secondNeighbors = false )
+    {
+      MultiVector< std::size_t > pattern = __SparsityPattern::nodePattern( mesh, type, mesh.numVertices( type ), type == Primal );
+      return (secondNeighbors ? squarePattern( pattern ) : pattern);
+    }
+
+
+
+    // edgePattern
+    // -----------
+
+    /**
+     * \brief sparsity pattern of edge-edge coupling within cells
+     *
+     * Two edges are coupled if they belong to a common cell, as required
+     * by face based discretizations.
+     *
+     * \param[in]  mesh             mesh
+     * \param[in]  type             type of the edges (primal or dual)
+     * \param[in]  secondNeighbors  also couple neighbors of neighbors
+     */
+    template< class ct >
+    inline MultiVector< std::size_t > edgePattern ( const Mesh< ct > &mesh, MeshType type, bool secondNeighbors = false )
+    {
+      // find the cells adjacent to each edge
+      const std::size_t numEdges = mesh.numEdges( type );
+      std::vector< std::array< NodeIndex, 2 > > edgeCells( numEdges );
+      parallelFor( 0u, mesh.numCells( type ), [ &mesh, &edgeCells, type ] ( std::size_t i ) {
+          const NodeIndex cell( i, dual( type ) );
+          for( HalfEdgeIndex h = mesh.begin( cell ); h != mesh.end( cell ); ++h )
+          {
+            // the half edge with the smaller index is responsible for the edge
+            if( h < mesh.flip( h ) )
+              edgeCells[ mesh.edgeIndex( h ) ] = {{ cell, mesh.target( mesh.dual( h ) ) }};
+          }
+        } );
+
+      MultiVector< std::size_t > pattern = __SparsityPattern::buildPattern( numEdges, [ &mesh, &edgeCells ] ( std::size_t e, std::vector< std::size_t > &columns ) {
+          for( NodeIndex cell : edgeCells[ e ] )
+          {
+            if( !mesh.regular( cell ) )
+              continue;
+            for( HalfEdgeIndex h = mesh.begin( cell ); h != mesh.end( cell ); ++h )
+              columns.push_back( mesh.edgeIndex( h ) );
+          }
+        } );
+      return (secondNeighbors ? squarePattern( pattern ) : pattern);
+    }
+
+  } // namespace __PolygonGrid
+
+} // namespace Dune
+
+#endif // #ifndef DUNE_POLYGONGRID_SPARSITYPATTERN_HH
@@ -0,0 +1,264 @@
+#ifndef DUNE_POLYGONGRID_TRANSFER_HH
+#define DUNE_POLYGONGRID_TRANSFER_HH
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+
+#include <algorithm>
+#include <vector>
+
+#include <dune/polygongrid/mesh.hh>
+#include <dune/polygongrid/parallel.hh>
+
+namespace Dune
+{
+
+  namespace __PolygonGrid
+  {
+
+    // TransferOperator
+    // ----------------
+
+    /**
+     * \brief weighted averaging between the cells and vertices of a grid
+     *
+     * For each pair of a cell c and one of its corners v, a weight w( c, v )
+     * is computed once, either the area of the part of c closest to v (the
+     * quadrilateral spanned by the cell center, the adjacent edge midpoints
+     * and v) or the inverse distance between the cell center and v.
+     * Normalizing these weights over the cells around a vertex yields the
+     * averaging A from cells to vertices, normalizing them over the corners
+     * of a cell yields the averaging B from vertices to cells.
+     *
+     * All operators gather along the CSR structure of the mesh, so each
+     * output value is written exactly once and the loops run in parallel.
+     * The weights are stored in the layout of both the cells and the
+     * vertices, such that the adjoints can be applied in the same way.
+     *
+     * Cells are given by the cells of the grid of given type, i.e., primal
+     * cells are the vertices of the dual grid. In either case, the cell
+     * centers are dual positions, so the dual data of the mesh must have
+     * been built (see Mesh::buildDual).
+     */
+    template< class ct >
+    class TransferOperator
+    {
+      typedef TransferOperator< ct > This;
+
+    public:
+      typedef __PolygonGrid::Mesh< ct > Mesh;
+
+      enum Weighting { Area, InverseDistance };
+
+      explicit TransferOperator ( const Mesh &mesh, MeshType type = Primal, Weighting weighting = Area );
+
+      /** \brief vertexValues = A cellValues */
+      template< class T >
+      void cellToVertex ( const T *cellValues, T *vertexValues ) const
+      {
+        gather( vertices(), numVertices(), vertexLayout_[ A ], cellValues, vertexValues );
+      }
+
+      /** \brief cellValues = B vertexValues */
+      template< class T >
+      void vertexToCell ( const T *vertexValues, T *cellValues ) const
+      {
+        gather( cells(), numCells(), cellLayout_[ B ], vertexValues, cellValues );
+      }
+
+      /** \brief cellValues = A^T vertexValues */
+      template< class T >
+      void cellToVertexAdjoint ( const T *vertexValues, T *cellValues ) const
+      {
+        gather( cells(), numCells(), cellLayout_[ A ], vertexValues, cellValues );
+      }
+
+      /** \brief vertexValues = B^T cellValues */
+      template< class T >
+      void vertexToCellAdjoint ( const T *cellValues, T *vertexValues ) const
+      {
+        gather( vertices(), numVertices(), vertexLayout_[ B ], cellValues, vertexValues );
+      }
+
+      template< class X, class Y >
+      void cellToVertex ( const X &cellValues, Y &vertexValues ) const
+      {
+        assert( (cellValues.size() == numCells()) && (vertexValues.size() == numVertices()) );
+        cellToVertex( cellValues.data(), vertexValues.data() );
+      }
+
+      template< class X, class Y >
+      void vertexToCell ( const X &vertexValues, Y &cellValues ) const
+      {
+        assert( (vertexValues.size() == numVertices()) && (cellValues.size() == numCells()) );
+        vertexToCell( vertexValues.data(), cellValues.data() );
+      }
+
+      template< class X, class Y >
+      void cellToVertexAdjoint ( const X &vertexValues, Y &cellValues ) const
+      {
+        assert( (vertexValues.size() == numVertices()) && (cellValues.size() == numCells()) );
+        cellToVertexAdjoint( vertexValues.data(), cellValues.data() );
+      }
+
+      template< class X, class Y >
+      void vertexToCellAdjoint ( const X &cellValues, Y &vertexValues ) const
+      {
+        assert( (cellValues.size() == numCells()) && (vertexValues.size() == numVertices()) );
+        vertexToCellAdjoint( cellValues.data(), vertexValues.data() );
+      }
+
+      const Mesh &mesh () const noexcept { return mesh_; }
+      MeshType type () const noexcept { return type_; }
+
+      std::size_t numCells () const noexcept { return mesh().numCells( type() ); }
+      std::size_t numVertices () const noexcept { return mesh().numVertices( type() ); }
+
+    private:
+      enum Operator { A = 0, B = 1 };
+
+      const MultiVector< IndexPair > &cells () const noexcept { return mesh().nodes( dual( type() ) ); }
+      const MultiVector< IndexPair > &vertices () const noexcept { return mesh().nodes( type() ); }
+
+      // output[ i ] = sum of weights[ k ] * input[ values[ k ].first ] over row i; entries with zero weight (e.g., boundary nodes) are skipped
+      template< class T >
+      void gather ( const MultiVector< IndexPair > &rows, std::size_t numRows, const std::vector< ct > &weights, const T *input, T *output ) const
+      {
+        parallelFor( 0u, numRows, [ &rows, &weights, input, output ] ( std::size_t i ) {
+            T value( 0 );
+            for( std::size_t k = rows.begin_of( i ); k < rows.end_of( i ); ++k )
+            {
+              if( weights[ k ] != ct( 0 ) )
+                value += weights[ k ] * input[ rows.values()[ k ].first ];
+            }
+            output[ i ] = value;
+          } );
+      }
+
+      /**
+       * \brief normalize the weights [begin, end) of the entries satisfying valid
+       *
+       * Infinite weights (a vertex located at the cell center) take over the
+       * row; if all weights vanish (e.g., degenerate areas), equal weights
+       * are used instead.
+       */
+      template< class Valid >
+      static void normalize ( std::vector< ct > &weights, std::size_t begin, std::size_t end, Valid valid )
+      {
+        const bool infinite = std::any_of( weights.begin() + begin, weights.begin() + end, [] ( ct w ) { return std::isinf( w ); } );
+        ct sum( 0 );
+        std::size_t count = 0u;
+        for( std::size_t k = begin; k < end; ++k )
+        {
+          if( !valid( k ) )
+            continue;
+          if( infinite )
+            weights[ k ] = ct( std::isinf( weights[ k ] ) ? 1 : 0 );
+          sum += weights[ k ];
+          ++count;
+        }
+        for( std::size_t k = begin; k < end; ++k )
+        {
+          if( !valid( k ) )
+            weights[ k ] = ct( 0 );
+          else if( sum == ct( 0 ) )
+            weights[ k ] = ct( 1 ) / ct( count );
+          else
+            weights[ k ] /= sum;
+        }
+      }
+
+      const Mesh &mesh_;
+      MeshType type_;
+      std::vector< ct > cellLayout_[ 2 ], vertexLayout_[ 2 ];
+    };
+
+
+
+    // Implementation of TransferOperator
+    // ----------------------------------
+
+    template< class ct >
+    inline TransferOperator< ct >::TransferOperator ( const Mesh &mesh, MeshType type, Weighting weighting )
+      : mesh_( mesh ), type_( type )
+    {
+      typedef typename Mesh::GlobalCoordinate GlobalCoordinate;
+
+      assert( mesh.dualBuilt() );
+
+      const MultiVector< IndexPair > &cells = this->cells();
+      const MultiVector< IndexPair > &vertices = this->vertices();
+      const std::size_t numCells = this->numCells();
+
+      // raw weight for each corner of each cell
+      std::vector< ct > &weights = cellLayout_[ B ];
+      weights.resize( cells.values().size(), ct( 0 ) );
+      parallelFor( 0u, numCells, [ &mesh, &cells, &weights, type, weighting ] ( std::size_t c ) {
+          const GlobalCoordinate &center = mesh.position( NodeIndex( c, dual( type ) ) );
+          const std::size_t begin = cells.begin_of( c ), end = cells.end_of( c );
+          for( std::size_t k = begin; k < end; ++k )
+          {
+            const GlobalCoordinate x = mesh.position( HalfEdgeIndex( k, type ) );
+            if( weighting == Area )
+            {
+              GlobalCoordinate a = mesh.position( HalfEdgeIndex( (k > begin ? k : end) - 1u, type ) );
+              GlobalCoordinate b = mesh.position( HalfEdgeIndex( (k+1u < end ? k+1u : begin), type ) );
+              a += x; a *= ct( 1 ) / ct( 2 ); a -= center;
+              b += x; b *= ct( 1 ) / ct( 2 ); b -= center;
+              const GlobalCoordinate y = x - center;
+              // area of the quadrilateral (center, a, x, b), split along the diagonal to x
+              weights[ k ] = (a[ 0 ]*y[ 1 ] - a[ 1 ]*y[ 0 ] + y[ 0 ]*b[ 1 ] - y[ 1 ]*b[ 0 ]) / ct( 2 );
+            }
+            else
+              weights[ k ] = ct( 1 ) / (x - center).two_norm();
+          }
+        } );
+
+      // copy raw weights into the vertex layout; the cell corner corresponding to entry (c, p) of a vertex row is the predecessor of position p in cell c
+      std::vector< ct > &vertexWeights = vertexLayout_[ A ];
+      std::vector< std::size_t > corners( vertices.values().size(), cells.values().size() );
+      vertexWeights.resize( vertices.values().size(), ct( 0 ) );
+      parallelFor( 0u, numVertices(), [ &cells, &vertices, &weights, &vertexWeights, &corners, numCells ] ( std::size_t v ) {
+          for( std::size_t j = vertices.begin_of( v ); j < vertices.end_of( v ); ++j )
+          {
+            const IndexPair &p = vertices.values()[ j ];
+            if( p.first >= numCells )
+              continue;
+            const std::size_t k = cells.position_of( p );
+            corners[ j ] = (k > cells.begin_of( p.first ) ? k : cells.end_of( p.first )) - 1u;
+            assert( cells.values()[ corners[ j ] ].first == v );
+            vertexWeights[ j ] = weights[ corners[ j ] ];
+          }
+          normalize( vertexWeights, vertices.begin_of( v ), vertices.end_of( v ), [ &corners, &cells ] ( std::size_t j ) { return (corners[ j ] < cells.values().size()); } );
+        } );
+
+      // A in cell layout; afterwards, normalize raw weights over the cell corners to obtain B
+      cellLayout_[ A ].resize( cells.values().size(), ct( 0 ) );
+      parallelFor( 0u, numVertices(), [ this, &vertices, &vertexWeights, &corners ] ( std::size_t v ) {
+          for( std::size_t j = vertices.begin_of( v ); j < vertices.end_of( v ); ++j )
+          {
+            if( corners[ j ] < cellLayout_[ A ].size() )
+              cellLayout_[ A ][ corners[ j ] ] = vertexWeights[ j ];
+          }
+        } );
+      parallelFor( 0u, numCells, [ &cells, &weights ] ( std::size_t c ) {
+          normalize( weights, cells.begin_of( c ), cells.end_of( c ), [] ( std::size_t ) { return true; } );
+        } );
+
+      // B in vertex layout
+      vertexLayout_[ B ].resize( vertices.values().size(), ct( 0 ) );
+      parallelFor( 0u, numVertices(), [ this, &vertices, &weights, &corners ] ( std::size_t v ) {
+          for( std::size_t j = vertices.begin_of( v ); j < vertices.end_of( v ); ++j )
+          {
+            if( corners[ j ] < weights.size() )
+              vertexLayout_[ B ][ j ] = weights[ corners[ j ] ];
+          }
+        } );
+    }
+
+  } // namespace __PolygonGrid
+
+} // namespace Dune
+
+#endif // #ifndef DUNE_POLYGONGRID_TRANSFER_HH
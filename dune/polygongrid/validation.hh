@@ -0,0 +1,534 @@
+#ifndef DUNE_POLYGONGRID_VALIDATION_HH
+#define DUNE_POLYGONGRID_VALIDATION_HH
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+
+#include <algorithm>
+#include <array>
+#include <iostream>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include <dune/common/fvector.hh>
+
+#include <dune/polygongrid/mesh.hh>
+#include <dune/polygongrid/multivector.hh>
+#include <dune/polygongrid/parallel.hh>
+#include <dune/polygongrid/polygonmoments.hh>
+
+namespace Dune
+{
+
+  namespace __PolygonGrid
+  {
+
+    // ValidationOptions
+    // -----------------
+
+    struct ValidationOptions
+    {
+      /** \brief vertices closer than this distance are considered duplicates (0: identical positions only) */
+      double tolerance = 0.0;
+      /** \brief maximum number of offenders recorded per check */
+      std::size_t maxOffenders = 10u;
+    };
+
+
+
+    // ValidationReport
+    // ----------------
+
+    /**
+     * \brief result of validating a polygonal mesh
+     *
+     * For each check, the number of offending entities and the (smallest)
+     * indices of the first offenders are recorded. Offenders are
+     * - nodes of the respective mesh structure for the half edge cycles,
+     * - polygons (primal cells) for degenerate polygons, orientation and
+     *   self-intersection,
+     * - vertices for duplicate and non-manifold vertices; a duplicate is
+     *   reported if a vertex with smaller index lies within the tolerance.
+     *
+     * Polygons referencing nonexistent vertices are reported as degenerate.
+     */
+    struct ValidationReport
+    {
+      enum Check { PrimalHalfEdgeCycles, DualHalfEdgeCycles, DegeneratePolygons, Orientation, SelfIntersections, DuplicateVertices, NonManifoldVertices };
+
+      static const std::size_t numChecks = 7u;
+
+      struct Result
+      {
+        std::size_t count = 0u;
+        std::vector< std::size_t > offenders;
+      };
+
+      static const char *name ( Check check ) noexcept
+      {
+        static const char *names[ numChecks ] = { "primal half edge cycles", "dual half edge cycles", "degenerate polygons", "orientation", "self-intersections", "duplicate vertices", "non-manifold vertices" };
+        return names[ check ];
+      }
+
+      const Result &operator[] ( Check check ) const noexcept { return results[ check ]; }
+      Result &operator[] ( Check check ) noexcept { return results[ check ]; }
+
+      /** \brief return true, if no check found any offender */
+      bool valid () const noexcept
+      {
+        return std::all_of( results.begin(), results.end(), [] ( const Result &result ) { return (result.count == 0u); } );
+      }
+
+      std::array< Result, numChecks > results;
+    };
+
+    inline std::ostream &operator<< ( std::ostream &out, const ValidationReport &report )
+    {
+      for( std::size_t i = 0u; i < ValidationReport::numChecks; ++i )
+      {
+        const ValidationReport::Check check = static_cast< ValidationReport::Check >( i );
+        out << ValidationReport::name( check ) << ": " << report[ check ].count;
+        if( !report[ check ].offenders.empty() )
+        {
+          out << " (";
+          for( std::size_t j = 0u; j < report[ check ].offenders.size(); ++j )
+            out << (j > 0u ? ", " : "") << report[ check ].offenders[ j ];
+          out << (report[ check ].offenders.size() < report[ check ].count ? ", ...)" : ")");
+        }
+        out << std::endl;
+      }
+      return out;
+    }
+
+
+
+    namespace __Validation
+    {
+
+      // collect
+      // -------
+
+      /** \brief evaluate offending( i ) for all i in [0, size) in parallel and record the result */
+      template< class Offending >
+      inline ValidationReport::Result collect ( std::size_t size, Offending offending, std::size_t maxOffenders )
+      {
+        // std::vector< bool > may not be written concurrently
+        std::vector< char > flags( size );
+        parallelFor( 0u, size, [ &offending, &flags ] ( std::size_t i ) { flags[ i ] = (offending( i ) ? 1 : 0); } );
+
+        ValidationReport::Result result;
+        for( std::size_t i = 0u; i < size; ++i )
+        {
+          if( !flags[ i ] )
+            continue;
+          if( result.count++ < maxOffenders )
+            result.offenders.push_back( i );
+        }
+        return result;
+      }
+
+
+
+      // halfEdgeCycles
+      // --------------
+
+      /** \brief nodes of a type with a half edge that does not return to itself after two flips */
+      inline ValidationReport::Result halfEdgeCycles ( const MultiVector< IndexPair > &primal, const MultiVector< IndexPair > &dual, MeshType type, std::size_t maxOffenders )
+      {
+        const std::array< const MultiVector< IndexPair > *, 2 > nodes = {{ &primal, &dual }};
+        const std::array< MeshType, 4 > types = {{ type, __PolygonGrid::dual( type ), type, __PolygonGrid::dual( type ) }};
+        return collect( nodes[ type ]->size(), [ &nodes, &types, type ] ( std::size_t i ) {
+            for( std::size_t j = 0u; j < nodes[ type ]->size( i ); ++j )
+            {
+              IndexPair p( i, j );
+              for( MeshType t : types )
+              {
+                if( (p.first >= nodes[ t ]->size()) || (p.second >= nodes[ t ]->size( p.first )) )
+                  return true;
+                p = (*nodes[ t ])[ p ];
+              }
+              if( p != IndexPair( i, j ) )
+                return true;
+            }
+            return false;
+          }, maxOffenders );
+      }
+
+
+
+      // degenerate
+      // ----------
+
+      /** \brief a polygon is degenerate, if it has less than three corners or repeats a corner */
+      template< class Polygon >
+      inline bool degenerate ( const Polygon &polygon )
+      {
+        const std::size_t n = polygon.size();
+        if( n < 3u )
+          return true;
+        for( std::size_t j = 0u; j < n; ++j )
+          for( std::size_t k = j+1u; k < n; ++k )
+            if( polygon[ j ] == polygon[ k ] )
+              return true;
+        return false;
+      }
+
+
+
+      // segmentsIntersect
+      // -----------------
+
+      template< class ct >
+      inline int orientation ( const FieldVector< ct, 2 > &a, const FieldVector< ct, 2 > &b, const FieldVector< ct, 2 > &c )
+      {
+        typedef AccumulationType< ct > field_type;
+        const field_type det = (field_type( b[ 0 ] ) - a[ 0 ])*(field_type( c[ 1 ] ) - a[ 1 ]) - (field_type( b[ 1 ] ) - a[ 1 ])*(field_type( c[ 0 ] ) - a[ 0 ]);
+        return (det > 0) - (det < 0);
+      }
+
+      template< class ct >
+      inline bool onSegment ( const FieldVector< ct, 2 > &a, const FieldVector< ct, 2 > &b, const FieldVector< ct, 2 > &c )
+      {
+        return (std::min( a[ 0 ], b[ 0 ] ) <= c[ 0 ]) && (c[ 0 ] <= std::max( a[ 0 ], b[ 0 ] )) && (std::min( a[ 1 ], b[ 1 ] ) <= c[ 1 ]) && (c[ 1 ] <= std::max( a[ 1 ], b[ 1 ] ));
+      }
+
+      /** \brief return true, if the closed segments [a, b] and [c, d] intersect */
+      template< class ct >
+      inline bool segmentsIntersect ( const FieldVector< ct, 2 > &a, const FieldVector< ct, 2 > &b, const FieldVector< ct, 2 > &c, const FieldVector< ct, 2 > &d )
+      {
+        const int o1 = orientation( a, b, c ), o2 = orientation( a, b, d );
+        const int o3 = orientation( c, d, a ), o4 = orientation( c, d, b );
+        if( (o1 != o2) && (o3 != o4) && (o1 != 0 || o2 != 0) )
+          return true;
+        return ((o1 == 0) && onSegment( a, b, c )) || ((o2 == 0) && onSegment( a, b, d )) || ((o3 == 0) && onSegment( c, d, a )) || ((o4 == 0) && onSegment( c, d, b ));
+      }
+
+
+
+      // selfIntersecting
+      // ----------------
+
+      /** \brief return true, if two non-adjacent edges of the polygon given by its n corners intersect */
+      template< class Corner >
+      inline bool selfIntersecting ( std::size_t n, Corner corner )
+      {
+        for( std::size_t j = 0u; j+2u < n; ++j )
+        {
+          // skip the last edge for j = 0, as it is adjacent
+          for( std::size_t k = j+2u; k < (j == 0u ? n-1u : n); ++k )
+          {
+            if( segmentsIntersect( corner( j ), corner( j+1u ), corner( k ), corner( (k+1u) % n ) ) )
+              return true;
+          }
+        }
+        return false;
+      }
+
+
+
+      // SpatialHash
+      // -----------
+
+      /**
+       * \brief spatial hash of points on a uniform grid with a given cell size
+       *
+       * The points are sorted by their (integer) grid cell, so that the
+       * points within a distance of at most the cell size are found by
+       * searching the 3 x 3 neighboring grid cells.
+       */
+      template< class ct >
+      class SpatialHash
+      {
+        typedef std::pair< long long, long long > Key;
+
+      public:
+        typedef FieldVector< ct, 2 > GlobalCoordinate;
+
+        SpatialHash ( const std::vector< GlobalCoordinate > &points, double cellSize )
+          : points_( points ), cellSize_( cellSize ), keys_( points.size() ), order_( points.size() )
+        {
+          assert( cellSize > 0.0 );
+          parallelFor( 0u, points.size(), [ this ] ( std::size_t i ) { keys_[ i ] = key( points_[ i ] ); } );
+          std::iota( order_.begin(), order_.end(), 0u );
+          std::sort( order_.begin(), order_.end(), [ this ] ( std::size_t a, std::size_t b ) { return (keys_[ a ] < keys_[ b ]) || ((keys_[ a ] == keys_[ b ]) && (a < b)); } );
+        }
+
+        /** \brief call f( j ) for all points j within the given distance (at most the cell size) of point i, including i itself */
+        template< class F >
+        void forEachNeighbor ( std::size_t i, double distance, F &&f ) const
+        {
+          assert( distance <= cellSize_ );
+          const Key k = keys_[ i ];
+          for( long long dx = -1; dx <= 1; ++dx )
+            for( long long dy = -1; dy <= 1; ++dy )
+            {
+              const Key n( k.first + dx, k.second + dy );
+              auto range = std::equal_range( order_.begin(), order_.end(), n, Compare{ keys_ } );
+              for( auto it = range.first; it != range.second; ++it )
+              {
+                if( (points_[ *it ] - points_[ i ]).two_norm() <= distance )
+                  f( *it );
+              }
+            }
+        }
+
+      private:
+        struct Compare
+        {
+          bool operator() ( std::size_t a, const Key &b ) const { return (keys[ a ] < b); }
+          bool operator() ( const Key &a, std::size_t b ) const { return (a < keys[ b ]); }
+          const std::vector< Key > &keys;
+        };
+
+        Key key ( const GlobalCoordinate &x ) const noexcept
+        {
+          return Key( static_cast< long long >( std::floor( x[ 0 ] / cellSize_ ) ), static_cast< long long >( std::floor( x[ 1 ] / cellSize_ ) ) );
+        }
+
+        const std::vector< GlobalCoordinate > &points_;
+        double cellSize_;
+        std::vector< Key > keys_;
+        std::vector< std::size_t > order_;
+      };
+
+
+
+      // duplicateVertices
+      // -----------------
+
+      /** \brief vertices with a vertex of smaller index within the tolerance */
+      template< class ct >
+      inline ValidationReport::Result duplicateVertices ( const std::vector< FieldVector< ct, 2 > > &vertices, double tolerance, std::size_t maxOffenders )
+      {
+        if( tolerance > 0.0 )
+        {
+          const SpatialHash< ct > hash( vertices, tolerance );
+          return collect( vertices.size(), [ &hash, tolerance ] ( std::size_t i ) {
+              bool duplicate = false;
+              hash.forEachNeighbor( i, tolerance, [ i, &duplicate ] ( std::size_t j ) { duplicate |= (j < i); } );
+              return duplicate;
+            }, maxOffenders );
+        }
+
+        // identical positions are adjacent after lexicographic sorting
+        std::vector< std::size_t > order( vertices.size() );
+        std::iota( order.begin(), order.end(), 0u );
+        auto less = [ &vertices ] ( std::size_t a, std::size_t b ) {
+            return std::make_pair( vertices[ a ][ 0 ], vertices[ a ][ 1 ] ) < std::make_pair( vertices[ b ][ 0 ], vertices[ b ][ 1 ] );
+          };
+        std::stable_sort( order.begin(), order.end(), less );
+        std::vector< char > duplicate( vertices.size(), 0 );
+        for( std::size_t k = 1u; k < order.size(); ++k )
+          duplicate[ order[ k ] ] = (vertices[ order[ k ] ] == vertices[ order[ k-1u ] ] ? 1 : 0);
+        return collect( vertices.size(), [ &duplicate ] ( std::size_t i ) { return (duplicate[ i ] != 0); }, maxOffenders );
+      }
+
+
+
+      // vertexPolygons
+      // --------------
+
+      /** \brief polygons adjacent to each vertex, together with the position of the vertex within the polygon */
+      inline MultiVector< IndexPair > vertexPolygons ( std::size_t numVertices, const MultiVector< std::size_t > &polygons )
+      {
+        std::vector< std::size_t > count( numVertices, 0u );
+        for( std::size_t v : polygons.values() )
+          ++count[ v ];
+        MultiVector< IndexPair > incidence( count );
+        std::fill( count.begin(), count.end(), 0u );
+        for( std::size_t i = 0u; i < polygons.size(); ++i )
+          for( std::size_t j = 0u; j < polygons.size( i ); ++j )
+          {
+            const std::size_t v = polygons[ i ][ j ];
+            incidence[ v ][ count[ v ]++ ] = IndexPair( i, j );
+          }
+        return incidence;
+      }
+
+
+
+      // manifold
+      // --------
+
+      /**
+       * \brief return true, if the polygons around vertex v form a single fan
+       *
+       * Each polygon contributes a wedge (prev, next) of its neighboring
+       * corners. Across the edge to next, the wedge continues with the
+       * wedge starting at next. The vertex is manifold if no directed edge
+       * is used twice and the wedges form a single chain (boundary vertex)
+       * or a single cycle (interior vertex).
+       */
+      inline bool manifold ( const MultiVector< std::size_t > &polygons, const MultiVector< IndexPair > &incidence, std::size_t v )
+      {
+        const std::size_t n = incidence.size( v );
+        if( n == 0u )
+          return true;
+
+        std::vector< std::pair< std::size_t, std::size_t > > wedges( n );
+        for( std::size_t k = 0u; k < n; ++k )
+        {
+          const IndexPair p = incidence[ v ][ k ];
+          const std::size_t size = polygons.size( p.first );
+          wedges[ k ] = std::make_pair( polygons[ p.first ][ (p.second + size - 1u) % size ], polygons[ p.first ][ (p.second + 1u) % size ] );
+        }
+
+        auto successor = [ &wedges, n ] ( std::size_t k ) {
+            std::size_t next = n;
+            for( std::size_t l = 0u; l < n; ++l )
+              if( wedges[ l ].first == wedges[ k ].second )
+                next = (next == n ? l : n+1u);
+            return next;
+          };
+
+        std::size_t start = 0u, numStarts = 0u;
+        for( std::size_t k = 0u; k < n; ++k )
+        {
+          std::size_t numPredecessors = 0u;
+          for( std::size_t l = 0u; l < n; ++l )
+            numPredecessors += (wedges[ l ].second == wedges[ k ].first ? 1u : 0u);
+          if( numPredecessors > 1u )
+            return false;
+          if( numPredecessors == 0u )
+          {
+            start = k;
+            ++numStarts;
+          }
+        }
+        if( numStarts > 1u )
+          return false;
+
+        std::size_t length = 0u;
+        for( std::size_t k = start; (k < n) && (length <= n); k = successor( k ) )
+        {
+          ++length;
+          if( (numStarts == 0u) && (successor( k ) == start) )
+            break;
+        }
+        return (length == n);
+      }
+
+
+
+      // nonManifoldVertices
+      // -------------------
+
+      inline ValidationReport::Result nonManifoldVertices ( std::size_t numVertices, const MultiVector< std::size_t > &polygons, std::size_t maxOffenders )
+      {
+        const MultiVector< IndexPair > incidence = vertexPolygons( numVertices, polygons );
+        return collect( numVertices, [ &polygons, &incidence ] ( std::size_t v ) { return !manifold( polygons, incidence, v ); }, maxOffenders );
+      }
+
+    } // namespace __Validation
+
+
+
+    // validatePolygons
+    // ----------------
+
+    /**
+     * \brief validate the input of a mesh, i.e., vertices and polygons
+     *
+     * All checks run in parallel and report all offenders, so this can be
+     * used to validate data on ingest before constructing a Mesh (the half
+     * edge cycles require the mesh structure and are not checked).
+     */
+    template< class ct >
+    inline ValidationReport validatePolygons ( const std::vector< FieldVector< ct, 2 > > &vertices, const MultiVector< std::size_t > &polygons, const ValidationOptions &options = ValidationOptions() )
+    {
+      typedef ValidationReport Report;
+
+      Report report;
+      const std::size_t maxOffenders = options.maxOffenders;
+      auto valid = [ &vertices, &polygons ] ( std::size_t i ) {
+          return std::all_of( polygons[ i ].begin(), polygons[ i ].end(), [ &vertices ] ( std::size_t v ) { return (v < vertices.size()); } );
+        };
+
+      report[ Report::DegeneratePolygons ] = __Validation::collect( polygons.size(), [ &polygons, &valid ] ( std::size_t i ) {
+          return !valid( i ) || __Validation::degenerate( polygons[ i ] );
+        }, maxOffenders );
+
+      report[ Report::Orientation ] = __Validation::collect( polygons.size(), [ &vertices, &polygons, &valid ] ( std::size_t i ) {
+          if( !valid( i ) || (polygons.size( i ) < 3u) )
+            return false;
+          const auto polygon = polygons[ i ];
+          return !(polygonMoments( polygon.size(), [ &vertices, &polygon ] ( std::size_t j ) { return vertices[ polygon[ j ] ]; } ).volume() > ct( 0 ));
+        }, maxOffenders );
+
+      report[ Report::SelfIntersections ] = __Validation::collect( polygons.size(), [ &vertices, &polygons, &valid ] ( std::size_t i ) {
+          if( !valid( i ) )
+            return false;
+          const auto polygon = polygons[ i ];
+          return __Validation::selfIntersecting( polygon.size(), [ &vertices, &polygon ] ( std::size_t j ) { return vertices[ polygon[ j ] ]; } );
+        }, maxOffenders );
+
+      report[ Report::DuplicateVertices ] = __Validation::duplicateVertices( vertices, options.tolerance, maxOffenders );
+
+      // vertex indices out of range would corrupt the incidence
+      if( std::all_of( polygons.values().begin(), polygons.values().end(), [ &vertices ] ( std::size_t v ) { return (v < vertices.size()); } ) )
+        report[ Report::NonManifoldVertices ] = __Validation::nonManifoldVertices( vertices.size(), polygons, maxOffenders );
+
+      return report;
+    }
+
+
+
+    // validateMesh
+    // ------------
+
+    /**
+     * \brief validate a mesh
+     *
+     * In addition to the checks of validatePolygons, the half edge cycles
+     * of both mesh structures are verified (in parallel, reporting all
+     * inconsistent nodes, unlike checkStructure). The polygons are the
+     * primal cells of the mesh; their corners are taken as seen from the
+     * cell, i.e., including periodic shifts.
+     */
+    template< class ct >
+    inline ValidationReport validateMesh ( const Mesh< ct > &mesh, const ValidationOptions &options = ValidationOptions() )
+    {
+      typedef ValidationReport Report;
+      typedef typename Mesh< ct >::GlobalCoordinate GlobalCoordinate;
+
+      Report report;
+      report[ Report::PrimalHalfEdgeCycles ] = __Validation::halfEdgeCycles( mesh.nodes( Primal ), mesh.nodes( Dual ), Primal, options.maxOffenders );
+      report[ Report::DualHalfEdgeCycles ] = __Validation::halfEdgeCycles( mesh.nodes( Primal ), mesh.nodes( Dual ), Dual, options.maxOffenders );
+      if( (report[ Report::PrimalHalfEdgeCycles ].count > 0u) || (report[ Report::DualHalfEdgeCycles ].count > 0u) )
+        return report;
+
+      // the primal cells as polygons in terms of the vertex indices
+      const std::size_t numCells = mesh.numCells( Primal );
+      const std::vector< std::size_t > &offsets = mesh.nodes( Dual ).offsets();
+      std::vector< std::size_t > values( offsets[ numCells ] );
+      parallelFor( 0u, values.size(), [ &mesh, &values ] ( std::size_t k ) { values[ k ] = mesh.target( HalfEdgeIndex( k, Primal ) ); } );
+      const MultiVector< std::size_t > polygons( std::vector< std::size_t >( offsets.begin(), offsets.begin() + numCells + 1u ), std::move( values ) );
+
+      report[ Report::DegeneratePolygons ] = __Validation::collect( numCells, [ &polygons ] ( std::size_t i ) { return __Validation::degenerate( polygons[ i ] ); }, options.maxOffenders );
+
+      report[ Report::Orientation ] = __Validation::collect( numCells, [ &mesh ] ( std::size_t i ) {
+          return !(cellVolume( mesh, NodeIndex( i, Dual ) ) > ct( 0 ));
+        }, options.maxOffenders );
+
+      report[ Report::SelfIntersections ] = __Validation::collect( numCells, [ &mesh ] ( std::size_t i ) {
+          const HalfEdgeIndex begin = mesh.begin( NodeIndex( i, Dual ) );
+          return __Validation::selfIntersecting( mesh.size( NodeIndex( i, Dual ) ), [ &mesh, begin ] ( std::size_t j ) { return mesh.position( begin + static_cast< std::ptrdiff_t >( j ) ); } );
+        }, options.maxOffenders );
+
+      std::vector< GlobalCoordinate > vertices( mesh.numVertices( Primal ) );
+      for( std::size_t i = 0u; i < vertices.size(); ++i )
+        vertices[ i ] = mesh.position( NodeIndex( i, Primal ) );
+      report[ Report::DuplicateVertices ] = __Validation::duplicateVertices( vertices, options.tolerance, options.maxOffenders );
+
+      report[ Report::NonManifoldVertices ] = __Validation::nonManifoldVertices( vertices.size(), polygons, options.maxOffenders );
+
+      return report;
+    }
+
+  } // namespace __PolygonGrid
+
+} // namespace Dune
+
+#endif // #ifndef DUNE_POLYGONGRID_VALIDATION_HH
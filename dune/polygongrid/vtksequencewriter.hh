@@ -0,0 +1,309 @@
+#ifndef DUNE_POLYGONGRID_VTKSEQUENCEWRITER_HH
+#define DUNE_POLYGONGRID_VTKSEQUENCEWRITER_HH
+
+#include <cassert>
+#include <cstddef>
+
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+
+#include <dune/polygongrid/mesh.hh>
+#include <dune/polygongrid/parallel.hh>
+#include <dune/polygongrid/vtkwriter.hh>
+
+namespace Dune
+{
+
+  namespace __PolygonGrid
+  {
+
+    // VTKSequenceWriter
+    // -----------------
+
+    /**
+     * \brief asynchronous VTK writer for time series
+     *
+     * Each call to write copies the registered cell, vertex and edge data
+     * along with the point positions into one of two staging buffers and
+     * returns immediately. A background
+     * thread encodes (and compresses) the snapshot and writes the files
+     * name-<grid>-<count>.vtu along with the collection files name-<grid>.pvd,
+     * where <grid> is one of primal, dual, primal-edges, and dual-edges. If
+     * both staging buffers are in use, write blocks until the oldest
+     * snapshot has been written.
+     *
+     * As the mesh topology is immutable, the cells (connectivity, offsets
+     * and types) are encoded only once and reused for all snapshots. The
+     * points are encoded for each snapshot, as the vertices may be moved
+     * between snapshots (see Mesh::movePositions).
+     *
+     * A grid (or its edges) is written if data has been added for it; if no
+     * data has been added at all, the primal grid is written. Data must be
+     * added before the first call to write. The mesh must outlive the writer.
+     */
+    template< class ct >
+    class VTKSequenceWriter
+      : protected VTKWriter< ct >
+    {
+      typedef VTKSequenceWriter< ct > This;
+      typedef VTKWriter< ct > Base;
+
+    public:
+      typedef typename Base::Mesh Mesh;
+
+      VTKSequenceWriter ( const Mesh &mesh, std::string name, bool compress = false )
+        : Base( mesh, compress ), name_( std::move( name ) )
+      {
+        thread_ = std::thread( [ this ] () { run(); } );
+      }
+
+      VTKSequenceWriter ( const This & ) = delete;
+      VTKSequenceWriter &operator= ( const This & ) = delete;
+
+      ~VTKSequenceWriter ()
+      {
+        {
+          std::lock_guard< std::mutex > guard( mutex_ );
+          stop_ = true;
+        }
+        changed_.notify_all();
+        thread_.join();
+      }
+
+      using Base::addCellData;
+      using Base::addEdgeData;
+      using Base::addVertexData;
+
+      using Base::compress;
+      using Base::mesh;
+
+      /**
+       * \brief stage a snapshot of the registered data for output
+       *
+       * \returns the number of the snapshot
+       */
+      std::size_t write ( double time )
+      {
+        std::unique_lock< std::mutex > lock( mutex_ );
+        changed_.wait( lock, [ this ] () { return (exception_ || (pending_.size() < buffers_.size())); } );
+        rethrow();
+        Snapshot &snapshot = buffers_[ (first_ + pending_.size()) % buffers_.size() ];
+        lock.unlock();
+
+        snapshot.time = time;
+        snapshot.count = count_;
+        for( MeshType type : { Primal, Dual } )
+        {
+          // the background thread must not read the mesh positions, which may be moved meanwhile
+          std::vector< GlobalCoordinate > &points = snapshot.points[ type ];
+          points.resize( writeCells( type ) || writeEdges( type ) ? Base::numPoints( type ) : 0u );
+          parallelFor( 0u, points.size(), [ this, &points, type ] ( std::size_t k ) { points[ k ] = Base::point( type, k ); } );
+
+          for( int entities : { Base::Cells, Base::Edges, Base::Vertices } )
+          {
+            const std::vector< typename Base::Data > &data = data_[ type ][ entities ];
+            const std::size_t size = numEntities( type, entities );
+            snapshot.data[ type ][ entities ].resize( data.size() );
+            for( std::size_t i = 0u; i < data.size(); ++i )
+              snapshot.data[ type ][ entities ][ i ].assign( data[ i ].data, data[ i ].data + data[ i ].components*size );
+          }
+        }
+
+        lock.lock();
+        pending_.push_back( snapshot.count );
+        changed_.notify_all();
+        return count_++;
+      }
+
+      /** \brief wait until all staged snapshots have been written */
+      void wait ()
+      {
+        std::unique_lock< std::mutex > lock( mutex_ );
+        changed_.wait( lock, [ this ] () { return (exception_ || pending_.empty()); } );
+        rethrow();
+      }
+
+      /** \brief number of snapshots staged so far */
+      std::size_t count () const noexcept { return count_; }
+
+    private:
+      typedef typename Base::GlobalCoordinate GlobalCoordinate;
+
+      struct Snapshot
+      {
+        double time = 0.0;
+        std::size_t count = 0u;
+        std::array< std::array< std::vector< std::vector< double > >, 3 >, 2 > data;
+        std::array< std::vector< GlobalCoordinate >, 2 > points;
+      };
+
+      using Base::data_;
+
+      /** \brief return true, if the cells of the grid of given type are written */
+      bool writeCells ( MeshType type ) const
+      {
+        const bool empty = std::all_of( data_.begin(), data_.end(), [] ( const auto &d ) {
+            return std::all_of( d.begin(), d.end(), [] ( const auto &data ) { return data.empty(); } );
+          } );
+        return (empty ? (type == Primal) : !(data_[ type ][ Base::Cells ].empty() && data_[ type ][ Base::Vertices ].empty()));
+      }
+
+      /** \brief return true, if the edges of the grid of given type are written */
+      bool writeEdges ( MeshType type ) const { return !data_[ type ][ Base::Edges ].empty(); }
+
+      std::size_t numEntities ( MeshType type, int entities ) const noexcept
+      {
+        switch( entities )
+        {
+        case Base::Cells:
+          return mesh().numCells( type );
+        case Base::Edges:
+          return mesh().numEdges( type );
+        default:
+          return mesh().numVertices( type );
+        }
+      }
+
+      // must be called with the mutex locked
+      void rethrow ()
+      {
+        if( exception_ )
+          std::rethrow_exception( exception_ );
+      }
+
+      void run ()
+      {
+        std::unique_lock< std::mutex > lock( mutex_ );
+        while( true )
+        {
+          changed_.wait( lock, [ this ] () { return (stop_ || !pending_.empty()); } );
+          if( pending_.empty() )
+            return;
+          const Snapshot &snapshot = buffers_[ first_ ];
+          lock.unlock();
+
+          std::exception_ptr exception;
+          try
+          {
+            write( snapshot );
+          }
+          catch( ... )
+          {
+            exception = std::current_exception();
+          }
+
+          lock.lock();
+          if( exception )
+          {
+            exception_ = exception;
+            pending_.clear();
+          }
+          else
+          {
+            pending_.pop_front();
+            first_ = (first_ + 1u) % buffers_.size();
+          }
+          changed_.notify_all();
+        }
+      }
+
+      void write ( const Snapshot &snapshot )
+      {
+        for( MeshType type : { Primal, Dual } )
+        {
+          const std::string grid = (type == Primal ? "primal" : "dual");
+          const std::vector< GlobalCoordinate > &points = snapshot.points[ type ];
+          auto position = [ &points ] ( std::size_t k ) { return points[ k ]; };
+          if( writeCells( type ) )
+          {
+            const __VTKWriter::Piece piece = Base::piece( type, staged( snapshot, type, Base::Cells ), staged( snapshot, type, Base::Vertices ), position );
+            write( grid, piece, snapshot );
+          }
+          if( writeEdges( type ) )
+          {
+            const __VTKWriter::Piece piece = Base::edgePiece( type, staged( snapshot, type, Base::Edges ), position );
+            write( grid + "-edges", piece, snapshot );
+          }
+        }
+      }
+
+      void write ( const std::string &grid, const __VTKWriter::Piece &piece, const Snapshot &snapshot )
+      {
+        // encode the cells only once; the points are encoded for each snapshot
+        __VTKWriter::EncodedArrays &cells = cells_[ grid ];
+        if( cells.empty() )
+        {
+          for( const __VTKWriter::DataArray &array : piece.cells )
+            cells.emplace_back( array.name, std::make_shared< const std::vector< char > >( __VTKWriter::encodeArray( array, compress() ) ) );
+        }
+
+        std::ostringstream filename;
+        filename << name_ << "-" << grid << "-" << std::setw( 5 ) << std::setfill( '0' ) << snapshot.count << ".vtu";
+        __VTKWriter::writePiece( filename.str(), piece, compress(), cells );
+
+        // update collection
+        std::vector< std::pair< double, std::string > > &collection = collections_[ grid ];
+        collection.emplace_back( snapshot.time, filename.str().substr( name_.find_last_of( '/' ) + 1u ) );
+
+        const std::string pvdname = name_ + "-" + grid + ".pvd";
+        std::ofstream pvd( pvdname );
+        pvd << std::setprecision( std::numeric_limits< double >::max_digits10 );
+        pvd << "<?xml version=\"1.0\"?>\n";
+        pvd << "<VTKFile type=\"Collection\" version=\"0.1\">\n";
+        pvd << "  <Collection>\n";
+        for( const auto &entry : collection )
+          pvd << "    <DataSet timestep=\"" << entry.first << "\" group=\"\" part=\"0\" file=\"" << entry.second << "\"/>\n";
+        pvd << "  </Collection>\n";
+        pvd << "</VTKFile>\n";
+        if( !pvd )
+          DUNE_THROW( IOError, "Unable to write file '" << pvdname << "'." );
+      }
+
+      std::vector< typename Base::Data > staged ( const Snapshot &snapshot, MeshType type, int entities ) const
+      {
+        std::vector< typename Base::Data > data = data_[ type ][ entities ];
+        for( std::size_t i = 0u; i < data.size(); ++i )
+          data[ i ].data = snapshot.data[ type ][ entities ][ i ].data();
+        return data;
+      }
+
+      std::string name_;
+      std::size_t count_ = 0u;
+
+      // staging buffers; pending_ holds the numbers of the staged snapshots, the oldest being in buffers_[ first_ ]
+      std::array< Snapshot, 2 > buffers_;
+      std::size_t first_ = 0u;
+      std::deque< std::size_t > pending_;
+
+      // only accessed by the background thread
+      std::map< std::string, __VTKWriter::EncodedArrays > cells_;
+      std::map< std::string, std::vector< std::pair< double, std::string > > > collections_;
+
+      std::mutex mutex_;
+      std::condition_variable changed_;
+      std::exception_ptr exception_;
+      bool stop_ = false;
+      std::thread thread_;
+    };
+
+  } // namespace __PolygonGrid
+
+} // namespace Dune
+
+#endif // #ifndef DUNE_POLYGONGRID_VTKSEQUENCEWRITER_HH
@@ -0,0 +1,601 @@
+#ifndef DUNE_POLYGONGRID_VTKWRITER_HH
+#define DUNE_POLYGONGRID_VTKWRITER_HH
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <ios>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if HAVE_ZLIB
+#include <zlib.h>
+#endif // #if HAVE_ZLIB
+
+#include <dune/common/exceptions.hh>
+
+#include <dune/polygongrid/mesh.hh>
+#include <dune/polygongrid/parallel.hh>
+
+namespace Dune
+{
+
+  namespace __PolygonGrid
+  {
+
+    namespace __VTKWriter
+    {
+
+      // TypeName
+      // --------
+
+      template< class T >
+      struct TypeName;
+
+      template<> struct TypeName< float > { static const char *value () { return "Float32"; } };
+      template<> struct TypeName< double > { static const char *value () { return "Float64"; } };
+      template<> struct TypeName< std::int64_t > { static const char *value () { return "Int64"; } };
+      template<> struct TypeName< std::uint8_t > { static const char *value () { return "UInt8"; } };
+
+
+
+      // DataArray
+      // ---------
+
+      /**
+       * \brief description of a VTK data array
+       *
+       * The data is not stored; instead, fill( first, last, out ) writes the
+       * tuples [first, last) into the raw buffer out. This allows writing
+       * arrays derived from the mesh without materializing them.
+       */
+      struct DataArray
+      {
+        std::string name, type;
+        int components = 1;
+        std::size_t size = 0u;
+        std::size_t tupleSize = 0u;
+        std::function< void( std::size_t, std::size_t, char * ) > fill;
+      };
+
+      /** \brief create data array, whose tuple i is given by f( i, T *values ) */
+      template< class T, class F >
+      inline DataArray dataArray ( std::string name, int components, std::size_t size, F f )
+      {
+        DataArray array;
+        array.name = std::move( name );
+        array.type = TypeName< T >::value();
+        array.components = components;
+        array.size = size;
+        array.tupleSize = components * sizeof( T );
+        array.fill = [ f, components ] ( std::size_t first, std::size_t last, char *out ) {
+            T values[ 3 ];
+            for( std::size_t i = first; i < last; ++i, out += components * sizeof( T ) )
+            {
+              f( i, values );
+              std::memcpy( out, values, components * sizeof( T ) );
+            }
+          };
+        return array;
+      }
+
+
+
+      // Piece
+      // -----
+
+      /** \brief data arrays making up a VTK piece */
+      struct Piece
+      {
+        std::size_t numPoints = 0u, numCells = 0u;
+        std::vector< DataArray > pointData, cellData, points, cells;
+      };
+
+
+
+      // encodeArray
+      // -----------
+
+      static const std::size_t blockSize = std::size_t( 1 ) << 20;
+
+      inline std::size_t tuplesPerBlock ( const DataArray &array ) noexcept
+      {
+        return std::max< std::size_t >( blockSize / std::max< std::size_t >( array.tupleSize, 1u ), 1u );
+      }
+
+      inline std::size_t numBlocks ( const DataArray &array ) noexcept
+      {
+        return (array.size + tuplesPerBlock( array ) - 1u) / tuplesPerBlock( array );
+      }
+
+      /** \brief number of 64 bit words in the header of an encoded array */
+      inline std::size_t headerSize ( const DataArray &array, bool compress ) noexcept
+      {
+        return (compress ? 3u + numBlocks( array ) : 1u);
+      }
+
+      /**
+       * \brief encode a data array for the appended data section
+       *
+       * The array is processed in blocks of (about) blockSize bytes. Batches
+       * of blocks are filled (and compressed) concurrently and passed to
+       * write( data, size ) in order. The returned header (sizes in bytes)
+       * has to precede the data in the file.
+       */
+      template< class Write >
+      inline std::vector< std::uint64_t > encodeArray ( const DataArray &array, bool compress, Write write )
+      {
+        const std::size_t tuplesPerBlock = __VTKWriter::tuplesPerBlock( array );
+        const std::size_t numBlocks = __VTKWriter::numBlocks( array );
+        const std::size_t batchSize = 4u*numThreads();
+
+        std::vector< std::uint64_t > header;
+        if( compress )
+        {
+          const std::size_t lastSize = (numBlocks > 0u ? (array.size - (numBlocks-1u)*tuplesPerBlock) * array.tupleSize : 0u);
+          header = { numBlocks, tuplesPerBlock * array.tupleSize, lastSize };
+        }
+        else
+          header = { array.size * array.tupleSize };
+
+        std::vector< std::vector< char > > raw( std::min( batchSize, numBlocks ) ), packed( compress ? raw.size() : 0u );
+        for( std::size_t batch = 0u; batch < numBlocks; batch += batchSize )
+        {
+          const std::size_t count = std::min( batchSize, numBlocks - batch );
+          parallelFor( 0u, count, [ &array, &raw, &packed, compress, batch, tuplesPerBlock ] ( std::size_t k ) {
+              const std::size_t first = (batch + k)*tuplesPerBlock;
+              const std::size_t last = std::min( first + tuplesPerBlock, array.size );
+              raw[ k ].resize( (last - first) * array.tupleSize );
+              array.fill( first, last, raw[ k ].data() );
+#if HAVE_ZLIB
+              if( compress )
+              {
+                uLongf size = compressBound( static_cast< uLong >( raw[ k ].size() ) );
+                packed[ k ].resize( size );
+                if( compress2( reinterpret_cast< Bytef * >( packed[ k ].data() ), &size, reinterpret_cast< const Bytef * >( raw[ k ].data() ), static_cast< uLong >( raw[ k ].size() ), Z_DEFAULT_COMPRESSION ) != Z_OK )
+                  DUNE_THROW( IOError, "Unable to compress VTK data array." );
+                packed[ k ].resize( size );
+              }
+#endif // #if HAVE_ZLIB
+            }, 1u );
+
+          for( std::size_t k = 0u; k < count; ++k )
+          {
+            const std::vector< char > &block = (compress ? packed[ k ] : raw[ k ]);
+            write( block.data(), block.size() );
+            if( compress )
+              header.push_back( block.size() );
+          }
+        }
+        return header;
+      }
+
+      /** \brief encode a data array into memory (header followed by data) */
+      inline std::vector< char > encodeArray ( const DataArray &array, bool compress )
+      {
+        std::vector< char > encoded( headerSize( array, compress )*sizeof( std::uint64_t ) );
+        const std::vector< std::uint64_t > header = encodeArray( array, compress, [ &encoded ] ( const char *data, std::size_t size ) {
+            encoded.insert( encoded.end(), data, data + size );
+          } );
+        std::memcpy( encoded.data(), header.data(), header.size()*sizeof( std::uint64_t ) );
+        return encoded;
+      }
+
+
+
+      // isLittleEndian
+      // --------------
+
+      inline bool isLittleEndian () noexcept
+      {
+        const std::uint16_t one = 1u;
+        unsigned char bytes[ 2 ];
+        std::memcpy( bytes, &one, 2u );
+        return (bytes[ 0 ] == 1u);
+      }
+
+
+
+      // writePiece
+      // ----------
+
+      typedef std::vector< std::pair< std::string, std::shared_ptr< const std::vector< char > > > > EncodedArrays;
+
+      /**
+       * \brief write a piece into a VTU file
+       *
+       * The offsets into the appended data are only known after encoding the
+       * arrays, so the XML header is written with fixed width placeholders,
+       * which are patched at the end. The same holds for the header of each
+       * data array.
+       *
+       * \param[in]  encoded  encodings (see encodeArray) for some arrays,
+       *                      identified by the array name; these are written
+       *                      verbatim
+       */
+      inline void writePiece ( const std::string &filename, const Piece &piece, bool compress, const EncodedArrays &encoded = EncodedArrays() )
+      {
+        std::ofstream output( filename, std::ios::binary );
+        if( !output )
+          DUNE_THROW( IOError, "Unable to open file '" << filename << "'." );
+
+        std::vector< std::streampos > offsetPositions;
+        std::vector< const DataArray * > arrays;
+        auto xml = [ &output, &offsetPositions, &arrays ] ( const std::vector< DataArray > &section, const char *tag ) {
+            output << "      <" << tag << ">\n";
+            for( const DataArray &array : section )
+            {
+              output << "        <DataArray type=\"" << array.type << "\" Name=\"" << array.name << "\" NumberOfComponents=\"" << array.components << "\" format=\"appended\" offset=\"";
+              offsetPositions.push_back( output.tellp() );
+              arrays.push_back( &array );
+              output << std::string( 20u, '0' ) << "\"/>\n";
+            }
+            output << "      </" << tag << ">\n";
+          };
+
+        output << "<?xml version=\"1.0\"?>\n";
+        output << "<VTKFile type=\"UnstructuredGrid\" version=\"1.0\" byte_order=\"" << (isLittleEndian() ? "LittleEndian" : "BigEndian") << "\" header_type=\"UInt64\"";
+        if( compress )
+          output << " compressor=\"vtkZLibDataCompressor\"";
+        output << ">\n";
+        output << "  <UnstructuredGrid>\n";
+        output << "    <Piece NumberOfPoints=\"" << piece.numPoints << "\" NumberOfCells=\"" << piece.numCells << "\">\n";
+        xml( piece.pointData, "PointData" );
+        xml( piece.cellData, "CellData" );
+        xml( piece.points, "Points" );
+        xml( piece.cells, "Cells" );
+        output << "    </Piece>\n";
+        output << "  </UnstructuredGrid>\n";
+        output << "  <AppendedData encoding=\"raw\">\n_";
+
+        const std::streampos start = output.tellp();
+        std::vector< std::uint64_t > offsets;
+        for( const DataArray *array : arrays )
+        {
+          offsets.push_back( static_cast< std::uint64_t >( output.tellp() - start ) );
+
+          const auto pos = std::find_if( encoded.begin(), encoded.end(), [ array ] ( const auto &e ) { return (e.first == array->name); } );
+          if( pos != encoded.end() )
+          {
+            output.write( pos->second->data(), static_cast< std::streamsize >( pos->second->size() ) );
+            continue;
+          }
+
+          const std::streampos headerPosition = output.tellp();
+          const std::vector< std::uint64_t > placeholder( headerSize( *array, compress ), 0u );
+          output.write( reinterpret_cast< const char * >( placeholder.data() ), static_cast< std::streamsize >( placeholder.size()*sizeof( std::uint64_t ) ) );
+          const std::vector< std::uint64_t > header = encodeArray( *array, compress, [ &output ] ( const char *data, std::size_t size ) {
+              output.write( data, static_cast< std::streamsize >( size ) );
+            } );
+          assert( header.size() == placeholder.size() );
+
+          const std::streampos end = output.tellp();
+          output.seekp( headerPosition );
+          output.write( reinterpret_cast< const char * >( header.data() ), static_cast< std::streamsize >( header.size()*sizeof( std::uint64_t ) ) );
+          output.seekp( end );
+        }
+        output << "\n  </AppendedData>\n";
+        output << "</VTKFile>\n";
+
+        for( std::size_t i = 0u; i < offsets.size(); ++i )
+        {
+          std::ostringstream offset;
+          offset << std::setw( 20 ) << std::setfill( '0' ) << offsets[ i ];
+          output.seekp( offsetPositions[ i ] );
+          output << offset.str();
+        }
+
+        if( !output )
+          DUNE_THROW( IOError, "Unable to write file '" << filename << "'." );
+      }
+
+    } // namespace __VTKWriter
+
+
+
+    // VTKWriter
+    // ---------
+
+    /**
+     * \brief VTK XML writer for the primal and dual grid of a mesh
+     *
+     * The grids are written as unstructured grids of VTK_POLYGON cells with
+     * appended raw binary data (optionally zlib compressed, if available).
+     * Points, connectivity and offsets are generated directly from the CSR
+     * arrays of the mesh in blocks, so no copy of the mesh is made.
+     *
+     * Cell, vertex and edge data are passed as flat arrays of doubles (with
+     * the given number of components per entity), indexed by the cell,
+     * vertex and edge indices of the respective grid. The arrays are only
+     * referenced and must be valid when write is called. As VTK cannot
+     * attach data to the edges of a polygon, edge data is written to a
+     * separate file containing the edges as VTK_LINE cells.
+     *
+     * For periodic meshes, each cell (and edge) is written with its own
+     * corners.
+     */
+    template< class ct >
+    class VTKWriter
+    {
+      typedef VTKWriter< ct > This;
+
+    public:
+      typedef __PolygonGrid::Mesh< ct > Mesh;
+      typedef typename Mesh::GlobalCoordinate GlobalCoordinate;
+
+      explicit VTKWriter ( const Mesh &mesh, bool compress = false )
+        : mesh_( mesh ), compress_( compress )
+      {
+#if !HAVE_ZLIB
+        if( compress_ )
+          DUNE_THROW( NotImplemented, "Compressed VTK output requires zlib." );
+#endif // #if !HAVE_ZLIB
+      }
+
+      void addCellData ( MeshType type, const std::string &name, const double *data, int components = 1 )
+      {
+        assert( (components >= 1) && (components <= 3) );
+        data_[ type ][ Cells ].push_back( Data{ name, data, components } );
+      }
+
+      void addCellData ( MeshType type, const std::string &name, const std::vector< double > &data, int components = 1 )
+      {
+        assert( data.size() == components * mesh().numCells( type ) );
+        addCellData( type, name, data.data(), components );
+      }
+
+      void addEdgeData ( MeshType type, const std::string &name, const double *data, int components = 1 )
+      {
+        assert( (components >= 1) && (components <= 3) );
+        data_[ type ][ Edges ].push_back( Data{ name, data, components } );
+      }
+
+      void addEdgeData ( MeshType type, const std::string &name, const std::vector< double > &data, int components = 1 )
+      {
+        assert( data.size() == components * mesh().numEdges( type ) );
+        addEdgeData( type, name, data.data(), components );
+      }
+
+      void addVertexData ( MeshType type, const std::string &name, const double *data, int components = 1 )
+      {
+        assert( (components >= 1) && (components <= 3) );
+        data_[ type ][ Vertices ].push_back( Data{ name, data, components } );
+      }
+
+      void addVertexData ( MeshType type, const std::string &name, const std::vector< double > &data, int components = 1 )
+      {
+        assert( data.size() == components * mesh().numVertices( type ) );
+        addVertexData( type, name, data.data(), components );
+      }
+
+      void clear ()
+      {
+        for( auto &data : data_ )
+          for( std::vector< Data > &d : data )
+            d.clear();
+      }
+
+      /**
+       * \brief write primal grid to name.vtu and dual grid to name-dual.vtu
+       *
+       * If edge data has been added, the edges are written to name-edges.vtu
+       * and name-dual-edges.vtu, respectively. The dual grid is skipped, if
+       * the dual data of the mesh has not been built (see Mesh::buildDual).
+       */
+      void write ( const std::string &name ) const
+      {
+        for( MeshType type : { Primal, Dual } )
+        {
+          if( (type == Dual) && !mesh().dualBuilt() )
+            continue;
+
+          const std::string basename = name + (type == Primal ? "" : "-dual");
+          write( basename + ".vtu", type );
+          if( !data_[ type ][ Edges ].empty() )
+            writeEdges( basename + "-edges.vtu", type );
+        }
+      }
+
+      /** \brief write cells of the grid of given type to a file */
+      void write ( const std::string &filename, MeshType type ) const
+      {
+        __VTKWriter::writePiece( filename, piece( type, data_[ type ][ Cells ], data_[ type ][ Vertices ] ), compress() );
+      }
+
+      /** \brief write edges of the grid of given type to a file */
+      void writeEdges ( const std::string &filename, MeshType type ) const
+      {
+        __VTKWriter::writePiece( filename, edgePiece( type, data_[ type ][ Edges ] ), compress() );
+      }
+
+      const Mesh &mesh () const noexcept { return mesh_; }
+      bool compress () const noexcept { return compress_; }
+
+    protected:
+      enum Entities { Cells = 0, Edges = 1, Vertices = 2 };
+
+      struct Data
+      {
+        std::string name;
+        const double *data;
+        int components;
+      };
+
+      /**
+       * \brief number of points written for the grid of given type
+       *
+       * For periodic meshes, the points are the targets of the half edges
+       * of the cells (as seen from the cell), otherwise they are the
+       * vertices.
+       */
+      std::size_t numPoints ( MeshType type ) const noexcept
+      {
+        return (mesh().periodic() ? mesh().nodes( dual( type ) ).offsets()[ mesh().numCells( type ) ] : mesh().numVertices( type ));
+      }
+
+      /** \brief position of point k of the grid of given type (see numPoints) */
+      GlobalCoordinate point ( MeshType type, std::size_t k ) const noexcept
+      {
+        return (mesh().periodic() ? mesh().position( HalfEdgeIndex( k, type ) ) : mesh().position( NodeIndex( k, type ) ));
+      }
+
+      /** \brief describe the cells of the grid of given type */
+      __VTKWriter::Piece piece ( MeshType type, const std::vector< Data > &cellData, const std::vector< Data > &vertexData ) const
+      {
+        return piece( type, cellData, vertexData, [ this, type ] ( std::size_t k ) { return point( type, k ); } );
+      }
+
+      /**
+       * \brief describe the cells of the grid of given type
+       *
+       * The position of point k (see numPoints) is given by position( k ).
+       */
+      template< class Position >
+      __VTKWriter::Piece piece ( MeshType type, const std::vector< Data > &cellData, const std::vector< Data > &vertexData, Position position ) const
+      {
+        const Mesh &mesh = mesh_;
+        const MultiVector< IndexPair > &nodes = mesh.nodes( dual( type ) );
+        const bool periodic = mesh.periodic();
+
+        __VTKWriter::Piece piece;
+        piece.numCells = mesh.numCells( type );
+        piece.numPoints = numPoints( type );
+
+        for( const Data &data : vertexData )
+        {
+          if( periodic )
+            piece.pointData.push_back( dataArray( data, piece.numPoints, [ &nodes ] ( std::size_t k ) { return nodes.values()[ k ].first; } ) );
+          else
+            piece.pointData.push_back( dataArray( data, piece.numPoints, [] ( std::size_t i ) { return i; } ) );
+        }
+        for( const Data &data : cellData )
+          piece.cellData.push_back( dataArray( data, piece.numCells, [] ( std::size_t i ) { return i; } ) );
+
+        piece.points.push_back( __VTKWriter::dataArray< ct >( "Coordinates", 3, piece.numPoints, [ position ] ( std::size_t k, ct *x ) { coordinates( position( k ), x ); } ) );
+
+        piece.cells.push_back( __VTKWriter::dataArray< std::int64_t >( "connectivity", 1, nodes.offsets()[ piece.numCells ], [ &nodes, periodic ] ( std::size_t k, std::int64_t *v ) {
+            v[ 0 ] = static_cast< std::int64_t >( periodic ? k : nodes.values()[ k ].first );
+          } ) );
+        piece.cells.push_back( __VTKWriter::dataArray< std::int64_t >( "offsets", 1, piece.numCells, [ &nodes ] ( std::size_t i, std::int64_t *v ) {
+            v[ 0 ] = static_cast< std::int64_t >( nodes.end_of( i ) );
+          } ) );
+        piece.cells.push_back( cellTypes( piece.numCells, 7u ) ); // VTK_POLYGON
+        return piece;
+      }
+
+      /** \brief describe the edges of the grid of given type */
+      __VTKWriter::Piece edgePiece ( MeshType type, const std::vector< Data > &edgeData ) const
+      {
+        return edgePiece( type, edgeData, [ this, type ] ( std::size_t k ) { return point( type, k ); } );
+      }
+
+      /**
+       * \brief describe the edges of the grid of given type
+       *
+       * The position of point k of the grid (see numPoints) is given by
+       * position( k ).
+       */
+      template< class Position >
+      __VTKWriter::Piece edgePiece ( MeshType type, const std::vector< Data > &edgeData, Position position ) const
+      {
+        const Mesh &mesh = mesh_;
+        const bool periodic = mesh.periodic();
+        std::shared_ptr< const std::vector< std::size_t > > edges = edgeHalfEdges( type );
+
+        __VTKWriter::Piece piece;
+        piece.numCells = mesh.numEdges( type );
+        piece.numPoints = (periodic ? 2u*piece.numCells : mesh.numVertices( type ));
+
+        for( const Data &data : edgeData )
+          piece.cellData.push_back( dataArray( data, piece.numCells, [] ( std::size_t i ) { return i; } ) );
+
+        // corner j of edge i is the target of half edge (*edges)[ 2*i+j ]
+        if( periodic )
+          piece.points.push_back( __VTKWriter::dataArray< ct >( "Coordinates", 3, piece.numPoints, [ position, edges ] ( std::size_t k, ct *x ) { coordinates( position( (*edges)[ k ] ), x ); } ) );
+        else
+          piece.points.push_back( __VTKWriter::dataArray< ct >( "Coordinates", 3, piece.numPoints, [ position ] ( std::size_t i, ct *x ) { coordinates( position( i ), x ); } ) );
+
+        piece.cells.push_back( __VTKWriter::dataArray< std::int64_t >( "connectivity", 1, 2u*piece.numCells, [ &mesh, edges, periodic, type ] ( std::size_t k, std::int64_t *v ) {
+            v[ 0 ] = static_cast< std::int64_t >( periodic ? k : static_cast< std::size_t >( mesh.target( HalfEdgeIndex( (*edges)[ k ], type ) ) ) );
+          } ) );
+        piece.cells.push_back( __VTKWriter::dataArray< std::int64_t >( "offsets", 1, piece.numCells, [] ( std::size_t i, std::int64_t *v ) {
+            v[ 0 ] = static_cast< std::int64_t >( 2u*(i+1u) );
+          } ) );
+        piece.cells.push_back( cellTypes( piece.numCells, 3u ) ); // VTK_LINE
+        return piece;
+      }
+
+      /**
+       * \brief half edges whose targets are the corners of the edges
+       *
+       * Each edge is described within the cell containing the half edge
+       * with the smaller index. Its corners are the targets of the previous
+       * half edge and of the half edge itself.
+       */
+      std::shared_ptr< const std::vector< std::size_t > > edgeHalfEdges ( MeshType type ) const
+      {
+        const Mesh &mesh = mesh_;
+        const MultiVector< IndexPair > &nodes = mesh.nodes( dual( type ) );
+        const std::size_t numEdges = mesh.numEdges( type );
+
+        auto edges = std::make_shared< std::vector< std::size_t > >( 2u*numEdges );
+        parallelFor( 0u, mesh.numCells( type ), [ &mesh, &nodes, &edges, numEdges, type ] ( std::size_t i ) {
+            const std::size_t begin = nodes.begin_of( i ), end = nodes.end_of( i );
+            for( std::size_t k = begin; k < end; ++k )
+            {
+              const HalfEdgeIndex h( k, type );
+              const std::size_t edge = mesh.edgeIndex( h );
+              if( (edge >= numEdges) || (static_cast< std::size_t >( mesh.flip( h ) ) < k) )
+                continue;
+              (*edges)[ 2*edge ] = (k > begin ? k : end) - 1u;
+              (*edges)[ 2*edge+1 ] = k;
+            }
+          } );
+        return edges;
+      }
+
+      static __VTKWriter::DataArray cellTypes ( std::size_t size, std::uint8_t cellType )
+      {
+        return __VTKWriter::dataArray< std::uint8_t >( "types", 1, size, [ cellType ] ( std::size_t, std::uint8_t *v ) { v[ 0 ] = cellType; } );
+      }
+
+      /** \brief data array whose tuple i is tuple index( i ) of the data */
+      template< class Index >
+      static __VTKWriter::DataArray dataArray ( const Data &data, std::size_t size, Index index )
+      {
+        const double *values = data.data;
+        const int components = data.components;
+        return __VTKWriter::dataArray< double >( data.name, components, size, [ values, components, index ] ( std::size_t i, double *v ) {
+            const std::size_t j = index( i );
+            std::copy( values + j*components, values + (j+1)*components, v );
+          } );
+      }
+
+      template< class X >
+      static void coordinates ( const X &y, ct *x )
+      {
+        x[ 0 ] = y[ 0 ];
+        x[ 1 ] = y[ 1 ];
+        x[ 2 ] = ct( 0 );
+      }
+
+      const Mesh &mesh_;
+      bool compress_;
+      std::array< std::array< std::vector< Data >, 3 >, 2 > data_;
+    };
+
+  } // namespace __PolygonGrid
+
+} // namespace Dune
+
+#endif // #ifndef DUNE_POLYGONGRID_VTKWRITER_HH
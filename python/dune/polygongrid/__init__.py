@@ -6,23 +6,161 @@ from dune.generator import Constructor, Method
 from .blossoms import blossomDomain
 from .voronoi import voronoiDomain
 
-def polygonGrid(domain, ctype="double", dualGrid=False ):
+def polygonGrid(domain, ctype="double", dualGrid=False, profile=False ):
+    """create a PolygonGrid
+
+    For ctype="float", the positions are stored as absolute coordinates in
+    single precision, while volumes and centers are accumulated in double
+    precision relative to the first corner of each cell. The geometry is
+    thus limited by the rounding of the positions, which grows with their
+    distance from the origin.
+
+    If profile is True, the construction of the mesh is profiled; the
+    phases are available through grid.hierarchicalGrid.meshProfile() as
+    tuples (name, seconds, bytes). Statistics of the mesh structure are
+    returned by grid.hierarchicalGrid.meshStatistics().
+
+    Geometric quantities of all cells or edges are returned as NumPy
+    arrays, indexed like the leaf index set, by the following methods of
+    grid.hierarchicalGrid (for the primal as well as the dual grid):
+    cellVolumes(), cellCentroids() (shape (n, 2)), edgeLengths(),
+    edgeNormals() (unit normals pointing out of the first cell of
+    edgeCells(), shape (n, 2)), edgeCells() (shape (n, 2), -1 for the
+    boundary), cellVertices() and cellNeighbors() (tuples (offsets, values)
+    in compressed row storage, listing the vertices and neighbors in
+    counter-clockwise order; neighbors across the boundary are -1).
+
+    The internal arrays of the mesh are available without copying as
+    read-only NumPy arrays through grid.hierarchicalGrid.meshData(). For
+    both mesh structures ("primal" and "dual"), it returns the CSR arrays
+    "offsets" and "nodes" (pairs of node index and position within the
+    node, shape (n, 2)), the node "positions" (shape (n, 2)) and the
+    "edgeIndices" of the half edges; "type" names the structure of the
+    grid itself. The cells of the grid of type T are the first rows of the
+    other structure. The arrays keep the mesh alive; they follow moved
+    vertices, but not adaptation or coarsening, which create a new mesh.
+    """
     from ..grid.grid_generator import module, getDimgrid
 
     typeName = "Dune::PolygonGrid< " + ctype + " >"
-    includes = ["dune/polygongrid/grid.hh", "dune/polygongrid/dgf.hh"]
+    includes = ["dune/python/pybind11/numpy.h", "dune/polygongrid/grid.hh", "dune/polygongrid/dgf.hh", "dune/polygongrid/meshprofile.hh", "dune/polygongrid/bulkgeometry.hh"]
 
     dualGridMethod = Method('dualGrid', '''[]( DuneType &self ) { return self.dualGrid(); }''' )
-    cachingStorage = Method('cachingStorage', '''[]( DuneType &self ) { return false; }''' )
-    gridModule = module(includes, typeName, dualGridMethod, cachingStorage)
+    cachingStorage = Method('cachingStorage', '''[]( DuneType &self ) { return true; }''' )
+    meshData = Method('meshData', '''[]( DuneType &self ) {
+        typedef typename DuneType::Mesh Mesh;
+        static_assert( sizeof( typename Mesh::GlobalCoordinate ) == 2*sizeof( typename DuneType::ctype ), "Positions must be stored contiguously." );
+        static_assert( sizeof( Dune::__PolygonGrid::IndexPair ) == 2*sizeof( std::size_t ), "Index pairs must be stored contiguously." );
+
+        // the capsule shares the ownership of the mesh, so the views remain valid as long as they exist
+        const pybind11::capsule owner( new std::shared_ptr< Mesh >( self.sharedMesh() ), [] ( void *mesh ) { delete static_cast< std::shared_ptr< Mesh > * >( mesh ); } );
+        auto view = [ &owner ] ( const auto *data, std::vector< std::size_t > shape ) {
+            pybind11::array array( pybind11::dtype::of< std::decay_t< decltype( *data ) > >(), shape, data, owner );
+            array.attr( "flags" ).attr( "writeable" ) = false;
+            return array;
+          };
 
-    grid = gridModule.LeafGrid(gridModule.reader(domain))
+        const Mesh &mesh = self.mesh();
+        pybind11::dict result;
+        for( auto type : { Dune::__PolygonGrid::Primal, Dune::__PolygonGrid::Dual } )
+        {
+          const auto &nodes = mesh.nodes( type );
+          pybind11::dict data;
+          data[ "offsets" ] = view( nodes.offsets().data(), { nodes.offsets().size() } );
+          data[ "nodes" ] = view( reinterpret_cast< const std::size_t * >( nodes.values().data() ), { nodes.values().size(), std::size_t( 2 ) } );
+          data[ "positions" ] = view( reinterpret_cast< const typename DuneType::ctype * >( mesh.positions( type ).data() ), { mesh.positions( type ).size(), std::size_t( 2 ) } );
+          data[ "edgeIndices" ] = view( mesh.edgeIndices( type ).data(), { mesh.edgeIndices( type ).size() } );
+          result[ type == Dune::__PolygonGrid::Primal ? "primal" : "dual" ] = data;
+        }
+        result[ "type" ] = (self.type() == Dune::__PolygonGrid::Primal ? "primal" : "dual");
+        return result;
+      }''' )
+    meshProfile = Method('meshProfile', '''[]( DuneType &self ) {
+        pybind11::list phases;
+        for( const auto &phase : self.mesh().profile().phases )
+          phases.append( pybind11::make_tuple( phase.name, phase.seconds, phase.bytes ) );
+        return phases;
+      }''' )
+    meshStatistics = Method('meshStatistics', '''[]( DuneType &self ) {
+        const auto statistics = Dune::__PolygonGrid::meshStatistics( self.mesh() );
+        pybind11::dict valences, polygonSizes, memory, result;
+        for( const auto &valence : statistics.valences )
+          valences[ pybind11::int_( valence.first ) ] = valence.second;
+        for( const auto &size : statistics.polygonSizes )
+          polygonSizes[ pybind11::int_( size.first ) ] = size.second;
+        for( const auto &array : statistics.memory )
+          memory[ pybind11::str( array.first ) ] = array.second;
+        result[ "vertices" ] = statistics.numVertices;
+        result[ "polygons" ] = statistics.numPolygons;
+        result[ "edges" ] = statistics.numEdges;
+        result[ "boundaries" ] = statistics.numBoundaries;
+        result[ "valences" ] = valences;
+        result[ "polygonSizes" ] = polygonSizes;
+        result[ "memory" ] = memory;
+        return result;
+      }''' )
+    cellVolumes = Method('cellVolumes', '''[]( DuneType &self ) {
+        pybind11::array_t< typename DuneType::ctype > volumes( self.mesh().numCells( self.type() ) );
+        Dune::__PolygonGrid::cellVolumes( self.mesh(), self.type(), volumes.mutable_data() );
+        return volumes;
+      }''' )
+    cellCentroids = Method('cellCentroids', '''[]( DuneType &self ) {
+        pybind11::array_t< typename DuneType::ctype > centroids( { self.mesh().numCells( self.type() ), std::size_t( 2 ) } );
+        Dune::__PolygonGrid::cellCentroids( self.mesh(), self.type(), centroids.mutable_data() );
+        return centroids;
+      }''' )
+    edgeLengths = Method('edgeLengths', '''[]( DuneType &self ) {
+        pybind11::array_t< typename DuneType::ctype > lengths( self.mesh().numEdges( self.type() ) );
+        Dune::__PolygonGrid::edgeLengths( self.mesh(), self.type(), lengths.mutable_data() );
+        return lengths;
+      }''' )
+    edgeNormals = Method('edgeNormals', '''[]( DuneType &self ) {
+        pybind11::array_t< typename DuneType::ctype > normals( { self.mesh().numEdges( self.type() ), std::size_t( 2 ) } );
+        Dune::__PolygonGrid::edgeNormals( self.mesh(), self.type(), normals.mutable_data() );
+        return normals;
+      }''' )
+    edgeCells = Method('edgeCells', '''[]( DuneType &self ) {
+        // std::size_t( -1 ) becomes -1 for the boundary
+        pybind11::array_t< std::int64_t > cells( { self.mesh().numEdges( self.type() ), std::size_t( 2 ) } );
+        Dune::__PolygonGrid::edgeCells( self.mesh(), self.type(), reinterpret_cast< std::uint64_t * >( cells.mutable_data() ) );
+        return cells;
+      }''' )
+    cellVertices = Method('cellVertices', '''[]( DuneType &self ) {
+        const auto vertices = Dune::__PolygonGrid::cellVertices( self.mesh(), self.type() );
+        return pybind11::make_tuple( pybind11::array_t< std::int64_t >( vertices.offsets().size(), reinterpret_cast< const std::int64_t * >( vertices.offsets().data() ) ),
+                                     pybind11::array_t< std::int64_t >( vertices.values().size(), reinterpret_cast< const std::int64_t * >( vertices.values().data() ) ) );
+      }''' )
+    cellNeighbors = Method('cellNeighbors', '''[]( DuneType &self ) {
+        const auto neighbors = Dune::__PolygonGrid::cellNeighbors( self.mesh(), self.type() );
+        return pybind11::make_tuple( pybind11::array_t< std::int64_t >( neighbors.offsets().size(), reinterpret_cast< const std::int64_t * >( neighbors.offsets().data() ) ),
+                                     pybind11::array_t< std::int64_t >( neighbors.values().size(), reinterpret_cast< const std::int64_t * >( neighbors.values().data() ) ) );
+      }''' )
+    gridModule = module(includes, typeName, dualGridMethod, cachingStorage, meshProfile, meshStatistics, meshData,
+                        cellVolumes, cellCentroids, edgeLengths, edgeNormals, edgeCells, cellVertices, cellNeighbors)
+
+    if profile:
+        previous = setMeshProfiling(True)
+    try:
+        grid = gridModule.LeafGrid(gridModule.reader(domain))
+    finally:
+        if profile:
+            setMeshProfiling(previous)
     if dualGrid:
         grid = grid.hierarchicalGrid.dualGrid()
         grid = grid.leafView
     return grid
 
 
+def setMeshProfiling(enable):
+    """enable or disable profiling of mesh construction
+
+    The setting is independent of the grid type and applies to all grids
+    constructed afterwards. Returns the previous setting.
+    """
+    from dune.generator import algorithm
+    return algorithm.run('Dune::__PolygonGrid::setMeshProfiling', 'dune/polygongrid/meshprofile.hh', bool(enable))
+
+
 registry = {}
 registry["grid"] = {
         "Polygon": polygonGrid
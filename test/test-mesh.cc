@@ -1,25 +1,129 @@
 #include <config.h>
 
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if HAVE_ZLIB
+#include <zlib.h>
+#endif // #if HAVE_ZLIB
+
 #include <dune/common/parallel/mpihelper.hh>
 
+#include <dune/polygongrid/agglomeration.hh>
+#include <dune/polygongrid/bulkgeometry.hh>
+#include <dune/polygongrid/dgfreader.hh>
+#include <dune/polygongrid/entityvector.hh>
+#include <dune/polygongrid/fixedvalence.hh>
 #include <dune/polygongrid/mesh.hh>
+#include <dune/polygongrid/meshio.hh>
 #include <dune/polygongrid/meshobjects.hh>
 #include <dune/polygongrid/multivector.hh>
+#include <dune/polygongrid/orientation.hh>
+#include <dune/polygongrid/periodic.hh>
+#include <dune/polygongrid/positionlayout.hh>
+#include <dune/polygongrid/refinement.hh>
+#include <dune/polygongrid/renumbering.hh>
+#include <dune/polygongrid/repair.hh>
+#include <dune/polygongrid/sparsitypattern.hh>
+#include <dune/polygongrid/transfer.hh>
+#include <dune/polygongrid/validation.hh>
+#include <dune/polygongrid/vtksequencewriter.hh>
+#include <dune/polygongrid/vtkwriter.hh>
 
 using Dune::__PolygonGrid::Primal;
 using Dune::__PolygonGrid::Dual;
 using Dune::__PolygonGrid::primalMesh;
 using Dune::__PolygonGrid::dualMesh;
 
+using Dune::__PolygonGrid::DGFReader;
 using Dune::__PolygonGrid::MultiVector;
 using Dune::__PolygonGrid::Mesh;
 using Dune::__PolygonGrid::MeshStructure;
+using Dune::__PolygonGrid::VTKSequenceWriter;
+using Dune::__PolygonGrid::VTKWriter;
 
 using Dune::__PolygonGrid::boundaries;
 using Dune::__PolygonGrid::checkStructure;
 using Dune::__PolygonGrid::meshStructure;
 
 
+// readVTUArray
+// ------------
+
+template< class T >
+std::vector< T > readVTUArray ( const std::string &filename, const std::string &name )
+{
+  std::ifstream input( filename, std::ios::binary );
+  const std::string file( (std::istreambuf_iterator< char >( input )), std::istreambuf_iterator< char >() );
+  const std::size_t array = file.find( "Name=\"" + name + "\"" );
+  const std::size_t appended = file.find( "_", file.find( "<AppendedData encoding=\"raw\">" ) ) + 1u;
+  if( (array == std::string::npos) || (appended == std::string::npos) )
+    return std::vector< T >();
+  const char *data = file.data() + appended + std::stoull( file.substr( file.find( "offset=\"", array ) + 8u, 20u ) );
+  const bool compressed = (file.find( "compressor=" ) != std::string::npos);
+
+  std::vector< std::uint64_t > header( compressed ? 3u : 1u );
+  std::memcpy( header.data(), data, header.size()*sizeof( std::uint64_t ) );
+  data += header.size()*sizeof( std::uint64_t );
+
+  std::vector< char > raw;
+  if( !compressed )
+    raw.assign( data, data + header[ 0 ] );
+#if HAVE_ZLIB
+  else
+  {
+    std::vector< std::uint64_t > sizes( header[ 0 ] );
+    std::memcpy( sizes.data(), data, sizes.size()*sizeof( std::uint64_t ) );
+    data += sizes.size()*sizeof( std::uint64_t );
+    raw.resize( header[ 0 ] > 0u ? (header[ 0 ]-1u)*header[ 1 ] + header[ 2 ] : 0u );
+    for( std::size_t k = 0u; k < sizes.size(); data += sizes[ k++ ] )
+    {
+      uLongf size = (k+1u < sizes.size() ? header[ 1 ] : header[ 2 ]);
+      uncompress( reinterpret_cast< Bytef * >( raw.data() + k*header[ 1 ] ), &size, reinterpret_cast< const Bytef * >( data ), sizes[ k ] );
+    }
+  }
+#endif // #if HAVE_ZLIB
+
+  std::vector< T > values( raw.size() / sizeof( T ) );
+  std::memcpy( values.data(), raw.data(), values.size()*sizeof( T ) );
+  return values;
+}
+
+
+
+// persistentIds
+// -------------
+
+// ids of all nodes and edges of a mesh (empty, if they are not unique)
+std::set< std::size_t > persistentIds ( const Mesh< double > &mesh )
+{
+  std::set< std::size_t > ids;
+  std::size_t count = 0u;
+  for( auto type : { Primal, Dual } )
+  {
+    for( std::size_t i = 0u; i < mesh.numNodes( type ); ++i, ++count )
+      ids.insert( mesh.nodeId( Dune::__PolygonGrid::NodeIndex( i, type ) ) );
+  }
+  for( std::size_t e = 0u; e < mesh.numEdges( Dual ); ++e, ++count )
+    ids.insert( mesh.edgeId( e ) );
+  return (ids.size() == count ? ids : std::set< std::size_t >());
+}
+
+
+
 // main
 // ----
 
@@ -113,6 +217,1061 @@ try
     }
   }
 
+  // move vertices and compare with a freshly constructed mesh
+  for( auto &x : positions )
+    x = Dune::FieldVector< double, 2 >{ 2.0*x[ 0 ] + 0.5*x[ 1 ], x[ 1 ] - 1.0 };
+  mesh.setPositions( positions );
+  {
+    Mesh< double > moved( positions, polys );
+    for( auto type : { Primal, Dual } )
+    {
+      for( std::size_t i = 0u; i < mesh.numNodes( type ); ++i )
+      {
+        const Dune::__PolygonGrid::NodeIndex index( i, type );
+        if( (mesh.position( index ) - moved.position( index )).two_norm() > 1e-12 )
+        {
+          std::cerr << "Error: setPositions() yields wrong position for " << type << " node " << i << "." << std::endl;
+          std::abort();
+        }
+      }
+    }
+  }
+
+  mesh.movePositions( [] ( std::size_t, const Dune::FieldVector< double, 2 > &x ) { return x + Dune::FieldVector< double, 2 >( 1.0 ); } );
+  Mesh< double > moved( positions, polys );
+  for( std::size_t i = 0u; i < mesh.numNodes( Dual ); ++i )
+  {
+    const Dune::__PolygonGrid::NodeIndex index( i, Dual );
+    if( (mesh.position( index ) - moved.position( index ) - Dune::FieldVector< double, 2 >( 1.0 )).two_norm() > 1e-12 )
+    {
+      std::cerr << "Error: movePositions() yields wrong position for dual node " << i << "." << std::endl;
+      std::abort();
+    }
+  }
+
+  // coarsen by agglomeration until a single cell remains
+  std::shared_ptr< Mesh< double > > fine = std::make_shared< Mesh< double > >( positions, polys );
+  while( std::shared_ptr< Mesh< double > > coarse = Dune::__PolygonGrid::coarsen( fine ) )
+  {
+    if( !checkStructure( { coarse->nodes( Primal ), coarse->nodes( Dual ) } ) )
+    {
+      std::cerr << "Error: Coarse mesh structure not valid." << std::endl;
+      std::abort();
+    }
+    if( (coarse->numCells( Primal ) >= fine->numCells( Primal )) || (fine->level() != coarse->level() + 1) || coarse->leaf() )
+    {
+      std::cerr << "Error: Invalid mesh hierarchy." << std::endl;
+      std::abort();
+    }
+    for( std::size_t i = 0u; i < coarse->numCells( Primal ); ++i )
+    {
+      for( std::size_t j : coarse->children()[ i ] )
+      {
+        if( fine->father( j ) != i )
+        {
+          std::cerr << "Error: Parent and child maps do not match." << std::endl;
+          std::abort();
+        }
+      }
+    }
+
+    // vertices, unmerged cells and all coarse edges keep their ids
+    const std::set< std::size_t > fineIds = persistentIds( *fine ), coarseIds = persistentIds( *coarse );
+    bool persistent = !fineIds.empty() && !coarseIds.empty();
+    for( std::size_t v = 0u; v < coarse->numVertices( Primal ); ++v )
+      persistent &= (fineIds.count( coarse->nodeId( Dune::__PolygonGrid::NodeIndex( v, Primal ) ) ) == 1u);
+    for( std::size_t e = 0u; e < coarse->numEdges( Primal ); ++e )
+      persistent &= (fineIds.count( coarse->edgeId( e ) ) == 1u);
+    for( std::size_t i = 0u; i < coarse->numCells( Primal ); ++i )
+    {
+      const std::size_t id = coarse->nodeId( Dune::__PolygonGrid::NodeIndex( i, Dual ) );
+      if( coarse->children().size( i ) == 1u )
+        persistent &= (id == fine->nodeId( Dune::__PolygonGrid::NodeIndex( coarse->children()[ i ][ 0 ], Dual ) ));
+      else
+        persistent &= (fineIds.count( id ) == 0u);
+    }
+    if( !persistent )
+    {
+      std::cerr << "Error: Agglomeration does not keep the ids of unchanged entities." << std::endl;
+      std::abort();
+    }
+    fine = coarse;
+  }
+  if( fine->numCells( Primal ) != 1u )
+  {
+    std::cerr << "Error: Agglomeration does not end with a single cell." << std::endl;
+    std::abort();
+  }
+  {
+    const std::shared_ptr< Mesh< double > > copy = fine->detachedCopy();
+    if( (persistentIds( *copy ) != persistentIds( *fine )) || !copy->leaf() || fine->leaf() || (copy->numCells( Primal ) != 1u) )
+    {
+      std::cerr << "Error: Detached copy keeps hierarchy or changes ids." << std::endl;
+      std::abort();
+    }
+  }
+
+  // sparsity patterns
+  {
+    Mesh< double > mesh( positions, polys );
+    const MultiVector< std::size_t > expected = { { 0, 1, 2 }, { 0, 1, 2, 3 }, { 0, 1, 2, 3, 4, 5 }, { 1, 2, 3, 5 }, { 2, 4 }, { 2, 3, 5 } };
+    if( (Dune::__PolygonGrid::cellPattern( mesh, Primal ).values() != expected.values())
+        || (Dune::__PolygonGrid::cellPattern( polys, numVertices ).values() != expected.values())
+        || (Dune::__PolygonGrid::cellPattern( polys, numVertices ).offsets() != expected.offsets()) )
+    {
+      std::cerr << "Error: Wrong primal cell pattern." << std::endl;
+      std::abort();
+    }
+
+    std::vector< std::vector< std::size_t > > vertexNeighbors( numVertices );
+    for( auto polygon : polys )
+    {
+      for( std::size_t j = 0u; j < polygon.size(); ++j )
+      {
+        vertexNeighbors[ polygon[ j ] ].push_back( polygon[ (j+1) % polygon.size() ] );
+        vertexNeighbors[ polygon[ (j+1) % polygon.size() ] ].push_back( polygon[ j ] );
+      }
+    }
+    const MultiVector< std::size_t > vertexPattern = Dune::__PolygonGrid::vertexPattern( mesh, Primal );
+    for( std::size_t v = 0u; v < numVertices; ++v )
+    {
+      vertexNeighbors[ v ].push_back( v );
+      std::sort( vertexNeighbors[ v ].begin(), vertexNeighbors[ v ].end() );
+      vertexNeighbors[ v ].erase( std::unique( vertexNeighbors[ v ].begin(), vertexNeighbors[ v ].end() ), vertexNeighbors[ v ].end() );
+      if( !std::equal( vertexNeighbors[ v ].begin(), vertexNeighbors[ v ].end(), vertexPattern[ v ].begin(), vertexPattern[ v ].end() ) )
+      {
+        std::cerr << "Error: Wrong primal vertex pattern in row " << v << "." << std::endl;
+        std::abort();
+      }
+    }
+
+    for( auto type : { Primal, Dual } )
+    {
+      for( bool second : { false, true } )
+      {
+        for( const MultiVector< std::size_t > &pattern : { Dune::__PolygonGrid::cellPattern( mesh, type, second ), Dune::__PolygonGrid::vertexPattern( mesh, type, second ), Dune::__PolygonGrid::edgePattern( mesh, type, second ) } )
+        {
+          for( std::size_t i = 0u; i < pattern.size(); ++i )
+          {
+            auto row = pattern[ i ];
+            bool valid = std::is_sorted( row.begin(), row.end() ) && std::binary_search( row.begin(), row.end(), i );
+            for( std::size_t j : row )
+              valid &= (j < pattern.size()) && std::binary_search( pattern[ j ].begin(), pattern[ j ].end(), i );
+            if( !valid )
+            {
+              std::cerr << "Error: Invalid " << type << " sparsity pattern in row " << i << "." << std::endl;
+              std::abort();
+            }
+          }
+        }
+      }
+    }
+    if( (Dune::__PolygonGrid::edgePattern( mesh, Dual ).size() != mesh.numEdges( Dual ))
+        || (Dune::__PolygonGrid::vertexPattern( mesh, Dual ).size() != mesh.numVertices( Dual ))
+        || (Dune::__PolygonGrid::cellPattern( mesh, Dual, true ).values().size() <= Dune::__PolygonGrid::cellPattern( mesh, Dual ).values().size()) )
+    {
+      std::cerr << "Error: Wrong size of dual sparsity patterns." << std::endl;
+      std::abort();
+    }
+  }
+
+  // periodic identification of a structured quadrilateral mesh
+  for( int periodicY = 0; periodicY < 2; ++periodicY )
+  {
+    const std::size_t nx = 3, ny = 3;
+    std::vector< Dune::FieldVector< double, 2 > > vertices;
+    for( std::size_t j = 0u; j <= ny; ++j )
+      for( std::size_t i = 0u; i <= nx; ++i )
+        vertices.push_back( Dune::FieldVector< double, 2 >{ double( i ), double( j ) } );
+    MultiVector< std::size_t > polygons;
+    for( std::size_t j = 0u; j < ny; ++j )
+      for( std::size_t i = 0u; i < nx; ++i )
+        polygons.push_back( { j*(nx+1) + i, j*(nx+1) + i+1, (j+1)*(nx+1) + i+1, (j+1)*(nx+1) + i } );
+
+    std::vector< Dune::FieldVector< double, 2 > > translations = { { double( nx ), 0.0 } };
+    if( periodicY )
+      translations.push_back( Dune::FieldVector< double, 2 >{ 0.0, double( ny ) } );
+    const MultiVector< Dune::FieldVector< double, 2 > > shifts = Dune::__PolygonGrid::identifyPeriodicBoundaries( vertices, polygons, translations );
+    Mesh< double > mesh( vertices, polygons, shifts );
+
+    if( !checkStructure( { mesh.nodes( Primal ), mesh.nodes( Dual ) } ) || !mesh.periodic() || !Dune::__PolygonGrid::validateMesh( mesh ).valid()
+        || (mesh.numVertices( Primal ) != nx*(ny+1-periodicY)) || (mesh.numBoundaries( Primal ) != (periodicY ? 0u : 2u*nx)) )
+    {
+      std::cerr << "Error: Invalid periodic mesh structure." << std::endl;
+      std::abort();
+    }
+
+    // check that the cells are closed and consistent with their neighbors across the periodic boundaries
+    for( auto type : { Primal, Dual } )
+    {
+      double volume = 0.0;
+      for( std::size_t c = 0u; c < mesh.numCells( type ); ++c )
+      {
+        const Dune::__PolygonGrid::NodeIndex cell( c, Dune::__PolygonGrid::dual( type ) );
+        auto source = mesh.end( cell );
+        source += -1;
+        for( auto h = mesh.begin( cell ); h != mesh.end( cell ); source = h, ++h )
+        {
+          const Dune::FieldVector< double, 2 > x = mesh.position( source ), y = mesh.position( h );
+          volume += 0.5 * (x[ 0 ]*y[ 1 ] - x[ 1 ]*y[ 0 ]);
+          if( (mesh.position( mesh.flip( h ) ) + mesh.neighborShift( h ) - x).two_norm() > 1e-12 )
+          {
+            std::cerr << "Error: Periodic " << type << " half edge inconsistent with its neighbor." << std::endl;
+            std::abort();
+          }
+        }
+      }
+      if( std::abs( volume - double( nx*ny ) ) > 1e-12 )
+      {
+        std::cerr << "Error: Periodic " << type << " cells do not cover domain (volume = " << volume << ")." << std::endl;
+        std::abort();
+      }
+    }
+  }
+
+  // refine some cells locally, then all cells, and transfer cell data
+  std::shared_ptr< Mesh< double > > coarse = std::make_shared< Mesh< double > >( positions, polys );
+  for( std::vector< char > marked : { std::vector< char >{ 1, 0, 1, 0, 0, 0 }, std::vector< char >() } )
+  {
+    marked.resize( coarse->numCells( Primal ), 1 );
+    std::shared_ptr< Mesh< double > > fine = Dune::__PolygonGrid::refine( coarse, marked );
+    if( !checkStructure( { fine->nodes( Primal ), fine->nodes( Dual ) } ) )
+    {
+      std::cerr << "Error: Refined mesh structure not valid." << std::endl;
+      std::abort();
+    }
+
+    std::vector< Dune::FieldVector< double, 2 > > vertices( fine->numVertices( Primal ) );
+    for( std::size_t v = 0u; v < vertices.size(); ++v )
+      vertices[ v ] = fine->position( Dune::__PolygonGrid::NodeIndex( v, Primal ) );
+    MultiVector< std::size_t > polygons;
+    for( std::size_t i = 0u; i < fine->numCells( Primal ); ++i )
+    {
+      const Dune::__PolygonGrid::NodeIndex cell( i, Dual );
+      std::vector< std::size_t > polygon;
+      for( auto h = fine->begin( cell ); h != fine->end( cell ); ++h )
+        polygon.push_back( fine->target( h ) );
+      polygons.push_back( polygon );
+    }
+    if( fine->numBoundaries( Primal ) != boundaries( vertices.size(), polygons ).size() )
+    {
+      std::cerr << "Error: Refined mesh has wrong number of boundaries." << std::endl;
+      std::abort();
+    }
+
+    // vertices and unmarked cells keep their ids, the children of marked cells obtain new ones
+    const std::set< std::size_t > coarseIds = persistentIds( *coarse ), fineIds = persistentIds( *fine );
+    bool persistent = !coarseIds.empty() && !fineIds.empty();
+    for( std::size_t v = 0u; v < coarse->numVertices( Primal ); ++v )
+      persistent &= (fine->nodeId( Dune::__PolygonGrid::NodeIndex( v, Primal ) ) == coarse->nodeId( Dune::__PolygonGrid::NodeIndex( v, Primal ) ));
+    for( std::size_t i = 0u; i < coarse->numCells( Primal ); ++i )
+    {
+      for( std::size_t j : coarse->children()[ i ] )
+      {
+        const std::size_t id = fine->nodeId( Dune::__PolygonGrid::NodeIndex( j, Dual ) );
+        persistent &= (marked[ i ] ? coarseIds.count( id ) == 0u : id == coarse->nodeId( Dune::__PolygonGrid::NodeIndex( i, Dual ) ));
+      }
+      if( marked[ i ] )
+        continue;
+      // edges of unmarked cells connecting two old vertices have not been split
+      const Dune::__PolygonGrid::NodeIndex cell( i, Dual );
+      for( auto h = fine->begin( cell ); h != fine->end( cell ); ++h )
+      {
+        if( (fine->target( h ) < coarse->numVertices( Primal )) && (fine->target( fine->flip( h ) ) < coarse->numVertices( Primal )) )
+          persistent &= (coarseIds.count( fine->edgeId( fine->edgeIndex( h ) ) ) == 1u);
+      }
+    }
+    if( !persistent )
+    {
+      std::cerr << "Error: Refinement does not keep the ids of unchanged entities." << std::endl;
+      std::abort();
+    }
+
+    // the patched structure coincides with the one built from scratch
+    MultiVector< std::size_t > fineBoundaries;
+    for( std::size_t i = 0u; i < fine->numBoundaries( Primal ); ++i )
+    {
+      const auto edge = fine->nodes( Dual )[ fine->numCells( Primal ) + i ];
+      fineBoundaries.push_back( { edge[ 0 ].first, edge[ 1 ].first } );
+    }
+    const MeshStructure rebuilt = meshStructure( vertices.size(), polygons, fineBoundaries );
+    for( auto type : { Primal, Dual } )
+    {
+      if( (fine->nodes( type ).offsets() != rebuilt[ type ].offsets()) || (fine->nodes( type ).values() != rebuilt[ type ].values()) )
+      {
+        std::cerr << "Error: Refined " << type << " mesh structure differs from rebuilt one." << std::endl;
+        std::abort();
+      }
+    }
+
+    Dune::__PolygonGrid::RestrictProlong< double > restrictProlong( fine );
+    std::vector< double > u( coarse->numCells( Primal ) ), v( fine->numCells( Primal ) ), w( u.size() );
+    for( std::size_t i = 0u; i < u.size(); ++i )
+    {
+      u[ i ] = 1.0 + double( i );
+      const double volume = Dune::__PolygonGrid::cellVolume( *coarse, Dune::__PolygonGrid::NodeIndex( i, Dual ) );
+      double childVolume = 0.0;
+      for( std::size_t j : coarse->children()[ i ] )
+        childVolume += Dune::__PolygonGrid::cellVolume( *fine, Dune::__PolygonGrid::NodeIndex( j, Dual ) );
+      if( (std::abs( volume - childVolume ) > 1e-12) || (coarse->children().size( i ) != (marked[ i ] ? coarse->size( Dune::__PolygonGrid::NodeIndex( i, Dual ) ) : 1u)) )
+      {
+        std::cerr << "Error: Children of cell " << i << " do not cover their father." << std::endl;
+        std::abort();
+      }
+    }
+    restrictProlong.prolong( u, v );
+    restrictProlong.restrict( v, w );
+    for( std::size_t i = 0u; i < u.size(); ++i )
+    {
+      if( std::abs( u[ i ] - w[ i ] ) > 1e-12 )
+      {
+        std::cerr << "Error: Restriction does not invert prolongation." << std::endl;
+        std::abort();
+      }
+    }
+    coarse = fine;
+  }
+
+  // boundary ids (side of the parallelogram, i.e., direction of the boundary edge) are inherited by refinement and agglomeration
+  auto side = [] ( const Mesh< double > &mesh, std::size_t i ) {
+      const auto h = ++mesh.begin( Dune::__PolygonGrid::NodeIndex( mesh.numCells( Primal ) + i, Dual ) );
+      const Dune::FieldVector< double, 2 > d = mesh.position( mesh.target( h ) ) - mesh.position( mesh.target( mesh.flip( h ) ) );
+      const double pi = std::acos( -1.0 );
+      return 1 + static_cast< int >( std::floor( (std::atan2( d[ 1 ], d[ 0 ] ) + 1.25*pi) / (0.5*pi) ) ) % 4;
+    };
+  auto checkBoundaryIds = [ &side ] ( const Mesh< double > &mesh ) {
+      for( std::size_t i = 0u; i < mesh.numBoundaries( Primal ); ++i )
+      {
+        const Dune::__PolygonGrid::NodeIndex node( mesh.numCells( Primal ) + i, Dual );
+        const Dune::__PolygonGrid::NodeIndex dualNode( mesh.numVertices( Primal ) + 2u*i+1u, Primal );
+        if( (mesh.boundaryId( node ) != side( mesh, i )) || (mesh.boundaryId( dualNode ) != side( mesh, i )) )
+        {
+          std::cerr << "Error: Wrong boundary id for boundary " << i << "." << std::endl;
+          std::abort();
+        }
+      }
+    };
+
+  std::shared_ptr< Mesh< double > > bndMesh = std::make_shared< Mesh< double > >( positions, polys );
+  const auto bndVertices = Dune::__PolygonGrid::boundaryVertices( *bndMesh, polys );
+  std::vector< int > ids( bndVertices.size() );
+  for( std::size_t i = 0u; i < ids.size(); ++i )
+  {
+    const auto h = ++bndMesh->begin( Dune::__PolygonGrid::NodeIndex( bndMesh->numCells( Primal ) + i, Dual ) );
+    const std::size_t b0 = bndMesh->target( bndMesh->flip( h ) ), b1 = bndMesh->target( h );
+    if( bndVertices[ i ] != std::make_pair( std::min( b0, b1 ), std::max( b0, b1 ) ) )
+    {
+      std::cerr << "Error: Wrong vertices for boundary " << i << "." << std::endl;
+      std::abort();
+    }
+    ids[ i ] = side( *bndMesh, i );
+  }
+  bndMesh->setBoundaryIds( ids );
+  checkBoundaryIds( *bndMesh );
+
+  std::shared_ptr< Mesh< double > > bndFine = Dune::__PolygonGrid::refine( bndMesh, std::vector< char >( bndMesh->numCells( Primal ), 1 ) );
+  checkBoundaryIds( *bndFine );
+  for( std::shared_ptr< Mesh< double > > bndCoarse = bndFine; bndCoarse; bndCoarse = Dune::__PolygonGrid::coarsen( bndCoarse ) )
+    checkBoundaryIds( *bndCoarse );
+
+  // streaming DGF reader
+  {
+    std::istringstream dgf( "DGF\n"
+                            "% comment\n"
+                            "Vertex % with parameters\n"
+                            "firstindex 1\n"
+                            "parameters 1\n"
+                            "0 0 1.5\n" "1 0 2.5e-1\n" "2 0 -3\n" "0 1 0.1\n" "1 1 .5\n" "2 1.0 1E2\n"
+                            "#\n"
+                            "Cube\n"
+                            "parameters 1\n"
+                            "1 2 4 5 7\n"
+                            "#\n"
+                            "Polygon\n"
+                            "2 3 6 5\n"
+                            "#\n"
+                            "BoundarySegments\n"
+                            "2 1 2\n"
+                            "3 3 6 : outflow\n"
+                            "#\n"
+                            "GridParameter\n"
+                            "name test\n"
+                            "#\n" );
+    DGFReader< double > reader;
+    if( !reader.read( dgf ) )
+    {
+      std::cerr << "Error: DGF reader rejects polygonal DGF file." << std::endl;
+      std::abort();
+    }
+    const MultiVector< std::size_t > dgfPolygons = reader.polygons();
+    const std::vector< double > vertexParameters = { 1.5, 0.25, -3.0, 0.1, 0.5, 100.0 };
+    bool valid = (reader.vertices().size() == 6u) && (reader.vertices()[ 5 ] == Dune::FieldVector< double, 2 >{ 2.0, 1.0 })
+                 && (reader.numVertexParameters() == 1) && (reader.numElementParameters() == 1) && (dgfPolygons.size() == 2u)
+                 && (std::vector< std::size_t >( dgfPolygons[ 0 ].begin(), dgfPolygons[ 0 ].end() ) == std::vector< std::size_t >{ 0, 1, 4, 3 })
+                 && (std::vector< std::size_t >( dgfPolygons[ 1 ].begin(), dgfPolygons[ 1 ].end() ) == std::vector< std::size_t >{ 1, 2, 5, 4 })
+                 && (reader.elementParameters() == std::vector< std::vector< double > >{ { 7.0 } })
+                 && (reader.boundarySegments().size() == 2u) && (reader.boundarySegments()[ std::make_pair( 0u, 1u ) ].first == 2)
+                 && (reader.boundarySegments()[ std::make_pair( 2u, 5u ) ].second == "outflow");
+    for( std::size_t i = 0u; valid && (i < vertexParameters.size()); ++i )
+      valid = (reader.vertexParameters()[ i ] == std::vector< double >{ vertexParameters[ i ] });
+    if( !valid )
+    {
+      std::cerr << "Error: DGF reader yields wrong mesh." << std::endl;
+      std::abort();
+    }
+
+    // element counts by block type, skipping blocks that require the generic DGF parser
+    std::istringstream generic( "DGF\nVertex\nfirstindex 1\n0 0\n1 0\n0 1\n1 1\n2 0.5\n#\nInterval\n0 0\n1 1\n1 1\n#\n"
+                                "Cube\n1 2 3 4\n#\nPolygon\n2 5 4\n#\nSimplex\n1 2 3\n2 4 3\n#\nBoundaryDomain\ndefault 1\n#\n" );
+    const std::size_t numTrailing = reader.countElements( generic, { Dune::__PolygonGrid::__DGFReader::Simplex, Dune::__PolygonGrid::__DGFReader::Polygon } );
+    generic.clear();
+    generic.seekg( 0 );
+    const std::size_t numCubes = reader.countElements( generic, { Dune::__PolygonGrid::__DGFReader::Cube } );
+    if( (numTrailing != 3u) || (numCubes != 1u) )
+    {
+      std::cerr << "Error: DGF reader counts wrong number of elements." << std::endl;
+      std::abort();
+    }
+
+    for( const std::string number : { "0.1", "-123.456e-7", "3.141592653589793", "1e300", "0.30000000000000004", "12345678901234567890123" } )
+    {
+      double value;
+      Dune::__PolygonGrid::__DGFReader::parseReal( number.data(), number.data() + number.size(), value );
+      if( value != std::strtod( number.c_str(), nullptr ) )
+      {
+        std::cerr << "Error: DGF reader parses " << number << " as " << value << "." << std::endl;
+        std::abort();
+      }
+    }
+
+    // parallel DGF and binary readers on a structured mesh large enough to be split into many ranges
+    const std::size_t n = 200u;
+    {
+      std::ofstream output( "test-mesh.dgf" );
+      output << "DGF\nVertex\nfirstindex 1\n";
+      for( std::size_t j = 0u; j <= n; ++j )
+        for( std::size_t i = 0u; i <= n; ++i )
+          output << double( i ) / double( n ) << " " << double( j ) / double( n ) << "\n";
+      output << "#\nCube\nparameters 1\n";
+      for( std::size_t j = 0u; j < n; ++j )
+        for( std::size_t i = 0u; i < n; ++i )
+          output << (j*(n+1)+i+1) << " " << (j*(n+1)+i+2) << " " << ((j+1)*(n+1)+i+1) << " " << ((j+1)*(n+1)+i+2) << " " << i << "\n";
+      output << "#\nPolygon\n1 2 " << (n+2) << "\n#\n";
+    }
+    std::ifstream input( "test-mesh.dgf" );
+    DGFReader< double > sequential;
+    sequential.read( input );
+    const MultiVector< std::size_t > sequentialPolygons = sequential.polygons();
+
+    std::vector< Dune::FieldVector< double, 2 > > parallelVertices, binaryVertices;
+    MultiVector< std::size_t > parallelPolygons, binaryPolygons;
+    Dune::__PolygonGrid::readDGFParallel( "test-mesh.dgf", parallelVertices, parallelPolygons );
+    Dune::__PolygonGrid::writeBinaryMesh( "test-mesh.bin", parallelVertices, parallelPolygons );
+    Dune::__PolygonGrid::readBinaryMesh( "test-mesh.bin", binaryVertices, binaryPolygons );
+    if( (parallelPolygons.size() != n*n + 1u) || (parallelVertices != sequential.vertices()) || (parallelPolygons.offsets() != sequentialPolygons.offsets()) || (parallelPolygons.values() != sequentialPolygons.values())
+        || (binaryVertices != parallelVertices) || (binaryPolygons.offsets() != parallelPolygons.offsets()) || (binaryPolygons.values() != parallelPolygons.values()) )
+    {
+      std::cerr << "Error: Parallel mesh readers yield different mesh." << std::endl;
+      std::abort();
+    }
+
+    // a header claiming more vertices than the file contains is rejected before allocating
+    {
+      std::fstream binary( "test-mesh.bin", std::ios::binary | std::ios::in | std::ios::out );
+      const std::uint64_t numVertices = std::numeric_limits< std::uint64_t >::max() / 4u;
+      binary.seekp( 8 );
+      binary.write( reinterpret_cast< const char * >( &numVertices ), sizeof( numVertices ) );
+    }
+    bool rejected = false;
+    try
+    {
+      Dune::__PolygonGrid::readBinaryMesh( "test-mesh.bin", binaryVertices, binaryPolygons );
+    }
+    catch( const Dune::IOError & )
+    {
+      rejected = true;
+    }
+    if( !rejected )
+    {
+      std::cerr << "Error: Binary mesh reader accepts corrupted header." << std::endl;
+      std::abort();
+    }
+
+    std::istringstream interval( "DGF\nInterval\n0 0\n1 1\n4 4\n#\n" );
+    if( reader.read( interval ) )
+    {
+      std::cerr << "Error: DGF reader accepts Interval block." << std::endl;
+      std::abort();
+    }
+  }
+
+  // construction profile and statistics
+  {
+    Dune::__PolygonGrid::setMeshProfiling( true );
+    Mesh< double > mesh( positions, polys );
+    Dune::__PolygonGrid::setMeshProfiling( false );
+    const Dune::__PolygonGrid::MeshStatistics statistics = Dune::__PolygonGrid::meshStatistics( mesh );
+    std::cout << mesh.profile() << statistics;
+
+    std::size_t sum = 0u;
+    for( const auto &valence : statistics.valences )
+      sum += valence.first * valence.second;
+    const bool valid = (mesh.profile().phases.size() == 6u) && (mesh.profile().phases[ 1 ].name == "meshStructure") && (mesh.profile().phases[ 1 ].bytes > 0u)
+                       && (statistics.polygonSizes == std::map< std::size_t, std::size_t >{ { 3, 1 }, { 4, 3 }, { 5, 1 }, { 6, 1 } })
+                       && (sum == 2u*statistics.numEdges) && (statistics.numBoundaries == 10u) && (statistics.valences.at( 2 ) == 4u)
+                       && Mesh< double >( positions, polys ).profile().empty();
+    if( !valid )
+    {
+      std::cerr << "Error: Wrong mesh profile or statistics." << std::endl;
+      std::abort();
+    }
+  }
+
+  // dual data built lazily (and concurrently) agrees with the eagerly built one
+  {
+    auto move = [] ( std::size_t, const Dune::FieldVector< double, 2 > &x ) { return x * 2.0; };
+    Mesh< double > eager( positions, polys );
+    eager.movePositions( move );
+    eager.classifyConvexity();
+
+    Dune::__PolygonGrid::setMeshProfiling( true );
+    Mesh< double > lazy( positions, polys, true );
+    Dune::__PolygonGrid::setMeshProfiling( false );
+    lazy.movePositions( move );
+    lazy.classifyConvexity();
+    bool valid = !lazy.dualBuilt() && (lazy.profile().phases.size() == 4u) && lazy.positions( Dual ).empty() && lazy.edgeIndices( Dual ).empty()
+                 && (lazy.positions( Primal ) == eager.positions( Primal )) && (lazy.edgeIndices( Primal ) == eager.edgeIndices( Primal ));
+
+    std::vector< std::thread > threads;
+    for( int t = 0; t < 4; ++t )
+      threads.emplace_back( [ &lazy ] () { lazy.buildDual(); } );
+    for( std::thread &thread : threads )
+      thread.join();
+    std::cout << lazy.profile();
+
+    valid &= lazy.dualBuilt() && (lazy.profile().phases.size() == 6u) && (lazy.profile().phases[ 4 ].name == "dualPositions") && (lazy.profile().phases[ 4 ].bytes > 0u);
+    for( auto type : { Primal, Dual } )
+    {
+      valid &= (lazy.positions( type ) == eager.positions( type )) && (lazy.edgeIndices( type ) == eager.edgeIndices( type ));
+      for( std::size_t i = 0u; i < eager.numRegularNodes( type ); ++i )
+        valid &= (lazy.convex( Dune::__PolygonGrid::NodeIndex( i, type ) ) == eager.convex( Dune::__PolygonGrid::NodeIndex( i, type ) ));
+    }
+    if( !valid )
+    {
+      std::cerr << "Error: Lazily built dual data differs from the eagerly built one." << std::endl;
+      std::abort();
+    }
+  }
+
+  // precomputed edge indices agree with the mesh structure
+  {
+    Mesh< double > mesh( positions, polys );
+    bool valid = true;
+    for( auto type : { Primal, Dual } )
+    {
+      const auto &cells = mesh.nodes( dual( type ) );
+      for( std::size_t k = 0u; k < cells.values().size(); ++k )
+      {
+        const Dune::__PolygonGrid::HalfEdgeIndex h( k, type );
+        const Dune::__PolygonGrid::HalfEdgeIndex d = mesh.dual( h );
+        valid &= (mesh.edgeIndex( h ) == mesh.edgeIndex( mesh.flip( h ) ))
+                 && (mesh.edgeIndex( h ) == mesh.edgeIndex( d )) && (mesh.edgeIndex( h ) < cells.values().size() / 2u)
+                 && (mesh.edgeIndices( type )[ k ] == mesh.edgeIndex( h ));
+      }
+    }
+    const auto memory = mesh.memoryUsage();
+    valid &= std::any_of( memory.begin(), memory.end(), [] ( const std::pair< std::string, std::size_t > &array ) { return (array.first == "edgeIndices[dual]") && (array.second > 0u); } );
+    if( !valid )
+    {
+      std::cerr << "Error: Precomputed edge indices are wrong." << std::endl;
+      std::abort();
+    }
+  }
+
+  // reverse Cuthill-McKee renumbering of a structured mesh with scrambled cell order
+  {
+    const std::size_t n = 16;
+    std::vector< Dune::FieldVector< double, 2 > > vertices;
+    for( std::size_t j = 0u; j <= n; ++j )
+      for( std::size_t i = 0u; i <= n; ++i )
+        vertices.push_back( Dune::FieldVector< double, 2 >{ double( i ), double( j ) } );
+    MultiVector< std::size_t > polygons;
+    for( std::size_t c = 0u; c < n*n; ++c )
+    {
+      // 7 is coprime to n*n, so this visits all cells in scrambled order
+      const std::size_t i = (7u*c) % n, j = ((7u*c) / n) % n;
+      polygons.push_back( { j*(n+1) + i, j*(n+1) + i+1, (j+1)*(n+1) + i+1, (j+1)*(n+1) + i } );
+    }
+    Mesh< double > mesh( vertices, polygons );
+
+    const MultiVector< std::size_t > pattern = Dune::__PolygonGrid::cellPattern( mesh, Primal );
+    const std::vector< std::size_t > permutation = Dune::__PolygonGrid::reverseCuthillMcKee( mesh );
+    std::vector< bool > used( permutation.size(), false );
+    for( std::size_t p : permutation )
+      used[ p ] = true;
+    const std::size_t before = Dune::__PolygonGrid::bandwidth( pattern ), after = Dune::__PolygonGrid::bandwidth( pattern, permutation );
+    std::cout << "Cell bandwidth: " << before << " (insertion order), " << after << " (reverse Cuthill-McKee)" << std::endl;
+
+    Mesh< double > renumbered( vertices, Dune::__PolygonGrid::permuteRows( polygons, permutation ) );
+    bool valid = std::all_of( used.begin(), used.end(), [] ( bool u ) { return u; } ) && (after <= n+1u) && (after < before)
+                 && (Dune::__PolygonGrid::bandwidth( Dune::__PolygonGrid::cellPattern( renumbered, Primal ) ) == after)
+                 && (Dune::__PolygonGrid::cellPattern( polygons, vertices.size() ).values() == pattern.values());
+    for( std::size_t i = 0u; valid && (i < n*n); ++i )
+      valid = (Dune::__PolygonGrid::cellCentroid( renumbered, Dune::__PolygonGrid::NodeIndex( permutation[ i ], Dual ) ) == Dune::__PolygonGrid::cellCentroid( mesh, Dune::__PolygonGrid::NodeIndex( i, Dual ) ));
+    if( !valid )
+    {
+      std::cerr << "Error: Reverse Cuthill-McKee renumbering failed (bandwidth " << before << " -> " << after << ")." << std::endl;
+      std::abort();
+    }
+  }
+
+  // validation of meshes and raw polygon input
+  {
+    typedef Dune::__PolygonGrid::ValidationReport ValidationReport;
+
+    Mesh< double > mesh( positions, polys );
+    const ValidationReport report = Dune::__PolygonGrid::validateMesh( mesh );
+    if( !report.valid() || !Dune::__PolygonGrid::validatePolygons( positions, polys ).valid() )
+    {
+      std::cerr << "Error: Valid mesh does not pass validation:" << std::endl << report;
+      std::abort();
+    }
+
+    // vertex 2 joins two fans, polygon 3 is clockwise, polygon 4 is a bow tie,
+    // vertex 15 is close to vertex 0, and vertex 16 coincides with vertex 1
+    const std::vector< Dune::FieldVector< double, 2 > > vertices
+      = { { 0.0, 0.0 }, { 1.0, 0.0 }, { 1.0, 1.0 }, { 0.0, 1.0 }, { 2.0, 0.0 }, { 2.0, 1.0 }, { 2.0, 2.0 }, { 1.0, 2.0 },
+          { 3.0, 0.0 }, { 3.0, 1.0 }, { 4.0, 0.0 }, { 5.0, 0.0 }, { 6.0, 1.0 }, { 6.0, 0.0 }, { 5.0, 1.0 }, { 1e-12, 0.0 }, { 1.0, 0.0 } };
+    MultiVector< std::size_t > polygons = { { 0, 1, 2, 3 }, { 1, 4, 5, 2 }, { 2, 6, 7 }, { 8, 9, 10 }, { 11, 12, 13, 14 } };
+
+    auto equals = [] ( const ValidationReport::Result &result, std::vector< std::size_t > offenders ) {
+        return (result.count == offenders.size()) && (result.offenders == offenders);
+      };
+
+    Dune::__PolygonGrid::ValidationOptions options;
+    options.tolerance = 1e-8;
+    ValidationReport invalid = Dune::__PolygonGrid::validatePolygons( vertices, polygons, options );
+    bool valid = !invalid.valid() && equals( invalid[ ValidationReport::DegeneratePolygons ], {} )
+                 && equals( invalid[ ValidationReport::Orientation ], { 3, 4 } ) && equals( invalid[ ValidationReport::SelfIntersections ], { 4 } )
+                 && equals( invalid[ ValidationReport::DuplicateVertices ], { 15, 16 } ) && equals( invalid[ ValidationReport::NonManifoldVertices ], { 2 } );
+
+    // exact duplicates only, at most one offender recorded
+    options.tolerance = 0.0;
+    options.maxOffenders = 1u;
+    polygons.push_back( { 0, 1 } );
+    polygons.push_back( { 0, 17, 3 } );
+    invalid = Dune::__PolygonGrid::validatePolygons( vertices, polygons, options );
+    valid = valid && (invalid[ ValidationReport::DuplicateVertices ].count == 1u) && (invalid[ ValidationReport::DuplicateVertices ].offenders == std::vector< std::size_t >{ 16 })
+            && (invalid[ ValidationReport::DegeneratePolygons ].count == 2u) && (invalid[ ValidationReport::DegeneratePolygons ].offenders == std::vector< std::size_t >{ 5 });
+    if( !valid )
+    {
+      std::cerr << "Error: Validation yields wrong report:" << std::endl << invalid;
+      std::abort();
+    }
+  }
+
+  // repair of dirty input: duplicate vertices, repeated corners, zero area and a non-manifold vertex
+  {
+    std::vector< Dune::FieldVector< double, 2 > > vertices
+      = { { 0.0, 0.0 }, { 1.0, 0.0 }, { 1.0, 1.0 }, { 0.0, 1.0 }, { 1.0, 0.0 }, { 2.0, 0.0 },
+          { 2.0, 1.0 }, { 1.0, 1.0 + 1e-10 }, { 3.0, 1.0 }, { 3.0, 2.0 }, { 5.0, 5.0 } };
+    MultiVector< std::size_t > polygons = { { 0, 1, 2, 3 }, { 4, 5, 6, 6, 7 }, { 0, 1, 1 }, { 0, 5, 1 }, { 6, 8, 9 } };
+
+    const Dune::__PolygonGrid::RepairReport report = Dune::__PolygonGrid::repairPolygons( vertices, polygons, 1e-8 );
+    const std::size_t invalid = Dune::__PolygonGrid::RepairReport::invalid;
+    bool valid = report.changed() && (report.weldedVertices == 2u) && (report.removedEdges == 2u) && (report.removedPolygons == std::vector< std::size_t >{ 2, 3 })
+                 && (report.splitVertices == 1u) && (report.removedVertices == 1u) && (vertices.size() == 9u) && (polygons.size() == 3u)
+                 && (report.vertexMap[ 4 ] == report.vertexMap[ 1 ]) && (report.vertexMap[ 7 ] == report.vertexMap[ 2 ]) && (report.vertexMap[ 10 ] == invalid)
+                 && (report.vertexOrigin[ polygons[ 2 ][ 0 ] ] == 6u) && (polygons[ 2 ][ 0 ] != polygons[ 1 ][ 2 ]);
+    if( valid )
+    {
+      // the split vertex coincides with its copy
+      typedef Dune::__PolygonGrid::ValidationReport ValidationReport;
+      Mesh< double > mesh( vertices, polygons );
+      ValidationReport validation = Dune::__PolygonGrid::validateMesh( mesh );
+      valid = (validation[ ValidationReport::DuplicateVertices ].offenders == std::vector< std::size_t >{ polygons[ 2 ][ 0 ] });
+      validation[ ValidationReport::DuplicateVertices ] = ValidationReport::Result();
+      valid = valid && validation.valid();
+    }
+    if( !valid )
+    {
+      std::cerr << "Error: Input repair failed (" << report << ")." << std::endl;
+      std::abort();
+    }
+  }
+
+  // orientation and convexity of a non-convex polygon starting at its reflex corner
+  {
+    std::vector< Dune::FieldVector< double, 2 > > vertices = { { 0.0, 0.0 }, { 2.0, 1.0 }, { 0.0, 2.0 }, { 1.0, 1.0 } };
+    MultiVector< std::size_t > polygons = { { 2, 3, 0, 1 }, { 3, 2, 0 }, { 1, 0, 3, 2 } };
+    const std::size_t reversed = Dune::__PolygonGrid::orientPolygons( vertices, polygons );
+    const std::vector< char > convex = Dune::__PolygonGrid::convexPolygons( vertices, polygons );
+    bool valid = (reversed == 1u) && (polygons[ 0 ][ 0 ] == 2u) && (polygons[ 1 ][ 0 ] == 3u) && (polygons[ 2 ][ 0 ] == 2u)
+                 && (convex == std::vector< char >{ 0, 1, 0 });
+
+    Mesh< double > mesh( vertices, MultiVector< std::size_t >{ { 2, 3, 0, 1 }, { 3, 2, 0 } } );
+    mesh.classifyConvexity();
+    valid = valid && mesh.convexityClassified() && !mesh.convex( Dune::__PolygonGrid::NodeIndex( 0, Dual ) ) && mesh.convex( Dune::__PolygonGrid::NodeIndex( 1, Dual ) );
+    vertices[ 3 ] = Dune::FieldVector< double, 2 >{ -0.5, 1.0 };
+    mesh.setPositions( vertices );
+    valid = valid && mesh.convex( Dune::__PolygonGrid::NodeIndex( 0, Dual ) );
+    if( !valid )
+    {
+      std::cerr << "Error: Wrong orientation or convexity of non-convex polygons." << std::endl;
+      std::abort();
+    }
+  }
+
+  // bulk geometry queries agree with the entity-wise geometry
+  {
+    Mesh< double > mesh( positions, polys );
+    const std::size_t invalid = std::numeric_limits< std::size_t >::max();
+    for( auto type : { Primal, Dual } )
+    {
+      const std::size_t numCells = mesh.numCells( type ), numEdges = mesh.numEdges( type );
+      std::vector< double > volumes( numCells ), centroids( 2u*numCells ), lengths( numEdges ), normals( 2u*numEdges );
+      std::vector< std::size_t > edgeCells( 2u*numEdges );
+      Dune::__PolygonGrid::cellVolumes( mesh, type, volumes );
+      Dune::__PolygonGrid::cellCentroids( mesh, type, centroids.data() );
+      Dune::__PolygonGrid::edgeLengths( mesh, type, lengths );
+      Dune::__PolygonGrid::edgeNormals( mesh, type, normals );
+      Dune::__PolygonGrid::edgeCells( mesh, type, edgeCells );
+      const MultiVector< std::size_t > vertices = Dune::__PolygonGrid::cellVertices( mesh, type );
+      const MultiVector< std::size_t > neighbors = Dune::__PolygonGrid::cellNeighbors( mesh, type );
+
+      bool valid = (vertices.size() == numCells) && (neighbors.size() == numCells);
+      for( std::size_t i = 0u; i < numCells; ++i )
+      {
+        const Dune::__PolygonGrid::NodeIndex cell( i, dual( type ) );
+        double perimeter = 0.0;
+        std::size_t j = 0u;
+        for( Dune::__PolygonGrid::HalfEdgeIndex h = mesh.begin( cell ); h != mesh.end( cell ); ++h, ++j )
+        {
+          const Dune::__PolygonGrid::HalfEdge< double > halfEdge( &mesh, h );
+          const std::size_t e = mesh.edgeIndex( h ), n = neighbors[ i ][ j ];
+          const Dune::FieldVector< double, 2 > normal{ normals[ 2*e ], normals[ 2*e+1 ] };
+          const Dune::FieldVector< double, 2 > tangent = halfEdge.targetPosition() - halfEdge.sourcePosition();
+          perimeter += lengths[ e ];
+          valid &= (vertices[ i ][ j ] == std::size_t( mesh.target( h ) )) && (std::abs( lengths[ e ] - tangent.two_norm() ) < 1e-14)
+                   && (std::abs( normal * tangent ) < 1e-14) && (std::abs( normal.two_norm() - 1.0 ) < 1e-14)
+                   && ((edgeCells[ 2*e ] == i) ? (edgeCells[ 2*e+1 ] == n) : ((edgeCells[ 2*e+1 ] == i) && (edgeCells[ 2*e ] == n)))
+                   && ((n == invalid) == !halfEdge.neighbor().regular());
+        }
+        const Dune::FieldVector< double, 2 > centroid{ centroids[ 2*i ], centroids[ 2*i+1 ] };
+        valid &= (j == vertices.size( i )) && (std::abs( volumes[ i ] - Dune::__PolygonGrid::cellVolume( mesh, cell ) ) < 1e-14)
+                 && ((centroid - Dune::__PolygonGrid::cellCentroid( mesh, cell )).two_norm() < 1e-14) && (perimeter > 0.0);
+      }
+      if( !valid )
+      {
+        std::cerr << "Error: Bulk geometry queries yield wrong results on " << type << " mesh." << std::endl;
+        std::abort();
+      }
+    }
+  }
+
+  // flat, aligned entity vectors on the primal and dual mesh
+  {
+    Mesh< double > mesh( positions, polys );
+    for( auto type : { Primal, Dual } )
+    {
+      Dune::__PolygonGrid::CellVector< double > cells( mesh, type, 1.0 );
+      Dune::__PolygonGrid::EdgeVector< float > edges( mesh, type );
+      Dune::__PolygonGrid::VertexVector< int > vertices( mesh, type, -1 );
+      if( (cells.size() != mesh.numCells( type )) || (edges.size() != mesh.numEdges( type )) || (vertices.size() != mesh.numVertices( type ))
+          || (reinterpret_cast< std::uintptr_t >( cells.data() ) % 64u != 0u) || (reinterpret_cast< std::uintptr_t >( edges.data() ) % 64u != 0u)
+          || (reinterpret_cast< std::uintptr_t >( vertices.data() ) % 64u != 0u) || (cells[ cells.size()-1u ] != 1.0) || (vertices[ 0 ] != -1) )
+      {
+        std::cerr << "Error: Entity vectors have wrong size or alignment." << std::endl;
+        std::abort();
+      }
+    }
+  }
+
+  // transfer operators preserve constants and their adjoints are transposes
+  {
+    typedef Dune::__PolygonGrid::TransferOperator< double > TransferOperator;
+    Mesh< double > mesh( positions, polys );
+    for( auto type : { Primal, Dual } )
+    {
+      for( auto weighting : { TransferOperator::Area, TransferOperator::InverseDistance } )
+      {
+        const TransferOperator transfer( mesh, type, weighting );
+        std::vector< double > u( mesh.numCells( type ), 2.0 ), v( mesh.numVertices( type ), 3.0 ), Au( v.size() ), Bv( u.size() ), ATv( u.size() ), BTu( v.size() );
+        transfer.cellToVertex( u, Au );
+        transfer.vertexToCell( v, Bv );
+        bool valid = std::all_of( Au.begin(), Au.end(), [] ( double x ) { return std::abs( x - 2.0 ) < 1e-12; } )
+                     && std::all_of( Bv.begin(), Bv.end(), [] ( double x ) { return std::abs( x - 3.0 ) < 1e-12; } );
+
+        for( std::size_t i = 0u; i < u.size(); ++i )
+          u[ i ] = std::sin( double( i ) );
+        for( std::size_t i = 0u; i < v.size(); ++i )
+          v[ i ] = std::cos( double( 3*i ) );
+        transfer.cellToVertex( u, Au );
+        transfer.vertexToCell( v, Bv );
+        transfer.cellToVertexAdjoint( v, ATv );
+        transfer.vertexToCellAdjoint( u, BTu );
+        double vAu = 0.0, ATvu = 0.0, uBv = 0.0, BTuv = 0.0;
+        for( std::size_t i = 0u; i < u.size(); ++i )
+        {
+          ATvu += ATv[ i ] * u[ i ];
+          uBv += u[ i ] * Bv[ i ];
+        }
+        for( std::size_t i = 0u; i < v.size(); ++i )
+        {
+          vAu += v[ i ] * Au[ i ];
+          BTuv += BTu[ i ] * v[ i ];
+        }
+        valid &= (std::abs( vAu - ATvu ) < 1e-12) && (std::abs( uBv - BTuv ) < 1e-12);
+        if( !valid )
+        {
+          std::cerr << "Error: Wrong transfer operator (type = " << type << ", weighting = " << weighting << ")." << std::endl;
+          std::abort();
+        }
+      }
+    }
+  }
+
+  // fixed valence kernels agree with the generic ones on uniform triangle and quadrilateral meshes
+  for( std::size_t valence : { 3u, 4u } )
+  {
+    const std::size_t n = 4;
+    std::vector< Dune::FieldVector< double, 2 > > vertices;
+    for( std::size_t j = 0u; j <= n; ++j )
+      for( std::size_t i = 0u; i <= n; ++i )
+        vertices.push_back( Dune::FieldVector< double, 2 >{ double( i ) / double( n ) + 0.01*double( j*j ), double( j ) / double( n ) } );
+    MultiVector< std::size_t > polygons;
+    for( std::size_t j = 0u; j < n; ++j )
+      for( std::size_t i = 0u; i < n; ++i )
+      {
+        const std::size_t k = j*(n+1) + i;
+        if( valence == 4u )
+          polygons.push_back( { k, k+1, k+n+2, k+n+1 } );
+        else
+        {
+          polygons.push_back( { k, k+1, k+n+2 } );
+          polygons.push_back( { k, k+n+2, k+n+1 } );
+        }
+      }
+    Mesh< double > mesh( vertices, polygons );
+
+    std::vector< double > volumes( mesh.numCells( Primal ) ), centers( 2u*mesh.numCells( Primal ) );
+    Dune::__PolygonGrid::cellVolumes( mesh, Primal, volumes );
+    Dune::__PolygonGrid::cellCentroids( mesh, Primal, centers );
+
+    const Dune::__PolygonGrid::FixedValenceMesh< double, Dune::__PolygonGrid::dynamicValence > cells( mesh );
+    bool valid = (mesh.polygonSize() == valence) && (Mesh< double >( positions, polys ).polygonSize() == 0u);
+    Dune::__PolygonGrid::dispatchValence( mesh, [ &cells, &polygons, &volumes, &centers, valence, &valid ] ( const auto &fixed ) {
+        valid &= (fixed.valence == valence);
+        for( std::size_t i = 0u; valid && (i < cells.numCells()); ++i )
+        {
+          valid = (fixed.size( i ) == cells.size( i )) && (std::abs( volumes[ i ] - cells.volume( i ) ) < 1e-14) && ((Dune::FieldVector< double, 2 >{ centers[ 2*i ], centers[ 2*i+1 ] } - cells.center( i )).two_norm() < 1e-14);
+          for( std::size_t j = 0u; valid && (j < valence); ++j )
+            valid = (fixed.halfEdge( i, j ) == cells.halfEdge( i, j )) && (fixed.vertex( i, j ) == polygons[ i ][ j ]) && (fixed.edge( i, j ) == cells.edge( i, j ));
+        }
+      } );
+    if( !valid )
+    {
+      std::cerr << "Error: Fixed valence kernels differ from generic ones (valence = " << valence << ")." << std::endl;
+      std::abort();
+    }
+  }
+
+  // single precision meshes far from the origin: the geometry is accurate for the stored positions
+  {
+    const std::size_t n = 10;
+    const double offset = 1e4, h = 0.1;
+    std::vector< Dune::FieldVector< float, 2 > > vertices;
+    for( std::size_t j = 0u; j <= n; ++j )
+      for( std::size_t i = 0u; i <= n; ++i )
+        vertices.push_back( Dune::FieldVector< float, 2 >{ float( offset + h*double( i ) ), float( offset + h*double( j ) ) } );
+    MultiVector< std::size_t > polygons;
+    for( std::size_t j = 0u; j < n; ++j )
+      for( std::size_t i = 0u; i < n; ++i )
+        polygons.push_back( { j*(n+1) + i, j*(n+1) + i+1, (j+1)*(n+1) + i+1, (j+1)*(n+1) + i } );
+    Mesh< float > mesh( vertices, polygons );
+
+    std::vector< float > volumes( mesh.numCells( Primal ) ), centers( 2u*mesh.numCells( Primal ) );
+    Dune::__PolygonGrid::cellVolumes( mesh, Primal, volumes );
+    Dune::__PolygonGrid::cellCentroids( mesh, Primal, centers );
+    bool valid = true;
+    for( std::size_t i = 0u; i < mesh.numCells( Primal ); ++i )
+    {
+      // shoelace formula in double precision for the stored corners
+      const auto polygon = polygons[ i ];
+      const double o0 = vertices[ polygon[ 0 ] ][ 0 ], o1 = vertices[ polygon[ 0 ] ][ 1 ];
+      double volume = 0.0, moment0 = 0.0, moment1 = 0.0;
+      for( std::size_t k = 0u; k < polygon.size(); ++k )
+      {
+        const auto &x = vertices[ polygon[ k ] ];
+        const auto &y = vertices[ polygon[ (k+1) % polygon.size() ] ];
+        const double x0 = x[ 0 ] - o0, x1 = x[ 1 ] - o1, y0 = y[ 0 ] - o0, y1 = y[ 1 ] - o1;
+        volume += 0.5*(x0*y1 - x1*y0);
+        moment0 += (x0*y1 - x1*y0)*(x0 + y0);
+        moment1 += (x0*y1 - x1*y0)*(x1 + y1);
+      }
+      const double center0 = o0 + moment0 / (6.0*volume), center1 = o1 + moment1 / (6.0*volume);
+
+      // accumulation adds no error beyond rounding of the result
+      valid &= (std::abs( volumes[ i ] - volume ) <= 1e-6*volume);
+      valid &= (std::abs( centers[ 2*i ] - center0 ) <= offset*std::numeric_limits< float >::epsilon());
+      valid &= (std::abs( centers[ 2*i+1 ] - center1 ) <= offset*std::numeric_limits< float >::epsilon());
+      valid &= (Dune::__PolygonGrid::cellVolume( mesh, Dune::__PolygonGrid::NodeIndex( i, Dual ) ) == volumes[ i ]);
+
+      // the rounding of the absolute positions bounds the error with respect to the exact geometry
+      valid &= (std::abs( volume - h*h ) <= 4.0*h*offset*std::numeric_limits< float >::epsilon());
+    }
+
+    const Dune::__PolygonGrid::TransferOperator< float > transfer( mesh );
+    std::vector< float > u( mesh.numCells( Primal ), 2.0f ), v( mesh.numVertices( Primal ) );
+    transfer.cellToVertex( u, v );
+    valid &= std::all_of( v.begin(), v.end(), [] ( float x ) { return std::abs( x - 2.0f ) < 1e-5f; } );
+    if( !valid )
+    {
+      std::cerr << "Error: Inaccurate geometry on single precision mesh." << std::endl;
+      std::abort();
+    }
+  }
+
+  // SoA positions and gathered cell corners yield the same geometry as the mesh
+  {
+    Mesh< double > mesh( positions, polys );
+    for( auto type : { Primal, Dual } )
+    {
+      const Dune::__PolygonGrid::SoAPositions< double > soa( mesh, type );
+      const Dune::__PolygonGrid::CellCorners< double > corners( mesh, type );
+      std::vector< double > volumes( mesh.numCells( type ) );
+      corners.volumes( volumes );
+      bool valid = (soa.x().size() == mesh.numNodes( type )) && (corners.x().size() == mesh.nodes( dual( type ) ).begin_of( mesh.numCells( type ) ));
+      for( std::size_t i = 0u; valid && (i < mesh.numCells( type )); ++i )
+      {
+        const Dune::__PolygonGrid::NodeIndex cell( i, dual( type ) );
+        const double volume = Dune::__PolygonGrid::cellVolume( mesh, cell );
+        const Dune::FieldVector< double, 2 > center = Dune::__PolygonGrid::cellCentroid( mesh, cell );
+        valid = (std::abs( soa.volume( i ) - volume ) < 1e-14) && (std::abs( volumes[ i ] - volume ) < 1e-14)
+                && ((soa.center( i ) - center).two_norm() < 1e-14) && ((corners.center( i ) - center).two_norm() < 1e-14);
+      }
+      if( !valid )
+      {
+        std::cerr << "Error: Position layouts yield wrong geometry (type = " << type << ")." << std::endl;
+        std::abort();
+      }
+    }
+  }
+
+  // binary VTU output of primal and dual grid
+  {
+    Mesh< double > mesh( positions, polys );
+    std::vector< double > cellData( 2*mesh.numCells( Primal ) ), vertexData( mesh.numVertices( Dual ) ), edgeData( mesh.numEdges( Primal ) );
+    for( std::size_t i = 0u; i < cellData.size(); ++i )
+      cellData[ i ] = 0.5*i;
+    for( std::size_t i = 0u; i < vertexData.size(); ++i )
+      vertexData[ i ] = -double( i );
+    for( std::size_t i = 0u; i < edgeData.size(); ++i )
+      edgeData[ i ] = double( i*i );
+
+    std::set< std::pair< std::int64_t, std::int64_t > > edges;
+    for( std::size_t i = 0u; i < polys.size(); ++i )
+      for( std::size_t j = 0u; j < polys[ i ].size(); ++j )
+        edges.insert( std::minmax< std::int64_t >( polys[ i ][ j ], polys[ i ][ (j+1) % polys[ i ].size() ] ) );
+
+    std::vector< bool > compression = { false };
+#if HAVE_ZLIB
+    compression.push_back( true );
+#endif // #if HAVE_ZLIB
+    for( bool compress : compression )
+    {
+      VTKWriter< double > vtkWriter( mesh, compress );
+      vtkWriter.addCellData( Primal, "velocity", cellData, 2 );
+      vtkWriter.addVertexData( Dual, "pressure", vertexData );
+      vtkWriter.addEdgeData( Primal, "flux", edgeData );
+      vtkWriter.write( "test-mesh" );
+
+      const std::vector< std::int64_t > edgeConnectivity = readVTUArray< std::int64_t >( "test-mesh-edges.vtu", "connectivity" );
+      std::set< std::pair< std::int64_t, std::int64_t > > writtenEdges;
+      for( std::size_t i = 0u; 2u*i+1u < edgeConnectivity.size(); ++i )
+        writtenEdges.insert( std::minmax( edgeConnectivity[ 2*i ], edgeConnectivity[ 2*i+1 ] ) );
+      if( (edgeConnectivity.size() != 2u*edgeData.size()) || (writtenEdges != edges) || (readVTUArray< double >( "test-mesh-edges.vtu", "flux" ) != edgeData) )
+      {
+        std::cerr << "Error: VTU file 'test-mesh-edges.vtu' does not match mesh (compress = " << compress << ")." << std::endl;
+        std::abort();
+      }
+
+      for( auto type : { Primal, Dual } )
+      {
+        const std::string filename = (type == Primal ? "test-mesh.vtu" : "test-mesh-dual.vtu");
+        const auto &nodes = mesh.nodes( Dune::__PolygonGrid::dual( type ) );
+        std::vector< std::int64_t > connectivity( nodes.offsets()[ mesh.numCells( type ) ] ), offsets( mesh.numCells( type ) );
+        for( std::size_t k = 0u; k < connectivity.size(); ++k )
+          connectivity[ k ] = nodes.values()[ k ].first;
+        for( std::size_t i = 0u; i < offsets.size(); ++i )
+          offsets[ i ] = nodes.end_of( i );
+        const std::vector< double > coordinates = readVTUArray< double >( filename, "Coordinates" );
+        bool valid = (readVTUArray< std::int64_t >( filename, "connectivity" ) == connectivity)
+                     && (readVTUArray< std::int64_t >( filename, "offsets" ) == offsets)
+                     && (readVTUArray< std::uint8_t >( filename, "types" ) == std::vector< std::uint8_t >( offsets.size(), 7u ))
+                     && (coordinates.size() == 3u*mesh.numVertices( type ))
+                     && (readVTUArray< double >( filename, (type == Primal ? "velocity" : "pressure") ) == (type == Primal ? cellData : vertexData));
+        for( std::size_t i = 0u; valid && (i < mesh.numVertices( type )); ++i )
+          valid = (coordinates[ 3*i ] == mesh.position( Dune::__PolygonGrid::NodeIndex( i, type ) )[ 0 ]) && (coordinates[ 3*i+2 ] == 0.0);
+        if( !valid )
+        {
+          std::cerr << "Error: VTU file '" << filename << "' does not match mesh (compress = " << compress << ")." << std::endl;
+          std::abort();
+        }
+      }
+    }
+
+    // asynchronous time series: the data and the vertex positions are modified right after staging
+    for( bool compress : compression )
+    {
+      std::vector< double > velocity( cellData ), flux( edgeData );
+      const std::vector< Dune::FieldVector< double, 2 > > initial( mesh.positions( Primal ).begin(), mesh.positions( Primal ).begin() + mesh.numVertices( Primal ) );
+      {
+        VTKSequenceWriter< double > sequenceWriter( mesh, "test-mesh-series", compress );
+        sequenceWriter.addCellData( Primal, "velocity", velocity, 2 );
+        sequenceWriter.addEdgeData( Primal, "flux", flux );
+        for( int step = 0; step < 3; ++step )
+        {
+          sequenceWriter.write( 0.5*step );
+          for( double &v : velocity )
+            v += 1.0;
+          std::fill( flux.begin(), flux.end(), double( step ) );
+          mesh.movePositions( [] ( std::size_t, const Dune::FieldVector< double, 2 > &x ) { return x + Dune::FieldVector< double, 2 >{ 1.0, 0.0 }; } );
+        }
+        sequenceWriter.wait();
+      }
+      mesh.setPositions( initial );
+
+      const std::vector< double > coordinates0 = readVTUArray< double >( "test-mesh-series-primal-00000.vtu", "Coordinates" );
+      const std::vector< double > coordinates2 = readVTUArray< double >( "test-mesh-series-primal-00002.vtu", "Coordinates" );
+      const std::vector< double > edgeCoordinates1 = readVTUArray< double >( "test-mesh-series-primal-edges-00001.vtu", "Coordinates" );
+      bool moved = (coordinates0.size() == 3u*initial.size()) && (coordinates2.size() == coordinates0.size()) && (edgeCoordinates1.size() == coordinates0.size());
+      for( std::size_t i = 0u; moved && (i < initial.size()); ++i )
+        moved = (coordinates0[ 3*i ] == initial[ i ][ 0 ]) && (coordinates2[ 3*i ] == initial[ i ][ 0 ] + 2.0) && (edgeCoordinates1[ 3*i ] == initial[ i ][ 0 ] + 1.0)
+                && (coordinates2[ 3*i+1 ] == initial[ i ][ 1 ]);
+      if( !moved )
+      {
+        std::cerr << "Error: VTK sequence writer does not follow moved vertices (compress = " << compress << ")." << std::endl;
+        std::abort();
+      }
+
+      bool valid = (readVTUArray< std::int64_t >( "test-mesh-series-primal-00002.vtu", "connectivity" ) == readVTUArray< std::int64_t >( "test-mesh.vtu", "connectivity" ))
+                   && (readVTUArray< double >( "test-mesh-series-primal-00000.vtu", "velocity" ) == cellData)
+                   && (readVTUArray< double >( "test-mesh-series-primal-edges-00001.vtu", "flux" ) == std::vector< double >( edgeData.size(), 0.0 ));
+      std::vector< double > velocity2 = readVTUArray< double >( "test-mesh-series-primal-00002.vtu", "velocity" );
+      for( std::size_t i = 0u; valid && (i < cellData.size()); ++i )
+        valid = (velocity2[ i ] == cellData[ i ] + 2.0);
+      std::ifstream pvd( "test-mesh-series-primal.pvd" );
+      const std::string collection( (std::istreambuf_iterator< char >( pvd )), std::istreambuf_iterator< char >() );
+      if( !valid || (collection.find( "timestep=\"1\" group=\"\" part=\"0\" file=\"test-mesh-series-primal-00002.vtu\"" ) == std::string::npos)
+          || std::ifstream( "test-mesh-series-dual-00000.vtu" ) )
+      {
+        std::cerr << "Error: VTK sequence writer yields wrong time series (compress = " << compress << ")." << std::endl;
+        std::abort();
+      }
+    }
+  }
+
   return 0;
 }
 catch( const Dune::Exception &e )
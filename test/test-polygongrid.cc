@@ -1,20 +1,30 @@
 #include <config.h>
 
+#include <cmath>
+
+#include <algorithm>
+#include <istream>
 #include <memory>
+#include <set>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include <dune/common/parallel/mpihelper.hh>
 
 #include <dune/polygongrid/grid.hh>
 #include <dune/polygongrid/gridfactory.hh>
 #include <dune/polygongrid/dgf.hh>
+#include <dune/polygongrid/entityvector.hh>
+#include <dune/polygongrid/vtkwriter.hh>
 
 #include <dune/grid/test/checkintersectionit.hh>
 #include <dune/grid/test/checkiterators.hh>
 #include <dune/grid/test/checkpartition.hh>
 #include <dune/grid/test/gridcheck.hh>
 
-#include <dune/grid/io/file/vtk/vtkwriter.hh>
-
 #if HAVE_DUNE_VIZ
 #include <dune/viz/writer/vtk/polygonwriter.hh>
 #endif // #if HAVE_DUNE_VIZ
@@ -56,14 +66,75 @@ void performCheck ( Grid &grid )
 }
 
 
+// checkHierarchy
+// --------------
+
+void checkHierarchy ( const Grid &grid )
+{
+  for( int level = 1; level <= grid.maxLevel(); ++level )
+  {
+    const auto gridView = grid.levelGridView( level );
+    const auto coarseGridView = grid.levelGridView( level-1 );
+
+    std::vector< double > volume( coarseGridView.size( 0 ), 0.0 );
+    for( const auto &element : elements( gridView ) )
+    {
+      if( (element.level() != level) || !element.hasFather() || (element.father().level() != level-1) )
+        DUNE_THROW( Dune::GridError, "Invalid father relation on level " << level << "." );
+      if( grid.entity( element.seed() ) != element )
+        DUNE_THROW( Dune::GridError, "Entity seed does not reproduce entity on level " << level << "." );
+      volume[ coarseGridView.indexSet().index( element.father() ) ] += element.geometry().volume();
+    }
+
+    for( const auto &element : elements( coarseGridView ) )
+    {
+      if( element.isLeaf() || (std::abs( volume[ coarseGridView.indexSet().index( element ) ] - element.geometry().volume() ) > 1e-12) )
+        DUNE_THROW( Dune::GridError, "Children do not cover father on level " << level-1 << "." );
+    }
+  }
+}
+
+
+// checkEntityVectors
+// ------------------
+
+void checkEntityVectors ( const Grid &grid )
+{
+  const auto gridView = grid.leafGridView();
+  Dune::__PolygonGrid::CellVector< double > volume( gridView );
+  Dune::__PolygonGrid::EdgeVector< int > edgeCount( gridView, 0 );
+  Dune::__PolygonGrid::VertexVector< int > vertexCount( gridView, 0 );
+  if( (volume.size() != std::size_t( gridView.size( 0 ) )) || (edgeCount.size() != std::size_t( gridView.size( 1 ) )) || (vertexCount.size() != std::size_t( gridView.size( 2 ) )) )
+    DUNE_THROW( Dune::GridError, "Entity vectors have wrong size." );
+
+  for( const auto &element : elements( gridView ) )
+  {
+    volume[ element ] = element.geometry().volume();
+    for( unsigned int i = 0u; i < element.subEntities( 1 ); ++i )
+      ++edgeCount[ element.subEntity< 1 >( i ) ];
+    for( unsigned int i = 0u; i < element.subEntities( 2 ); ++i )
+      ++vertexCount[ gridView.indexSet().subIndex( element, i, 2 ) ];
+  }
+
+  for( const auto &element : elements( gridView ) )
+  {
+    if( volume[ gridView.indexSet().index( element ) ] != element.geometry().volume() )
+      DUNE_THROW( Dune::GridError, "Cell vector does not use the element index." );
+  }
+  if( std::any_of( edgeCount.begin(), edgeCount.end(), [] ( int count ) { return (count < 1) || (count > 2); } )
+      || std::any_of( vertexCount.begin(), vertexCount.end(), [] ( int count ) { return (count < 1); } ) )
+    DUNE_THROW( Dune::GridError, "Edge or vertex vector does not cover all entities." );
+}
+
+
 void write ( const Grid &grid, const std::string &name )
 {
 #if HAVE_DUNE_VIZ
   Dune::Viz::VTKPolygonWriter< Grid::LeafGridView > vtkWriter( grid.leafGridView() );
   vtkWriter.write( name );
 #else
-  Dune::VTKWriter< typename Grid::LeafGridView > vtkWriter( grid.leafGridView() );
-  vtkWriter.write( name );
+  Dune::__PolygonGrid::VTKWriter< double > vtkWriter( grid.mesh() );
+  vtkWriter.write( name + ".vtu", grid.type() );
 #endif // #if HAVE_DUNE_VIZ
 }
 
@@ -114,6 +185,39 @@ try
     write( dualGrid, "dualgrid-dgf" );
   }
 
+  {
+    // the streaming reader and the generic DGF parser (required by the BoundaryDomain block) agree
+    const std::string blocks = "DGF\nVertex\n0 0\n1 0\n2 0\n0 1\n1 1\n2 1\n3 0.5\n#\nCube\n0 1 3 4\n#\nPolygon\n1 2 5 4\n2 6 5\n#\n";
+    std::istringstream streaming( blocks ), generic( blocks + "BoundaryDomain\ndefault 1\n#\n" );
+    Dune::GridPtr< Grid > streamingGrid( streaming ), genericGrid( generic );
+
+    std::vector< double > volumes;
+    for( const auto &element : elements( streamingGrid->leafGridView() ) )
+      volumes.push_back( element.geometry().volume() );
+    std::size_t i = 0u;
+    for( const auto &element : elements( genericGrid->leafGridView() ) )
+    {
+      if( (i >= volumes.size()) || (std::abs( element.geometry().volume() - volumes[ i++ ] ) > 1e-12) )
+        DUNE_THROW( Dune::GridError, "Generic DGF parser yields a different grid." );
+    }
+    if( (volumes.size() != 3u) || (i != volumes.size()) || (std::abs( volumes[ 1 ] - 1.0 ) > 1e-12) )
+      DUNE_THROW( Dune::GridError, "Streaming DGF reader yields a wrong grid." );
+
+    // streams that cannot be rewound (e.g., pipes) are buffered before the generic parser is used
+    struct PipeBuffer
+      : public std::streambuf
+    {
+      explicit PipeBuffer ( std::string data ) : data_( std::move( data ) ) { setg( &data_[ 0 ], &data_[ 0 ], &data_[ 0 ] + data_.size() ); }
+
+    private:
+      std::string data_;
+    } pipeBuffer( blocks + "BoundaryDomain\ndefault 1\n#\n" );
+    std::istream pipe( &pipeBuffer );
+    Dune::GridPtr< Grid > pipeGrid( pipe );
+    if( pipeGrid->leafGridView().size( 0 ) != 3 )
+      DUNE_THROW( Dune::GridError, "Generic DGF parser yields a wrong grid for a stream that cannot be rewound." );
+  }
+
   {
     // create arbitrary grid
     Grid grid = *createArbitraryGrid();
@@ -129,13 +233,283 @@ try
     std::cout << std::endl;
 
     performCheck( grid );
+    checkEntityVectors( grid );
     write( grid, "primalgrid-arbi" );
 
     Grid dualGrid = grid.dualGrid();
     performCheck( dualGrid );
+    checkEntityVectors( dualGrid );
     write( dualGrid, "dualgrid-arbi" );
   }
 
+  {
+    // create a hierarchy by agglomeration
+    Grid grid = *createArbitraryGrid();
+    const Grid dualGrid = grid.dualGrid();
+    std::vector< Grid::LocalIdSet::IdType > ids;
+    for( const auto &element : elements( grid.leafGridView() ) )
+      ids.push_back( grid.localIdSet().id( element ) );
+
+    const int levels = grid.coarsen( 2 );
+    if( (levels != grid.maxLevel()) || (levels == 0) )
+      DUNE_THROW( Dune::GridError, "Unable to coarsen grid." );
+    checkHierarchy( grid );
+
+    // the leaf keeps its ids and grids sharing the mesh keep their hierarchy
+    std::size_t i = 0u;
+    for( const auto &element : elements( grid.leafGridView() ) )
+    {
+      if( grid.localIdSet().id( element ) != ids[ i++ ] )
+        DUNE_THROW( Dune::GridError, "Coarsening changes the ids of leaf elements." );
+    }
+    if( (dualGrid.maxLevel() != 0) || (dualGrid.levelGridView( 0 ).size( 0 ) != dualGrid.size( 0 )) )
+      DUNE_THROW( Dune::GridError, "Coarsening modifies the hierarchy of the dual grid." );
+
+    grid.coarsen( 1 );
+    checkHierarchy( grid );
+
+    // the coarser levels would not follow moved vertices
+    bool rejected = false;
+    try
+    {
+      grid.movePositions( [] ( std::size_t, const Dune::FieldVector< double, 2 > &x ) { return x; } );
+    }
+    catch( const Dune::InvalidStateException & )
+    {
+      rejected = true;
+    }
+    if( !rejected )
+      DUNE_THROW( Dune::GridError, "Moving the vertices of a grid with coarser levels is accepted." );
+  }
+
+  {
+    // refine locally and globally
+    Grid grid = *createArbitraryGrid();
+    std::size_t numMarked = 0u, numCorners = 0u;
+    for( const auto &element : elements( grid.leafGridView() ) )
+    {
+      if( element.geometry().center()[ 0 ] < 0.5 )
+      {
+        grid.mark( 1, element );
+        numMarked += (grid.getMark( element ) > 0 ? 1u : 0u);
+        numCorners += element.geometry().corners();
+      }
+    }
+    std::set< Grid::GlobalIdSet::IdType > ids;
+    for( const auto &element : elements( grid.leafGridView() ) )
+    {
+      if( grid.getMark( element ) == 0 )
+        ids.insert( grid.globalIdSet().id( element ) );
+    }
+    for( const auto &vertex : vertices( grid.leafGridView() ) )
+      ids.insert( grid.globalIdSet().id( vertex ) );
+
+    const int size = grid.size( 0 );
+    grid.preAdapt();
+    if( !grid.adapt() || (grid.size( 0 ) != static_cast< int >( size + numCorners - numMarked )) || (grid.maxLevel() != 1) )
+      DUNE_THROW( Dune::GridError, "Local refinement yields wrong number of elements." );
+    grid.postAdapt();
+    checkHierarchy( grid );
+
+    // unrefined elements and old vertices keep their ids
+    std::size_t found = 0u;
+    for( const auto &element : elements( grid.leafGridView() ) )
+      found += ids.count( grid.globalIdSet().id( element ) );
+    for( const auto &vertex : vertices( grid.leafGridView() ) )
+      found += ids.count( grid.globalIdSet().id( vertex ) );
+    if( found != ids.size() )
+      DUNE_THROW( Dune::GridError, "Refinement changes the ids of unrefined entities." );
+
+    grid.globalRefine( 1 );
+    checkHierarchy( grid );
+    performCheck( grid );
+    Grid dualGrid = grid.dualGrid();
+    performCheck( dualGrid );
+
+    // keep a single coarser level
+    grid.limitLevels( 1 );
+    const int leafSize = grid.size( 0 );
+    grid.globalRefine( 2 );
+    if( (grid.maxLevel() != 1) || (grid.size( 0, 0 ) <= leafSize) || (dualGrid.maxLevel() != 2) )
+      DUNE_THROW( Dune::GridError, "Limiting the number of levels fails." );
+    checkHierarchy( grid );
+    performCheck( grid );
+  }
+
+  {
+    // renumber the cells by reverse Cuthill-McKee on creation
+    const Grid grid = *createArbitraryGrid();
+    std::vector< Dune::FieldVector< double, 2 > > positions( grid.size( 2 ) );
+    for( const auto &vertex : vertices( grid.leafGridView() ) )
+      positions[ grid.leafIndexSet().index( vertex ) ] = vertex.geometry().center();
+    Dune::GridFactory< Grid > factory;
+    for( const auto &x : positions )
+      factory.insertVertex( x );
+    std::vector< double > volumes;
+    for( const auto &element : elements( grid.leafGridView() ) )
+    {
+      std::vector< unsigned int > polygon;
+      for( const auto &vertex : subEntities( element, Dune::Codim< 2 >() ) )
+        polygon.push_back( grid.leafIndexSet().index( vertex ) );
+      factory.insertElement( Dune::GeometryTypes::none( 2 ), polygon );
+      volumes.push_back( element.geometry().volume() );
+    }
+    factory.setCellRenumbering( true );
+    Grid renumbered = *factory.createGrid();
+    performCheck( renumbered );
+
+    const std::vector< std::size_t > &permutation = factory.cellPermutation();
+    if( (permutation.size() != volumes.size()) || (factory.cellBandwidth().second > factory.cellBandwidth().first) )
+      DUNE_THROW( Dune::GridError, "Cell renumbering yields invalid permutation." );
+    std::vector< double > renumberedVolumes( volumes.size() );
+    for( const auto &element : elements( renumbered.leafGridView() ) )
+      renumberedVolumes[ renumbered.leafIndexSet().index( element ) ] = element.geometry().volume();
+    for( std::size_t i = 0u; i < volumes.size(); ++i )
+      if( std::abs( renumberedVolumes[ permutation[ i ] ] - volumes[ i ] ) > 1e-12 )
+        DUNE_THROW( Dune::GridError, "Cell renumbering does not match the permutation." );
+  }
+
+  {
+    // non-convex element inserted clockwise, starting at its reflex corner
+    Dune::GridFactory< Grid > factory;
+    for( const auto &x : std::vector< Dune::FieldVector< double, 2 > >{ { 0.0, 0.0 }, { 2.0, 1.0 }, { 0.0, 2.0 }, { 1.0, 1.0 } } )
+      factory.insertVertex( x );
+    factory.insertElement( Dune::GeometryTypes::none( 2 ), { 1u, 0u, 3u, 2u } );
+    factory.insertElement( Dune::GeometryTypes::none( 2 ), { 0u, 2u, 3u } );
+    factory.setConvexityClassification( true );
+    Grid grid = *factory.createGrid();
+    performCheck( grid );
+    for( const auto &element : elements( grid.leafGridView() ) )
+    {
+      const std::size_t index = grid.leafIndexSet().index( element );
+      if( (element.geometry().volume() <= 0.0) || (grid.mesh().convex( Dune::__PolygonGrid::NodeIndex( index, Dune::__PolygonGrid::Dual ) ) != (index == 1u)) )
+        DUNE_THROW( Dune::GridError, "Non-convex element has wrong orientation or convexity." );
+    }
+  }
+
+  {
+    // repair input with separate vertex copies for each element and a zero area element
+    const Grid grid = *createArbitraryGrid();
+    Dune::GridFactory< Grid > factory;
+    unsigned int numVertices = 0u;
+    for( const auto &element : elements( grid.leafGridView() ) )
+    {
+      std::vector< unsigned int > polygon;
+      for( const auto &vertex : subEntities( element, Dune::Codim< 2 >() ) )
+      {
+        factory.insertVertex( vertex.geometry().center() );
+        polygon.push_back( numVertices++ );
+      }
+      factory.insertElement( Dune::GeometryTypes::none( 2 ), polygon );
+    }
+    factory.insertElement( Dune::GeometryTypes::none( 2 ), { 0u, 1u, 0u } );
+    factory.setInputRepair( true );
+    Grid repaired = *factory.createGrid();
+    performCheck( repaired );
+
+    const Dune::__PolygonGrid::RepairReport &report = factory.repairReport();
+    const std::size_t numElements = grid.size( 0 );
+    if( (repaired.size( 0 ) != grid.size( 0 )) || (repaired.size( 2 ) != grid.size( 2 )) || (report.weldedVertices + grid.size( 2 ) != numVertices)
+        || (report.removedPolygons != std::vector< std::size_t >{ numElements }) )
+      DUNE_THROW( Dune::GridError, "Input repair yields wrong grid (" << report << ")." );
+  }
+
+  {
+    // repair and renumbering: the permutation refers to the inserted elements
+    const Grid grid = *createArbitraryGrid();
+    Dune::GridFactory< Grid > factory;
+    for( const auto &vertex : vertices( grid.leafGridView() ) )
+      factory.insertVertex( vertex.geometry().center() );
+    factory.insertElement( Dune::GeometryTypes::none( 2 ), { 0u, 1u, 0u } );
+    std::vector< double > volumes( 1u, 0.0 );
+    for( const auto &element : elements( grid.leafGridView() ) )
+    {
+      std::vector< unsigned int > polygon;
+      for( const auto &vertex : subEntities( element, Dune::Codim< 2 >() ) )
+        polygon.push_back( grid.leafIndexSet().index( vertex ) );
+      factory.insertElement( Dune::GeometryTypes::none( 2 ), polygon );
+      volumes.push_back( element.geometry().volume() );
+    }
+    factory.setInputRepair( true );
+    factory.setCellRenumbering( true );
+    Grid renumbered = *factory.createGrid();
+
+    const std::vector< std::size_t > &permutation = factory.cellPermutation();
+    if( (permutation.size() != volumes.size()) || (permutation[ 0 ] != Dune::__PolygonGrid::RepairReport::invalid) )
+      DUNE_THROW( Dune::GridError, "Cell permutation does not refer to the inserted elements." );
+    std::vector< double > renumberedVolumes( renumbered.size( 0 ) );
+    for( const auto &element : elements( renumbered.leafGridView() ) )
+      renumberedVolumes[ renumbered.leafIndexSet().index( element ) ] = element.geometry().volume();
+    for( std::size_t i = 1u; i < volumes.size(); ++i )
+      if( std::abs( renumberedVolumes[ permutation[ i ] ] - volumes[ i ] ) > 1e-12 )
+        DUNE_THROW( Dune::GridError, "Cell renumbering after repair does not match the permutation." );
+  }
+
+  {
+    // primal grid without dual data; the dual data is built on first use of the dual grid
+    const Grid grid = *createArbitraryGrid();
+    Dune::GridFactory< Grid > factory;
+    for( const auto &vertex : vertices( grid.leafGridView() ) )
+      factory.insertVertex( vertex.geometry().center() );
+    for( const auto &element : elements( grid.leafGridView() ) )
+    {
+      std::vector< unsigned int > polygon;
+      for( const auto &vertex : subEntities( element, Dune::Codim< 2 >() ) )
+        polygon.push_back( grid.leafIndexSet().index( vertex ) );
+      factory.insertElement( Dune::GeometryTypes::none( 2 ), polygon );
+    }
+    const Grid eagerGrid = *factory.createGrid();
+    factory.setLazyDual( true );
+    Grid lazyGrid = *factory.createGrid();
+    performCheck( lazyGrid );
+    if( lazyGrid.mesh().dualBuilt() )
+      DUNE_THROW( Dune::GridError, "Primal grid check requires the dual data." );
+    Grid lazyDualGrid = lazyGrid.dualGrid();
+    if( !lazyGrid.mesh().dualBuilt() || (lazyDualGrid.mesh().positions( Dune::__PolygonGrid::Dual ) != eagerGrid.mesh().positions( Dune::__PolygonGrid::Dual )) )
+      DUNE_THROW( Dune::GridError, "Lazily built dual data differs from the eagerly built one." );
+    performCheck( lazyDualGrid );
+  }
+
+  {
+    // single precision grid far from the origin agrees with the double precision grid up to the rounding of the positions
+    typedef Dune::PolygonGrid< float > FloatGrid;
+    const Grid grid = *createArbitraryGrid();
+    const Dune::FieldVector< float, 2 > offset{ 1e3f, -1e3f };
+    std::vector< Dune::FieldVector< float, 2 > > positions( grid.size( 2 ), offset );
+    for( const auto &vertex : vertices( grid.leafGridView() ) )
+      positions[ grid.leafIndexSet().index( vertex ) ] += vertex.geometry().center();
+    Dune::GridFactory< FloatGrid > factory;
+    for( const auto &x : positions )
+      factory.insertVertex( x );
+    for( const auto &element : elements( grid.leafGridView() ) )
+    {
+      std::vector< unsigned int > polygon;
+      for( const auto &vertex : subEntities( element, Dune::Codim< 2 >() ) )
+        polygon.push_back( grid.leafIndexSet().index( vertex ) );
+      factory.insertElement( Dune::GeometryTypes::none( 2 ), polygon );
+    }
+    const std::unique_ptr< FloatGrid > floatGrid( factory.createGrid() );
+
+    // the factory keeps the insertion order of the elements
+    std::vector< double > volumes;
+    std::vector< Dune::FieldVector< double, 2 > > centers;
+    for( const auto &element : elements( grid.leafGridView() ) )
+    {
+      volumes.push_back( element.geometry().volume() );
+      centers.push_back( element.geometry().center() );
+    }
+    const auto floatGridView = floatGrid->leafGridView();
+    for( const auto &element : elements( floatGridView ) )
+    {
+      const std::size_t i = floatGridView.indexSet().index( element );
+      const auto geometry = element.geometry();
+      Dune::FieldVector< double, 2 > center = geometry.center();
+      center -= offset;
+      if( (std::abs( geometry.volume() - volumes[ i ] ) > 1e-2*volumes[ i ]) || ((center - centers[ i ]).two_norm() > 1e-3) )
+        DUNE_THROW( Dune::GridError, "Single precision grid yields inaccurate geometry." );
+    }
+  }
+
   return 0;
 }
 catch( const Dune::Exception &e )
@@ -3,3 +3,45 @@ from dune.polygongrid import polygonGrid
 
 grid = polygonGrid(cartesianDomain([0, 0], [1, 1], [4, 4]))
 grid.writeVTK('test-polygongrid-cartesian')
+
+grid = polygonGrid(cartesianDomain([0, 0], [1, 1], [4, 4]), profile=True)
+statistics = grid.hierarchicalGrid.meshStatistics()
+assert statistics["polygons"] == 16 and statistics["edges"] == 40 and statistics["boundaries"] == 16
+assert statistics["valences"] == {2: 4, 3: 12, 4: 9}
+assert [phase[0] for phase in grid.hierarchicalGrid.meshProfile()] == ["boundaries", "meshStructure", "positions", "edgeIndices", "dualPositions", "dualEdgeIndices"]
+
+# single precision grid far from the origin (accurate up to the rounding of the positions)
+grid = polygonGrid(cartesianDomain([1000, 1000], [1001, 1001], [10, 10]), ctype="float")
+assert all(abs(element.geometry.volume - 0.01) < 5e-5 for element in grid.elements)
+
+# bulk geometry queries as NumPy arrays on the primal and dual grid
+for dual in (False, True):
+    grid = polygonGrid(cartesianDomain([0, 0], [1, 1], [4, 4]), dualGrid=dual)
+    hgrid = grid.hierarchicalGrid
+    volumes, centroids = hgrid.cellVolumes(), hgrid.cellCentroids()
+    lengths, normals, edgeCells = hgrid.edgeLengths(), hgrid.edgeNormals(), hgrid.edgeCells()
+    offsets, vertices = hgrid.cellVertices()
+    neighborOffsets, neighbors = hgrid.cellNeighbors()
+    assert volumes.shape == (grid.size(0),) and centroids.shape == (grid.size(0), 2)
+    assert lengths.shape == (grid.size(1),) and normals.shape == (grid.size(1), 2) and edgeCells.shape == (grid.size(1), 2)
+    assert len(offsets) == grid.size(0) + 1 and offsets[-1] == len(vertices) and (neighborOffsets == offsets).all()
+    assert abs(volumes.sum() - 1.0) < 1e-12 and abs((normals**2).sum(axis=1) - 1.0).max() < 1e-12
+    assert (edgeCells[:, 0] >= 0).all() and ((neighbors == -1).sum() == (edgeCells[:, 1] == -1).sum())
+    indexSet = grid.indexSet
+    for element in grid.elements:
+        i = indexSet.index(element)
+        assert abs(volumes[i] - element.geometry.volume) < 1e-12
+        center = element.geometry.center
+        assert abs(centroids[i][0] - center[0]) < 1e-12 and abs(centroids[i][1] - center[1]) < 1e-12
+
+# zero-copy views of the mesh data stay valid after the grid is gone
+grid = polygonGrid(cartesianDomain([0, 0], [1, 1], [4, 4]))
+assert grid.hierarchicalGrid.cachingStorage()
+data = grid.hierarchicalGrid.meshData()
+offsets, vertices = grid.hierarchicalGrid.cellVertices()
+del grid
+primal, dual = data["primal"], data["dual"]
+assert data["type"] == "primal" and not primal["positions"].flags.writeable and not dual["nodes"].flags.writeable
+assert (dual["offsets"][:len(offsets)] == offsets).all() and (dual["nodes"][:len(vertices), 0] == vertices).all()
+assert primal["positions"].shape == (25 + 2*16, 2) and abs(primal["positions"][:25].sum(axis=0) - [12.5, 12.5]).max() < 1e-12
+assert len(primal["edgeIndices"]) == len(dual["nodes"]) and primal["edgeIndices"].max() < len(dual["nodes"]) // 2